@@ -1 +0,0 @@
-file(COPY ${CMAKE_CURRENT_LIST_DIR}/src/assets DESTINATION ${CMAKE_CURRENT_BINARY_DIR})
\ No newline at end of file
@@ -0,0 +1,29 @@
+# Generates a header with every file in ASSET_DIR as a constexpr byte array, so the
+# application needs no files next to the executable.
+# Usage: cmake -DASSET_DIR=<dir> -DOUTPUT=<header> -P embed_assets.cmake
+
+file(GLOB ASSET_FILES RELATIVE ${ASSET_DIR} ${ASSET_DIR}/*.png)
+list(SORT ASSET_FILES)
+
+set(CONTENT "// Generated by embed_assets.cmake, do not edit\n#pragma once\n\n#include <cstddef>\n\n")
+set(TABLE "")
+foreach(ASSET ${ASSET_FILES})
+    string(MAKE_C_IDENTIFIER "asset_${ASSET}" SYMBOL)
+    file(READ ${ASSET_DIR}/${ASSET} HEX HEX)
+    # 32 bytes per line, then every byte as a literal
+    string(REGEX REPLACE "(................................................................)" "\\1\n    " HEX "${HEX}")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," HEX "${HEX}")
+    string(APPEND CONTENT "constexpr unsigned char ${SYMBOL}[] = {\n    ${HEX}\n};\n\n")
+    string(APPEND TABLE "    {\"${ASSET}\", ${SYMBOL}, sizeof(${SYMBOL})},\n")
+endforeach()
+
+string(APPEND CONTENT "struct EmbeddedAsset\n{\n    const char *name;\n    const unsigned char *data;\n    size_t size;\n};\n\n")
+string(APPEND CONTENT "constexpr EmbeddedAsset embeddedAssets[] = {\n${TABLE}};\n")
+
+# Only touch the header when the assets changed to avoid needless rebuilds
+if (EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+endif()
+if (NOT "${PREVIOUS}" STREQUAL "${CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
@@ -14,9 +14,54 @@
 
 // UI CONFIGURATION
 #define Y_ITEM_SPACING 6.0f
+#define DEFAULT_PANEL_REFRESH_RATE 10.0f // Hz, physics readouts in panels
+#define MIN_PANEL_REFRESH_RATE 1.0f      // Hz
+#define MAX_PANEL_REFRESH_RATE 60.0f     // Hz
+#define PANEL_REFRESH_RATE_STEP 1.0f     // Hz
+#define INSPECTOR_TEXT_CAPACITY 512      // Bytes of readout text per inspector
+#define MAX_NOTEPADS 8                   // Worlds open at once, each with its own simulation thread while shown
+#define MAX_SPLIT_NOTEPADS 4             // Worlds shown side by side in split view
+
+// TELEMETRY CONFIGURATION
+#define TELEMETRY_CAPACITY 4096        // Samples buffered between simulation and panels, power of two
+#define MIN_TELEMETRY_WINDOW 2.0f      // seconds
+#define MAX_TELEMETRY_WINDOW 120.0f    // seconds
+#define TELEMETRY_WINDOW_STEP 1.0f     // seconds
+#define DEFAULT_TELEMETRY_WINDOW 20.0f // seconds
+#define TELEMETRY_PLOT_WIDTH 300.0f
+#define TELEMETRY_PLOT_HEIGHT 60.0f
+#define TELEMETRY_PLOT_COLOR IM_COL32(66, 150, 250, 255)
+
+// HISTORY CONFIGURATION
+#define HISTORY_CHUNK_SIZE 64  // Object records per chunk, the unit an edit copies
+#define HISTORY_GROUP_SIZE 64  // Chunks per group, a revision holds one pointer per group
+#define HISTORY_CAPACITY 256   // Undo steps kept per notepad
+
+// QUALITY GOVERNOR CONFIGURATION
+#define DEFAULT_TARGET_FRAME_TIME 16.6f  // ms of UI and render work per frame
+#define MIN_TARGET_FRAME_TIME 4.0f       // ms
+#define MAX_TARGET_FRAME_TIME 100.0f     // ms
+#define TARGET_FRAME_TIME_STEP 0.1f      // ms
+#define DEFAULT_MIN_STEP_RATE 30.0f      // Hz
+#define DEFAULT_MAX_STEP_RATE 240.0f     // Hz
+#define MAX_CONTACT_ITERATIONS 8         // Impulse passes over the contacts per step
+#define DEFAULT_MAX_CONTACT_ITERATIONS 4
+#define MAX_RENDER_LEVEL 3               // Coarsest render level, 0 draws every body as its own shape
+#define RENDER_CIRCLE_SEGMENTS 32        // Segments of a batched circle at level 1, halved each level after
+#define RENDER_MIN_CIRCLE_SEGMENTS 6
+#define GOVERNOR_SMOOTHING 0.25f         // seconds, time constant of the measured costs
+#define GOVERNOR_COOLDOWN 0.5f           // seconds between two decisions on the same side, lets a change show in the costs
+#define GOVERNOR_HIGH_LOAD 0.85f         // Fraction of the simulation thread's time above which it degrades
+#define GOVERNOR_LOW_LOAD 0.5f           // Fraction below which it improves
+#define GOVERNOR_TARGET_LOAD 0.7f        // Load aimed for when cutting the step rate
+#define GOVERNOR_RATE_GROWTH 1.15f       // Step rate factor per improvement
+#define GOVERNOR_MAX_RATE_CUT 0.5f       // Smallest step rate factor per degradation
+#define GOVERNOR_RENDER_HEADROOM 0.6f    // Frame cost fraction of the target below which rendering improves
 
 // TOOLS CONFIGURATION
 #define TOOLS_ICON_SIZE 32
+#define TOOLS_ATLAS_CELL 64  // Pixels per icon in the atlas, icons are downsampled to fit
+#define TOOLS_ATLAS_PADDING 1 // Transparent border around each cell against filtering bleed
 #define TOOL_BG_COLOR sf::Color(41, 74, 122, 102)
 #define TOOL_SELECT_COLOR sf::Color(66, 150, 250, 200)
 
@@ -29,6 +74,76 @@
 #define CALC_FREQ_STEP 10     // Hz
 
 #define MAX_DT 0.05f         // seconds
+#define SIMULATION_STEP_RATE 120         // Hz, steps per second of the simulation thread
+#define SIMULATION_COMMAND_CAPACITY 1024 // Pending commands from the UI, power of two
+#define SIMULATION_COST_SMOOTHING 0.1f   // Weight of the newest step in the smoothed step cost
+
+#define PARALLEL_MIN_CHUNK 64 // Objects per task before a pass is split across threads
+#define SOLVER_BATCH_SIZE 256 // Bodies with general forces stepped together, each stage calls a shared evaluator once
+#define SPATIAL_CELL_SIZE 1.0f // meters
+
+#define CCD_SPEED_RATIO 0.5f // Bodies moving more than this fraction of their smallest half extent per step are swept
+#define CCD_MAX_SUBSTEPS 4   // Impacts resolved per body per step
+#define CCD_SKIN 1e-3f       // meters kept between a swept body and what it hit
+
+#define CONTACT_CORRECTION 0.8f // Fraction of the penetration corrected per step
+#define CONTACT_SLOP 0.01f      // meters of penetration left uncorrected, avoids jitter
+#define CONTACT_MIN_SPEED 0.01f // m/s, slower approaches get no impulse
+
+#define GRANULAR_RADIUS_SPREAD 4.0f // Circles more than this many median radii use the generic narrowphase
+#define GRANULAR_BLOCK_SIZE 4096    // Circles per contact detection task
+
+#define PROGRAM_BATCH_SIZE 256           // Bodies per pass of the force program interpreter
+#define PROGRAM_MAX_REGISTERS 128        // Scalar registers per force program
+#define PROGRAM_SOURCE_CAPACITY 1024     // Characters in the custom force editor
+#define PROGRAM_ISOTROPY_TOLERANCE 1e-4f // Relative gain mismatch under which an affine program becomes a linear force
+
+// FLUID CONFIGURATION
+#define FLUID_SPACING 0.1f                // meters between particles at rest, twice a particle's contact radius
+#define FLUID_SMOOTHING_RADIUS 0.2f       // meters, also the neighbor grid cell size
+#define FLUID_REST_DENSITY 1.0f           // kg/m², the units of object density, so buoyancy follows from the ratio
+#define FLUID_STIFFNESS 400.0f            // N/m of pressure per unit of relative compression
+#define FLUID_VISCOSITY 0.01f
+#define FLUID_BOUNDARY_STIFFNESS 20000.0f // m/s² per meter a particle penetrates an object
+#define FLUID_BOUNDARY_DAMPING 100.0f     // 1/s, on the speed of a particle relative to an object surface
+#define FLUID_MAX_SUBSTEP 0.004f          // seconds, keeps the pressure waves stable
+#define FLUID_MAX_PARTICLES 100000
+#define FLUID_DRAW_RADIUS 3.0f            // px
+#define FLUID_COLOR sf::Color(60, 140, 255, 200)
+
+// SPRING CONFIGURATION
+#define SOFT_BODY_NODE_RADIUS 0.4f // Fraction of the lattice spacing, so neighboring nodes do not touch at rest
+#define SOFT_BODY_COLOR sf::Color(240, 110, 150)
+#define SPRING_COLOR sf::Color(255, 255, 255, 120)
+
+// PREDICTION CONFIGURATION
+#define MIN_PREDICTION_HORIZON 0.5f     // seconds
+#define MAX_PREDICTION_HORIZON 30.0f    // seconds
+#define PREDICTION_HORIZON_STEP 0.5f    // seconds
+#define DEFAULT_PREDICTION_HORIZON 5.0f // seconds
+#define PREDICTION_COLOR sf::Color(255, 255, 255, 110)
+
+// EXPORT CONFIGURATION
+#define DEFAULT_EXPORT_WIDTH 1920       // px
+#define DEFAULT_EXPORT_HEIGHT 1080      // px
+#define MIN_EXPORT_SIZE 64              // px
+#define MAX_EXPORT_SIZE 7680            // px
+#define MIN_EXPORT_FRAME_RATE 1.0f      // Hz
+#define MAX_EXPORT_FRAME_RATE 240.0f    // Hz
+#define EXPORT_FRAME_RATE_STEP 1.0f     // Hz
+#define DEFAULT_EXPORT_FRAME_RATE 60.0f // Hz
+#define MIN_EXPORT_DURATION 0.5f        // seconds
+#define MAX_EXPORT_DURATION 3600.0f     // seconds
+#define EXPORT_DURATION_STEP 0.5f       // seconds
+#define DEFAULT_EXPORT_DURATION 10.0f   // seconds
+#define EXPORT_QUEUE_DEPTH 8            // Frames read back but not yet encoded, bounds the memory in flight
+#define EXPORT_PATH_CAPACITY 512        // Characters in the output path or command field
+#define EXPORT_BACKGROUND_COLOR sf::Color::Black
+
+// LOGGING CONFIGURATION
+#define LOG_BUFFER_CAPACITY 256  // Records per thread waiting for the writer, power of two
+#define LOG_MESSAGE_CAPACITY 200 // Characters kept per record, longer messages are cut
+#define LOG_FLUSH_INTERVAL 50    // milliseconds between writer passes
 
 // PHYSICS CONFIGURATION
 #define MIN_GRAVITY -50.0f
@@ -41,6 +156,27 @@
 #define AIR_DENSITY_STEP 0.1f
 #define DEFAULT_AIR_DENSITY 1.225f
 
+// N-BODY CONFIGURATION
+#define MIN_GRAVITATIONAL_CONSTANT 0.0f
+#define MAX_GRAVITATIONAL_CONSTANT 100.0f
+#define GRAVITATIONAL_CONSTANT_STEP 0.1f
+#define DEFAULT_GRAVITATIONAL_CONSTANT 1.0f
+
+#define MIN_COULOMB_CONSTANT 0.0f
+#define MAX_COULOMB_CONSTANT 100.0f
+#define COULOMB_CONSTANT_STEP 0.1f
+#define DEFAULT_COULOMB_CONSTANT 1.0f
+
+#define MIN_OPENING_ANGLE 0.0f
+#define MAX_OPENING_ANGLE 1.2f
+#define OPENING_ANGLE_STEP 0.05f
+#define DEFAULT_OPENING_ANGLE 0.5f
+
+#define MIN_SOFTENING 0.001f
+#define MAX_SOFTENING 1.0f
+#define SOFTENING_STEP 0.005f
+#define DEFAULT_SOFTENING 0.05f
+
 // OBJECT & TOOL PROPERTIES LIMITS & DEFAULTS
 #define MIN_LENGTH 0.1f
 #define MAX_LENGTH 10.0f
@@ -59,6 +195,16 @@
 #define MAX_ATTENUATION 1.0f
 #define FORCE_SCALE 0.05f
 
+#define MIN_FIELD_RADIUS 0.5f
+#define MAX_FIELD_RADIUS 40.0f
+#define FIELD_RADIUS_STEP 0.25f
+#define DEFAULT_FIELD_RADIUS 5.0f
+
+#define MIN_CHARGE -10.0f
+#define MAX_CHARGE 10.0f
+#define CHARGE_STEP 0.1f
+#define DEFAULT_CHARGE 0.0f
+
 #define MIN_DRAG 0.0f
 #define MAX_DRAG 1.0f
 #define DRAG_STEP 0.02f
@@ -74,7 +220,31 @@
 #define RESTITUTION_STEP 0.02f
 #define DEFAULT_RESTITUTION 0.7f
 
-#define MIN_SPRING_CONSTANT 0.1f
-#define MAX_SPRING_CONSTANT 10.0f
-#define SPRING_CONSTANT_STEP 0.1f
-#define DEFAULT_SPRING_CONSTANT 1.0f
+#define MIN_SPRING_CONSTANT 1.0f      // N/m
+#define MAX_SPRING_CONSTANT 200.0f    // N/m
+#define SPRING_CONSTANT_STEP 1.0f     // N/m
+#define DEFAULT_SPRING_CONSTANT 50.0f // N/m
+
+#define MIN_SPRING_DAMPING 0.0f     // N·s/m
+#define MAX_SPRING_DAMPING 5.0f     // N·s/m
+#define SPRING_DAMPING_STEP 0.01f   // N·s/m
+#define DEFAULT_SPRING_DAMPING 0.2f // N·s/m
+
+#define MIN_BREAK_STRAIN 0.0f // Never breaks
+#define MAX_BREAK_STRAIN 5.0f
+#define BREAK_STRAIN_STEP 0.05f
+#define DEFAULT_BREAK_STRAIN 0.0f
+
+#define MIN_LATTICE_SIZE 2 // Nodes along a side
+#define MAX_LATTICE_SIZE 100
+#define DEFAULT_LATTICE_SIZE 10
+
+#define MIN_FLUID_RATE 50.0f       // particles/s
+#define MAX_FLUID_RATE 5000.0f     // particles/s
+#define FLUID_RATE_STEP 50.0f      // particles/s
+#define DEFAULT_FLUID_RATE 1000.0f // particles/s
+
+#define MIN_EMITTER_RADIUS 0.1f
+#define MAX_EMITTER_RADIUS 2.0f
+#define EMITTER_RADIUS_STEP 0.05f
+#define DEFAULT_EMITTER_RADIUS 0.3f
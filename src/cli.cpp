@@ -0,0 +1,475 @@
+#include "Config.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include "core/Ensemble.hpp"
+#include "core/Scene.hpp"
+#include "core/World.hpp"
+#include "engine/Log.hpp"
+#include "engine/ThreadPool.hpp"
+
+// One swept parameter and the values it takes
+struct SweepAxis
+{
+    std::string name;
+    std::vector<std::string> values;
+};
+
+// Settings and results of a single headless run
+struct RunResult
+{
+    std::vector<std::string> parameters; // Value of each sweep axis
+    long steps = 0;
+    Scalar initialEnergy = 0.0f;
+    Scalar finalEnergy = 0.0f;
+    Scalar maxEnergyDrift = 0.0f; // Largest relative deviation from the initial energy
+    Scalar momentum = 0.0f;
+    Scalar maxSpeed = 0.0f;
+    long contacts = 0; // Colliding pairs summed over every step
+    std::vector<Vec2> positions;
+};
+
+struct Options
+{
+    std::string scenePath;
+    std::string outputPath;
+    bool json = false;
+    bool positions = false;
+    double time = 10.0;
+    long steps = -1; // Overrides time when set
+    double dt = 0.0; // Overrides the scene's frequency when set
+    size_t ensemble = 0;      // Replicas stepped together, 0 runs plain worlds
+    double jitter = 0.0;      // Uniform initial position perturbation per replica (m)
+    unsigned int seed = 1;
+    std::vector<SweepAxis> sweeps;
+    std::string logPath; // Engine log file, empty logs to stderr
+    std::string logLevel;
+};
+
+static void printUsage()
+{
+    std::cerr << "usage: newton_cli <scene> [options]\n"
+                 "  --time <s>               simulated time (default 10)\n"
+                 "  --steps <n>              number of steps, overrides --time\n"
+                 "  --dt <s>                 fixed step, defaults to 1 / the scene's frequency\n"
+                 "  --sweep <name>=<a>:<b>:<n>  n evenly spaced values from a to b\n"
+                 "  --sweep <name>=<v1>,<v2>    explicit values, axes combine as a grid\n"
+                 "  --format csv|json        output format (default csv)\n"
+                 "  --positions              include the final position of every dynamic object\n"
+                 "  --ensemble <n>           step n replicas of the scene together, one row per replica.\n"
+                 "                           Ensembles only support dynamic circles under gravity, drag and\n"
+                 "                           contacts, so scenes/example.scene, which has a dynamic box, cannot run as one\n"
+                 "  --jitter <m>             perturb each replica's initial positions by up to m meters\n"
+                 "  --seed <n>               random seed for --jitter (default 1)\n"
+                 "  --output <path>          write to a file instead of stdout\n"
+                 "  --log <path>             write the engine log to a file instead of stderr\n"
+                 "  --log-level <level>      trace, debug, info, warning, error or off\n";
+}
+
+static bool parseSweep(const std::string &spec, SweepAxis &axis)
+{
+    size_t equals = spec.find('=');
+    if (equals == std::string::npos || equals == 0)
+        return false;
+    axis.name = spec.substr(0, equals);
+    std::string values = spec.substr(equals + 1);
+
+    // Range form: start:stop:count
+    double start, stop;
+    int count;
+    char tail;
+    if (std::sscanf(values.c_str(), "%lf:%lf:%d%c", &start, &stop, &count, &tail) == 3)
+    {
+        if (count < 1)
+            return false;
+        for (int i = 0; i < count; i++)
+        {
+            double value = count == 1 ? start : start + (stop - start) * i / (count - 1);
+            axis.values.push_back(fmt::format("{}", value));
+        }
+        return true;
+    }
+
+    // List form: v1,v2,...
+    size_t begin = 0;
+    while (begin <= values.size())
+    {
+        size_t comma = values.find(',', begin);
+        if (comma == std::string::npos)
+            comma = values.size();
+        if (comma > begin)
+            axis.values.push_back(values.substr(begin, comma - begin));
+        begin = comma + 1;
+    }
+    return !axis.values.empty();
+}
+
+static bool parseArguments(int argc, char **argv, Options &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--time" && hasValue)
+            options.time = std::atof(argv[++i]);
+        else if (arg == "--steps" && hasValue)
+            options.steps = std::atol(argv[++i]);
+        else if (arg == "--dt" && hasValue)
+            options.dt = std::atof(argv[++i]);
+        else if (arg == "--format" && hasValue)
+        {
+            std::string format = argv[++i];
+            if (format != "csv" && format != "json")
+                return false;
+            options.json = format == "json";
+        }
+        else if (arg == "--output" && hasValue)
+            options.outputPath = argv[++i];
+        else if (arg == "--log" && hasValue)
+            options.logPath = argv[++i];
+        else if (arg == "--log-level" && hasValue)
+            options.logLevel = argv[++i];
+        else if (arg == "--positions")
+            options.positions = true;
+        else if (arg == "--ensemble" && hasValue)
+            options.ensemble = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--jitter" && hasValue)
+            options.jitter = std::atof(argv[++i]);
+        else if (arg == "--seed" && hasValue)
+            options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--sweep" && hasValue)
+        {
+            SweepAxis axis;
+            if (!parseSweep(argv[++i], axis))
+                return false;
+            options.sweeps.push_back(axis);
+        }
+        else if (arg.rfind("--", 0) != 0 && options.scenePath.empty())
+            options.scenePath = arg;
+        else
+            return false;
+    }
+    // Ensemble replicas all share the scene's parameters
+    return !options.scenePath.empty() && (options.ensemble == 0 || options.sweeps.empty());
+}
+
+static Scalar sumEnergy(const World &world)
+{
+    Scalar energy = 0.0f;
+    for (const Object *object : world.getObjects())
+    {
+        if (!object->isStatic)
+            energy += object->body->totalEnergy;
+    }
+    return energy;
+}
+
+// Build a world from the scene with this run's parameters and step it to the end
+static void runScene(const Scene &base, const std::vector<SweepAxis> &sweeps, const Options &options, RunResult &result)
+{
+    Scene scene = base;
+    for (size_t a = 0; a < sweeps.size(); a++)
+    {
+        scene.set(sweeps[a].name, result.parameters[a]);
+    }
+
+    World world;
+    scene.instantiate(world);
+
+    Scalar dt = static_cast<Scalar>(options.dt > 0.0 ? options.dt : 1.0 / scene.frequency);
+    long steps = options.steps >= 0 ? options.steps : static_cast<long>(std::ceil(options.time / dt));
+
+    result.initialEnergy = sumEnergy(world);
+    Scalar scale = std::max<Scalar>(std::abs(result.initialEnergy), 1e-9f);
+    for (long step = 0; step < steps; step++)
+    {
+        world.update(dt);
+        result.contacts += world.contactCount;
+        result.maxEnergyDrift = std::max(result.maxEnergyDrift, std::abs(world.totalEnergy - result.initialEnergy) / scale);
+    }
+
+    result.steps = steps;
+    result.finalEnergy = sumEnergy(world);
+    result.momentum = world.momentum;
+    result.maxSpeed = world.maxSpeed;
+    if (options.positions)
+    {
+        for (const Object *object : world.getObjects())
+        {
+            if (!object->isStatic)
+                result.positions.push_back(standardizePosition(object->body->position));
+        }
+    }
+}
+
+// Step perturbed replicas of the scene in lockstep, one result per replica
+static bool runEnsemble(const Scene &scene, const Options &options, std::vector<RunResult> &results, std::string &error)
+{
+    World prototype;
+    scene.instantiate(prototype);
+
+    Ensemble ensemble;
+    if (!ensemble.build(prototype, options.ensemble, error))
+        return false;
+
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> offset(-options.jitter, options.jitter);
+    for (size_t r = 0; options.jitter > 0.0 && r < ensemble.getReplicaCount(); r++)
+    {
+        for (size_t k = 0; k < ensemble.getBodyCount(); k++)
+        {
+            Vec2 position = ensemble.getPosition(k, r) + Vec2(static_cast<Scalar>(offset(random)), static_cast<Scalar>(offset(random)));
+            ensemble.setState(k, r, position, ensemble.getVelocity(k, r));
+        }
+    }
+
+    Scalar dt = static_cast<Scalar>(options.dt > 0.0 ? options.dt : 1.0 / scene.frequency);
+    long steps = options.steps >= 0 ? options.steps : static_cast<long>(std::ceil(options.time / dt));
+
+    results.assign(ensemble.getReplicaCount(), RunResult());
+    for (size_t r = 0; r < results.size(); r++)
+    {
+        results[r].initialEnergy = ensemble.energy(r);
+    }
+    for (long step = 0; step < steps; step++)
+    {
+        ensemble.step(dt);
+        for (size_t r = 0; r < results.size(); r++)
+        {
+            Scalar scale = std::max<Scalar>(std::abs(results[r].initialEnergy), 1e-9f);
+            results[r].maxEnergyDrift = std::max(results[r].maxEnergyDrift, std::abs(ensemble.energy(r) - results[r].initialEnergy) / scale);
+        }
+    }
+
+    for (size_t r = 0; r < results.size(); r++)
+    {
+        RunResult &result = results[r];
+        result.steps = steps;
+        result.finalEnergy = ensemble.energy(r);
+        result.momentum = ensemble.momentum(r);
+        result.contacts = ensemble.contacts(r);
+        Scalar maxSpeedSq = 0.0f;
+        for (size_t k = 0; k < ensemble.getBodyCount(); k++)
+        {
+            Vec2 velocity = ensemble.getVelocity(k, r);
+            maxSpeedSq = std::max(maxSpeedSq, velocity.lengthSquared());
+            if (options.positions)
+                result.positions.push_back(standardizePosition(ensemble.getPosition(k, r)));
+        }
+        result.maxSpeed = std::sqrt(maxSpeedSq);
+    }
+    return true;
+}
+
+static Scalar relativeDrift(const RunResult &result)
+{
+    return (result.finalEnergy - result.initialEnergy) / std::max<Scalar>(std::abs(result.initialEnergy), 1e-9f);
+}
+
+static void writeCsv(std::FILE *out, const std::vector<SweepAxis> &sweeps, const std::vector<RunResult> &results)
+{
+    fmt::memory_buffer line;
+    fmt::format_to(std::back_inserter(line), "run");
+    for (const SweepAxis &axis : sweeps)
+    {
+        fmt::format_to(std::back_inserter(line), ",{}", axis.name);
+    }
+    fmt::format_to(std::back_inserter(line), ",steps,initial_energy,final_energy,energy_drift,max_energy_drift,momentum,max_speed,contacts");
+    size_t positionCount = results.empty() ? 0 : results[0].positions.size();
+    for (size_t p = 0; p < positionCount; p++)
+    {
+        fmt::format_to(std::back_inserter(line), ",x{0},y{0}", p);
+    }
+    fmt::format_to(std::back_inserter(line), "\n");
+
+    for (size_t r = 0; r < results.size(); r++)
+    {
+        const RunResult &result = results[r];
+        fmt::format_to(std::back_inserter(line), "{}", r);
+        for (const std::string &value : result.parameters)
+        {
+            fmt::format_to(std::back_inserter(line), ",{}", value);
+        }
+        fmt::format_to(std::back_inserter(line), ",{},{},{},{},{},{},{},{}", result.steps, result.initialEnergy, result.finalEnergy,
+                       relativeDrift(result), result.maxEnergyDrift, result.momentum, result.maxSpeed, result.contacts);
+        for (const Vec2 &position : result.positions)
+        {
+            fmt::format_to(std::back_inserter(line), ",{},{}", position.x, position.y);
+        }
+        fmt::format_to(std::back_inserter(line), "\n");
+    }
+    std::fwrite(line.data(), 1, line.size(), out);
+}
+
+// JSON string literal of text, axis names and values come straight from the command line
+static std::string jsonString(const std::string &text)
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        if (static_cast<unsigned char>(c) < 0x20)
+            quoted += fmt::format("\\u{:04x}", static_cast<int>(c));
+        else
+            quoted += c;
+    }
+    return quoted + '"';
+}
+
+static void writeJson(std::FILE *out, const std::vector<SweepAxis> &sweeps, const std::vector<RunResult> &results)
+{
+    fmt::memory_buffer text;
+    fmt::format_to(std::back_inserter(text), "[\n");
+    for (size_t r = 0; r < results.size(); r++)
+    {
+        const RunResult &result = results[r];
+        fmt::format_to(std::back_inserter(text), "  {{\"run\": {}, \"parameters\": {{", r);
+        for (size_t a = 0; a < sweeps.size(); a++)
+        {
+            fmt::format_to(std::back_inserter(text), "{}{}: {}", a > 0 ? ", " : "", jsonString(sweeps[a].name), jsonString(result.parameters[a]));
+        }
+        fmt::format_to(std::back_inserter(text), "}}");
+        fmt::format_to(std::back_inserter(text), ", \"steps\": {}, \"initial_energy\": {}, \"final_energy\": {}, \"energy_drift\": {}, \"max_energy_drift\": {}, \"momentum\": {}, \"max_speed\": {}, \"contacts\": {}",
+                       result.steps, result.initialEnergy, result.finalEnergy, relativeDrift(result), result.maxEnergyDrift, result.momentum, result.maxSpeed, result.contacts);
+        if (!result.positions.empty())
+        {
+            fmt::format_to(std::back_inserter(text), ", \"positions\": [");
+            for (size_t p = 0; p < result.positions.size(); p++)
+            {
+                fmt::format_to(std::back_inserter(text), "{}[{}, {}]", p > 0 ? ", " : "", result.positions[p].x, result.positions[p].y);
+            }
+            fmt::format_to(std::back_inserter(text), "]");
+        }
+        fmt::format_to(std::back_inserter(text), "}}{}\n", r + 1 < results.size() ? "," : "");
+    }
+    fmt::format_to(std::back_inserter(text), "]\n");
+    std::fwrite(text.data(), 1, text.size(), out);
+}
+
+// Headless entry point: load a scene, run every combination of the swept parameters across all cores, write the metrics
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parseArguments(argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (!options.logLevel.empty())
+    {
+        LogLevel level;
+        if (!Log::parseLevel(options.logLevel, level))
+        {
+            printUsage();
+            return 1;
+        }
+        Log::setLevel(level);
+    }
+    if (!options.logPath.empty() && !Log::open(options.logPath))
+    {
+        std::cerr << "newton_cli: cannot write '" << options.logPath << "'\n";
+        return 1;
+    }
+
+    // Parse the scene once, every run copies it
+    Scene scene;
+    std::string error;
+    if (!scene.load(options.scenePath, error))
+    {
+        std::cerr << "newton_cli: " << error << "\n";
+        return 1;
+    }
+
+    std::vector<RunResult> results;
+    if (options.ensemble > 0)
+    {
+        if (!runEnsemble(scene, options, results, error))
+        {
+            std::cerr << "newton_cli: " << error << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        // Reject unknown parameters before anything runs
+        for (const SweepAxis &axis : options.sweeps)
+        {
+            for (const std::string &value : axis.values)
+            {
+                Scene probe = scene;
+                if (!probe.set(axis.name, value))
+                {
+                    std::cerr << "newton_cli: invalid sweep value " << axis.name << "=" << value << "\n";
+                    return 1;
+                }
+            }
+        }
+
+        // Grid of every combination of the sweep values
+        size_t runCount = 1;
+        for (const SweepAxis &axis : options.sweeps)
+        {
+            runCount *= axis.values.size();
+        }
+        results.resize(runCount);
+        for (size_t r = 0; r < runCount; r++)
+        {
+            size_t index = r;
+            for (size_t a = options.sweeps.size(); a-- > 0;)
+            {
+                const SweepAxis &axis = options.sweeps[a];
+                results[r].parameters.insert(results[r].parameters.begin(), axis.values[index % axis.values.size()]);
+                index /= axis.values.size();
+            }
+        }
+
+        // A single run keeps the whole pool for its own parallel passes. Sweeps give each worker and the calling
+        // thread whole runs instead, pulled from a shared counter since runs differ in length.
+        if (runCount == 1)
+        {
+            runScene(scene, options.sweeps, options, results[0]);
+        }
+        else
+        {
+            ThreadPool &pool = ThreadPool::shared();
+            std::atomic<size_t> nextRun(0);
+            pool.parallelFor(std::min(pool.size() + 1, runCount), [&](size_t, size_t)
+                             {
+                for (size_t r = nextRun++; r < runCount; r = nextRun++)
+                {
+                    runScene(scene, options.sweeps, options, results[r]);
+                } });
+        }
+    }
+
+    std::FILE *out = stdout;
+    if (!options.outputPath.empty())
+    {
+        out = std::fopen(options.outputPath.c_str(), "w");
+        if (out == nullptr)
+        {
+            std::cerr << "newton_cli: cannot write '" << options.outputPath << "'\n";
+            return 1;
+        }
+    }
+
+    if (options.json)
+        writeJson(out, options.sweeps, results);
+    else
+        writeCsv(out, options.sweeps, results);
+
+    if (out != stdout)
+        std::fclose(out);
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "AssetCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "EmbeddedAssets.hpp" // Generated by embed_assets.cmake
+#include "engine/Log.hpp"
+
+// Box-filter an image into a cell, keeping its aspect ratio and centering it.
+// Colors are averaged weighted by alpha so transparent pixels do not darken the edges.
+static void downsampleInto(const sf::Image &source, std::uint8_t *pixels, unsigned int stride, sf::Vector2u cellOrigin, unsigned int cellSize)
+{
+    sf::Vector2u size = source.getSize();
+    if (size.x == 0 || size.y == 0)
+        return;
+
+    float scale = std::min(1.0f, static_cast<float>(cellSize) / std::max(size.x, size.y));
+    unsigned int width = std::max(1u, static_cast<unsigned int>(std::lround(size.x * scale)));
+    unsigned int height = std::max(1u, static_cast<unsigned int>(std::lround(size.y * scale)));
+    unsigned int offsetX = cellOrigin.x + (cellSize - width) / 2;
+    unsigned int offsetY = cellOrigin.y + (cellSize - height) / 2;
+    const std::uint8_t *src = source.getPixelsPtr();
+
+    for (unsigned int y = 0; y < height; y++)
+    {
+        unsigned int y0 = y * size.y / height;
+        unsigned int y1 = std::max(y0 + 1, (y + 1) * size.y / height);
+        for (unsigned int x = 0; x < width; x++)
+        {
+            unsigned int x0 = x * size.x / width;
+            unsigned int x1 = std::max(x0 + 1, (x + 1) * size.x / width);
+
+            std::uint64_t r = 0, g = 0, b = 0, a = 0;
+            for (unsigned int sy = y0; sy < y1; sy++)
+            {
+                const std::uint8_t *row = src + (static_cast<size_t>(sy) * size.x + x0) * 4;
+                for (unsigned int sx = x0; sx < x1; sx++, row += 4)
+                {
+                    r += row[0] * row[3];
+                    g += row[1] * row[3];
+                    b += row[2] * row[3];
+                    a += row[3];
+                }
+            }
+
+            std::uint8_t *out = pixels + (static_cast<size_t>(offsetY + y) * stride + offsetX + x) * 4;
+            std::uint64_t count = static_cast<std::uint64_t>(x1 - x0) * (y1 - y0);
+            if (a > 0)
+            {
+                out[0] = static_cast<std::uint8_t>(r / a);
+                out[1] = static_cast<std::uint8_t>(g / a);
+                out[2] = static_cast<std::uint8_t>(b / a);
+                out[3] = static_cast<std::uint8_t>(a / count);
+            }
+        }
+    }
+}
+
+AssetCache::~AssetCache()
+{
+    for (auto &entry : images)
+    {
+        delete entry.second;
+    }
+    delete toolAtlas;
+}
+
+const sf::Image *AssetCache::getImage(const std::string &name)
+{
+    auto cached = images.find(name);
+    if (cached != images.end())
+        return cached->second;
+
+    // Failed lookups are cached too, so a missing asset is only searched for once
+    sf::Image *image = nullptr;
+    for (const EmbeddedAsset &asset : embeddedAssets)
+    {
+        if (std::strcmp(asset.name, name.c_str()) != 0)
+            continue;
+
+        image = new sf::Image();
+        if (!image->loadFromMemory(asset.data, asset.size))
+        {
+            delete image;
+            image = nullptr;
+        }
+        break;
+    }
+    images[name] = image;
+    return image;
+}
+
+const TextureAtlas &AssetCache::getToolAtlas()
+{
+    if (toolAtlas != nullptr)
+        return *toolAtlas;
+
+    toolAtlas = new TextureAtlas();
+
+    // Square-ish grid of padded cells, tools without an icon keep an empty cell
+    unsigned int count = TOOL_END;
+    unsigned int columns = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<float>(count))));
+    unsigned int rows = (count + columns - 1) / columns;
+    unsigned int cellStride = TOOLS_ATLAS_CELL + 2 * TOOLS_ATLAS_PADDING;
+    sf::Vector2u atlasSize(columns * cellStride, rows * cellStride);
+    std::vector<std::uint8_t> pixels(static_cast<size_t>(atlasSize.x) * atlasSize.y * 4, 0);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        sf::Vector2u origin((i % columns) * cellStride + TOOLS_ATLAS_PADDING, (i / columns) * cellStride + TOOLS_ATLAS_PADDING);
+        toolAtlas->regions.push_back(sf::IntRect(sf::Vector2i(origin), sf::Vector2i(TOOLS_ATLAS_CELL, TOOLS_ATLAS_CELL)));
+
+        const char *icon = getToolIcon(static_cast<ToolType>(i));
+        const sf::Image *image = icon != nullptr ? getImage(icon) : nullptr;
+        if (image != nullptr)
+            downsampleInto(*image, pixels.data(), atlasSize.x, origin, TOOLS_ATLAS_CELL);
+    }
+
+    sf::Image atlasImage(atlasSize, pixels.data());
+    if (!toolAtlas->texture.loadFromImage(atlasImage))
+        LOG_ERROR(LOG_GENERAL, "cannot create the tool icon texture");
+    toolAtlas->texture.setSmooth(true);
+    return *toolAtlas;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Config.h"
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "objects/Tool.hpp"
+
+// One texture holding several images, each addressed by its region
+struct TextureAtlas
+{
+    sf::Texture texture;
+    std::vector<sf::IntRect> regions;
+};
+
+// Decodes the assets embedded in the executable on first use and keeps them, so nothing is decoded twice
+class AssetCache
+{
+private:
+    std::unordered_map<std::string, sf::Image *> images;
+    TextureAtlas *toolAtlas = nullptr;
+
+public:
+    // Constructors & Destructor
+    AssetCache() = default;
+    AssetCache(const AssetCache &) = delete;
+    AssetCache &operator=(const AssetCache &) = delete;
+    ~AssetCache();
+
+    // Methods
+    const sf::Image *getImage(const std::string &name); // nullptr if no asset has that name or it fails to decode
+    const TextureAtlas &getToolAtlas();                 // Every tool icon packed into one texture, region i is tool i
+};
@@ -0,0 +1,396 @@
+#include "Ensemble.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+#include "engine/ThreadPool.hpp"
+
+#define ENSEMBLE_MIN_CHUNK 256 // Replicas per task before a step is split across threads
+
+bool Ensemble::build(const World &prototype, size_t replicas, std::string &error)
+{
+    replicaCount = replicas;
+    bodyCount = 0;
+    radius.clear();
+    mass.clear();
+    invMass.clear();
+    restitution.clear();
+    dragFactor.clear();
+    gravityScale.clear();
+    obstacles.clear();
+
+    gravity = prototype.gravity;
+    solver = prototype.getODESolver();
+    contactCounts.assign(replicas, 0);
+
+    // Only gravity, drag and contacts are simulated, anything else would be silently dropped
+    if (prototype.nbody.doGravity || prototype.nbody.doElectrostatics)
+    {
+        error = "ensembles do not support mutual gravity or electrostatics";
+        return false;
+    }
+    if (!prototype.getPrograms().empty())
+    {
+        error = "ensembles do not support force programs";
+        return false;
+    }
+    if (!prototype.getSprings().getSprings().empty())
+    {
+        error = "ensembles do not support springs or soft bodies";
+        return false;
+    }
+    if (prototype.getFluid().isActive())
+    {
+        error = "ensembles do not support fluid";
+        return false;
+    }
+    if (!prototype.getFields().empty())
+    {
+        error = "ensembles do not support force fields";
+        return false;
+    }
+
+    std::vector<const Body *> dynamicBodies;
+    for (const Object *object : prototype.getObjects())
+    {
+        const Body *body = object->body;
+        if (object->isStatic)
+        {
+            EnsembleObstacle obstacle;
+            obstacle.shape = object->shapeType;
+            obstacle.box = makeBox(object);
+            obstacle.center = body->position;
+            obstacle.radius = object->dimensions.x;
+            obstacle.restitution = body->restitution;
+            obstacles.push_back(obstacle);
+            continue;
+        }
+
+        if (object->shapeType != CIRCLE)
+        {
+            error = fmt::format("ensembles only support dynamic circles, object {} is a dynamic rectangle", object->getID());
+            return false;
+        }
+
+        dynamicBodies.push_back(body);
+        radius.push_back(object->dimensions.x);
+        mass.push_back(body->mass);
+        invMass.push_back(body->invMass);
+        restitution.push_back(body->restitution);
+        bool hasDrag = object->doDrag && body->dragCoefficient != 0.0f;
+        dragFactor.push_back(hasDrag ? 0.5f * prototype.airDensity * object->dimensions.x * body->dragCoefficient : 0.0f);
+        gravityScale.push_back(object->doGravity ? 1.0f : 0.0f);
+    }
+    bodyCount = dynamicBodies.size();
+
+    size_t lanes = bodyCount * replicaCount;
+    positionX.resize(lanes);
+    positionY.resize(lanes);
+    velocityX.resize(lanes);
+    velocityY.resize(lanes);
+    angle.resize(lanes);
+    angularVelocity.resize(lanes);
+    for (size_t k = 0; k < bodyCount; k++)
+    {
+        const Body *body = dynamicBodies[k];
+        size_t row = k * replicaCount;
+        std::fill(positionX.begin() + row, positionX.begin() + row + replicaCount, body->position.x);
+        std::fill(positionY.begin() + row, positionY.begin() + row + replicaCount, body->position.y);
+        std::fill(velocityX.begin() + row, velocityX.begin() + row + replicaCount, body->velocity.x);
+        std::fill(velocityY.begin() + row, velocityY.begin() + row + replicaCount, body->velocity.y);
+        std::fill(angle.begin() + row, angle.begin() + row + replicaCount, body->angle);
+        std::fill(angularVelocity.begin() + row, angularVelocity.begin() + row + replicaCount, body->angularVelocity);
+    }
+    return true;
+}
+
+// One body's lanes for replicas [begin, end), the restrict parameters let the replica loops vectorize
+static void integrateLanes(SolverType solver, size_t begin, size_t end, Scalar dt, Scalar gx, Scalar gy, Scalar drag,
+                           Scalar *__restrict px, Scalar *__restrict py, Scalar *__restrict vx, Scalar *__restrict vy,
+                           Scalar *__restrict theta, const Scalar *__restrict omega)
+{
+    const Scalar halfDt = dt * 0.5f;
+    const Scalar sixthDt = dt / 6.0f;
+
+    // Gravity plus quadratic drag, forces only depend on the velocity
+    auto accelerate = [gx, gy, drag](Scalar ux, Scalar uy, Scalar &ax, Scalar &ay)
+    {
+        Scalar speed = std::sqrt(ux * ux + uy * uy);
+        ax = gx - drag * speed * ux;
+        ay = gy - drag * speed * uy;
+    };
+
+    switch (solver)
+    {
+    case EULER:
+        for (size_t r = begin; r < end; r++)
+        {
+            Scalar ax, ay;
+            accelerate(vx[r], vy[r], ax, ay);
+            vx[r] += ax * dt;
+            vy[r] += ay * dt;
+            px[r] += vx[r] * dt;
+            py[r] += vy[r] * dt;
+            theta[r] += omega[r] * dt;
+        }
+        break;
+    case RK2:
+        for (size_t r = begin; r < end; r++)
+        {
+            Scalar a1x, a1y, a2x, a2y;
+            accelerate(vx[r], vy[r], a1x, a1y);
+            Scalar mx = vx[r] + a1x * halfDt;
+            Scalar my = vy[r] + a1y * halfDt;
+            accelerate(mx, my, a2x, a2y);
+            px[r] += mx * dt;
+            py[r] += my * dt;
+            vx[r] += a2x * dt;
+            vy[r] += a2y * dt;
+            theta[r] += omega[r] * dt;
+        }
+        break;
+    default:
+        for (size_t r = begin; r < end; r++)
+        {
+            Scalar a1x, a1y, a2x, a2y, a3x, a3y, a4x, a4y;
+            Scalar v1x = vx[r], v1y = vy[r];
+            accelerate(v1x, v1y, a1x, a1y);
+            Scalar v2x = v1x + a1x * halfDt, v2y = v1y + a1y * halfDt;
+            accelerate(v2x, v2y, a2x, a2y);
+            Scalar v3x = v1x + a2x * halfDt, v3y = v1y + a2y * halfDt;
+            accelerate(v3x, v3y, a3x, a3y);
+            Scalar v4x = v1x + a3x * dt, v4y = v1y + a3y * dt;
+            accelerate(v4x, v4y, a4x, a4y);
+
+            px[r] += (v1x + 2.0f * (v2x + v3x) + v4x) * sixthDt;
+            py[r] += (v1y + 2.0f * (v2y + v3y) + v4y) * sixthDt;
+            vx[r] += (a1x + 2.0f * (a2x + a3x) + a4x) * sixthDt;
+            vy[r] += (a1y + 2.0f * (a2y + a3y) + a4y) * sixthDt;
+            theta[r] += omega[r] * dt;
+        }
+        break;
+    }
+}
+
+void Ensemble::integrate(size_t begin, size_t end, Scalar dt)
+{
+    for (size_t k = 0; k < bodyCount; k++)
+    {
+        size_t row = k * replicaCount;
+        integrateLanes(solver, begin, end, dt, gravity.x * gravityScale[k], gravity.y * gravityScale[k], dragFactor[k] * invMass[k],
+                       positionX.data() + row, positionY.data() + row, velocityX.data() + row, velocityY.data() + row,
+                       angle.data() + row, angularVelocity.data() + row);
+    }
+}
+
+// Circle against an oriented box, normal points from the box to the circle
+static inline bool circleBoxContact(Scalar px, Scalar py, Scalar radius, const OrientedBox &box, Scalar &nx, Scalar &ny, Scalar &penetration)
+{
+    Scalar dx = px - box.center.x;
+    Scalar dy = py - box.center.y;
+    Scalar lx = dx * box.cos + dy * box.sin;
+    Scalar ly = -dx * box.sin + dy * box.cos;
+
+    Scalar cx = std::max(-box.halfSize.x, std::min(lx, box.halfSize.x));
+    Scalar cy = std::max(-box.halfSize.y, std::min(ly, box.halfSize.y));
+    Scalar ex = lx - cx;
+    Scalar ey = ly - cy;
+    Scalar distSquared = ex * ex + ey * ey;
+    if (distSquared >= radius * radius)
+        return false;
+
+    Scalar localX, localY;
+    Scalar dist = std::sqrt(distSquared);
+    if (dist > 0.0f)
+    {
+        penetration = radius - dist;
+        localX = ex / dist;
+        localY = ey / dist;
+    }
+    else if (box.halfSize.x - std::abs(cx) < box.halfSize.y - std::abs(cy))
+    {
+        // Center inside the box, push out on the closest axis
+        penetration = radius + box.halfSize.x - std::abs(cx);
+        localX = lx > 0 ? 1.0f : -1.0f;
+        localY = 0.0f;
+    }
+    else
+    {
+        penetration = radius + box.halfSize.y - std::abs(cy);
+        localX = 0.0f;
+        localY = ly > 0 ? 1.0f : -1.0f;
+    }
+
+    nx = localX * box.cos - localY * box.sin;
+    ny = localX * box.sin + localY * box.cos;
+    return true;
+}
+
+// Positional correction and restitution impulse between two lanes, the normal points from B to A.
+// Mirrors resolveCollision for circles, whose contact impulses never change their spin, without its "normal" force sources.
+static inline void resolveLaneContact(Scalar &pax, Scalar &pay, Scalar &vax, Scalar &vay, Scalar invMassA,
+                                      Scalar &pbx, Scalar &pby, Scalar &vbx, Scalar &vby, Scalar invMassB,
+                                      Scalar nx, Scalar ny, Scalar penetration, Scalar e)
+{
+    Scalar invMassSum = invMassA + invMassB;
+    Scalar correction = std::max<Scalar>(penetration - CONTACT_SLOP, 0.0f) / invMassSum * CONTACT_CORRECTION;
+    pax += nx * correction * invMassA;
+    pay += ny * correction * invMassA;
+    pbx -= nx * correction * invMassB;
+    pby -= ny * correction * invMassB;
+
+    Scalar vNormal = (vbx - vax) * nx + (vby - vay) * ny;
+    if (vNormal < 0.01f)
+        return; // Separating or negligible
+
+    Scalar impulse = -(1.0f + e) * vNormal / invMassSum;
+    vax -= nx * impulse * invMassA;
+    vay -= ny * impulse * invMassA;
+    vbx += nx * impulse * invMassB;
+    vby += ny * impulse * invMassB;
+}
+
+// Same against an obstacle, which has infinite mass
+static inline void resolveObstacleContact(Scalar &px, Scalar &py, Scalar &vx, Scalar &vy,
+                                          Scalar nx, Scalar ny, Scalar penetration, Scalar e)
+{
+    Scalar correction = std::max<Scalar>(penetration - CONTACT_SLOP, 0.0f) * CONTACT_CORRECTION;
+    px += nx * correction;
+    py += ny * correction;
+
+    Scalar vNormal = -(vx * nx + vy * ny);
+    if (vNormal < 0.01f)
+        return;
+
+    vx += nx * (1.0f + e) * vNormal;
+    vy += ny * (1.0f + e) * vNormal;
+}
+
+void Ensemble::resolveContacts(size_t begin, size_t end)
+{
+    for (size_t r = begin; r < end; r++)
+    {
+        long contacts = 0;
+        for (size_t i = 0; i < bodyCount; i++)
+        {
+            size_t a = i * replicaCount + r;
+
+            for (const EnsembleObstacle &obstacle : obstacles)
+            {
+                Scalar nx, ny, penetration;
+                bool touching;
+                if (obstacle.shape == RECTANGLE)
+                {
+                    touching = circleBoxContact(positionX[a], positionY[a], radius[i], obstacle.box, nx, ny, penetration);
+                }
+                else
+                {
+                    Scalar dx = positionX[a] - obstacle.center.x;
+                    Scalar dy = positionY[a] - obstacle.center.y;
+                    Scalar distance = std::sqrt(dx * dx + dy * dy);
+                    touching = distance < radius[i] + obstacle.radius;
+                    nx = distance > 0.0f ? dx / distance : 1.0f;
+                    ny = distance > 0.0f ? dy / distance : 0.0f;
+                    penetration = radius[i] + obstacle.radius - distance;
+                }
+
+                if (touching)
+                {
+                    contacts++;
+                    resolveObstacleContact(positionX[a], positionY[a], velocityX[a], velocityY[a],
+                                           nx, ny, penetration, std::min(restitution[i], obstacle.restitution));
+                }
+            }
+
+            for (size_t j = i + 1; j < bodyCount; j++)
+            {
+                size_t b = j * replicaCount + r;
+                Scalar dx = positionX[a] - positionX[b];
+                Scalar dy = positionY[a] - positionY[b];
+                Scalar radiusSum = radius[i] + radius[j];
+                Scalar distSquared = dx * dx + dy * dy;
+                if (distSquared >= radiusSum * radiusSum)
+                    continue;
+
+                contacts++;
+                Scalar distance = std::sqrt(distSquared);
+                Scalar nx = distance > 0.0f ? dx / distance : 1.0f;
+                Scalar ny = distance > 0.0f ? dy / distance : 0.0f;
+                resolveLaneContact(positionX[a], positionY[a], velocityX[a], velocityY[a], invMass[i],
+                                   positionX[b], positionY[b], velocityX[b], velocityY[b], invMass[j],
+                                   nx, ny, radiusSum - distance, std::min(restitution[i], restitution[j]));
+            }
+        }
+        contactCounts[r] += contacts;
+    }
+}
+
+void Ensemble::step(Scalar dt)
+{
+    ThreadPool::shared().parallelFor(replicaCount, [this, dt](size_t begin, size_t end)
+                                     {
+        resolveContacts(begin, end);
+        integrate(begin, end, dt); }, ENSEMBLE_MIN_CHUNK);
+}
+
+size_t Ensemble::getReplicaCount() const
+{
+    return replicaCount;
+}
+
+size_t Ensemble::getBodyCount() const
+{
+    return bodyCount;
+}
+
+Vec2 Ensemble::getPosition(size_t body, size_t replica) const
+{
+    size_t i = body * replicaCount + replica;
+    return Vec2(positionX[i], positionY[i]);
+}
+
+Vec2 Ensemble::getVelocity(size_t body, size_t replica) const
+{
+    size_t i = body * replicaCount + replica;
+    return Vec2(velocityX[i], velocityY[i]);
+}
+
+void Ensemble::setState(size_t body, size_t replica, const Vec2 &position, const Vec2 &velocity)
+{
+    size_t i = body * replicaCount + replica;
+    positionX[i] = position.x;
+    positionY[i] = position.y;
+    velocityX[i] = velocity.x;
+    velocityY[i] = velocity.y;
+}
+
+Scalar Ensemble::energy(size_t replica) const
+{
+    Scalar total = 0.0f;
+    for (size_t k = 0; k < bodyCount; k++)
+    {
+        size_t i = k * replicaCount + replica;
+        Scalar speedSq = velocityX[i] * velocityX[i] + velocityY[i] * velocityY[i];
+        Scalar inertia = 0.5f * mass[k] * radius[k] * radius[k];
+        Scalar kinetic = 0.5f * mass[k] * speedSq + 0.5f * inertia * angularVelocity[i] * angularVelocity[i];
+        Scalar potential = dot(standardizePosition(Vec2(positionX[i], positionY[i])), gravity) * mass[k];
+        total += kinetic + potential;
+    }
+    return total;
+}
+
+long Ensemble::contacts(size_t replica) const
+{
+    return contactCounts[replica];
+}
+
+Scalar Ensemble::momentum(size_t replica) const
+{
+    Vec2 total;
+    for (size_t k = 0; k < bodyCount; k++)
+    {
+        size_t i = k * replicaCount + replica;
+        total += Vec2(velocityX[i], velocityY[i]) * mass[k];
+    }
+    return total.length();
+}
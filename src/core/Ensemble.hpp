@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Config.h"
+
+#include <string>
+#include <vector>
+#include "core/World.hpp"
+#include "engine/Collision.hpp"
+
+// Static shape shared by every replica
+struct EnsembleObstacle
+{
+    ShapeType shape;
+    OrientedBox box; // Rectangles
+    Vec2 center;     // Circles
+    Scalar radius = 0.0f;
+    Scalar restitution = 0.0f;
+};
+
+// Many replicas of one small world stepped in lockstep. Body k of every replica is stored contiguously,
+// so the force and integration kernels run across replicas instead of across bodies and vectorize.
+// Dynamic bodies must be circles, static objects of either shape become obstacles shared by all replicas.
+// Gravity, drag and contacts are simulated; worlds with n-body forces, force programs, springs, fluid or
+// force fields are refused.
+class Ensemble
+{
+private:
+    size_t replicaCount = 0;
+    size_t bodyCount = 0;
+
+    // Per body and replica, indexed body * replicaCount + replica
+    std::vector<Scalar> positionX, positionY;
+    std::vector<Scalar> velocityX, velocityY;
+    std::vector<Scalar> angle, angularVelocity;
+
+    // Per body, identical in every replica
+    std::vector<Scalar> radius;
+    std::vector<Scalar> mass;
+    std::vector<Scalar> invMass;
+    std::vector<Scalar> restitution;
+    std::vector<Scalar> dragFactor;   // ½ ρ A Cd, zero without drag
+    std::vector<Scalar> gravityScale; // 1 with gravity, 0 without
+
+    std::vector<EnsembleObstacle> obstacles;
+    std::vector<long> contactCounts; // Per replica, colliding pairs summed over every step
+
+    Vec2 gravity;
+    SolverType solver = DEFAULT_SOLVER;
+
+    void integrate(size_t begin, size_t end, Scalar dt); // Advance replicas [begin, end) for every body
+    void resolveContacts(size_t begin, size_t end);       // Per-replica contacts for replicas [begin, end)
+
+public:
+    // Methods
+    // Copy the bodies and settings of a prototype world into every replica, error explains unsupported objects
+    bool build(const World &prototype, size_t replicas, std::string &error);
+
+    void step(Scalar dt); // Advance every replica, replica ranges run in parallel
+
+    size_t getReplicaCount() const;
+    size_t getBodyCount() const;
+
+    Vec2 getPosition(size_t body, size_t replica) const;
+    Vec2 getVelocity(size_t body, size_t replica) const;
+    void setState(size_t body, size_t replica, const Vec2 &position, const Vec2 &velocity); // Perturb initial conditions
+
+    Scalar energy(size_t replica) const;   // Kinetic and gravitational energy of one replica
+    Scalar momentum(size_t replica) const; // Magnitude of one replica's total linear momentum
+    long contacts(size_t replica) const;   // Colliding pairs of one replica summed over every step
+};
@@ -0,0 +1,235 @@
+#include "Exporter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <filesystem>
+#include <fmt/format.h>
+
+Exporter::~Exporter()
+{
+    cancel();
+    if (renderer.joinable())
+        renderer.join();
+}
+
+void Exporter::start(const World &source, const ExportSettings &settings)
+{
+    if (active)
+        return;
+    if (renderer.joinable())
+        renderer.join();
+
+    // Copy everything that is drawn, including the walls
+    World *copy = new World();
+    copy->copyContents(source);
+
+    world = copy;
+    this->settings = settings;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.clear();
+        error.clear();
+        rendering = true;
+        cancelled = false;
+    }
+    framesWritten = 0;
+    frameCount = static_cast<size_t>(std::max(1L, std::lround(settings.duration * settings.frameRate)));
+    active = true;
+    renderer = std::thread(&Exporter::render, this);
+}
+
+void Exporter::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+    }
+    frameQueued.notify_all();
+    frameConsumed.notify_all();
+}
+
+bool Exporter::isActive() const
+{
+    return active;
+}
+
+float Exporter::getProgress() const
+{
+    size_t count = frameCount;
+    return count > 0 ? static_cast<float>(framesWritten) / count : 0.0f;
+}
+
+std::string Exporter::getError()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+void Exporter::fail(const std::string &message)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error.empty())
+            error = message;
+    }
+    cancel();
+}
+
+bool Exporter::open()
+{
+    if (settings.format == EXPORT_PNG)
+    {
+        std::error_code code;
+        std::filesystem::create_directories(settings.output, code);
+        if (code)
+        {
+            fail(fmt::format("cannot create '{}': {}", settings.output, code.message()));
+            return false;
+        }
+        return true;
+    }
+
+    std::string command;
+    try
+    {
+        command = fmt::format(fmt::runtime(settings.output), fmt::arg("width", settings.width), fmt::arg("height", settings.height), fmt::arg("fps", settings.frameRate));
+    }
+    catch (const fmt::format_error &)
+    {
+        fail("invalid placeholder in the export command, use {width}, {height} and {fps}");
+        return false;
+    }
+
+#ifdef _WIN32
+    pipe = _popen(command.c_str(), "wb");
+#else
+    // A command that exits early must fail the export, not kill the application
+    std::signal(SIGPIPE, SIG_IGN);
+    pipe = popen(command.c_str(), "w");
+#endif
+    if (pipe == nullptr)
+    {
+        fail(fmt::format("cannot run '{}'", command));
+        return false;
+    }
+    return true;
+}
+
+void Exporter::render()
+{
+    if (open())
+    {
+        sf::RenderTexture target;
+        if (!target.resize(sf::Vector2u(settings.width, settings.height)))
+            fail("cannot create the offscreen render target");
+
+        // A pipe takes frames in order, so it gets a single writer
+        unsigned int encoderCount = settings.format == EXPORT_PIPE ? 1u : std::max(1u, std::thread::hardware_concurrency() - 1);
+        for (unsigned int i = 0; i < encoderCount; i++)
+        {
+            encoders.emplace_back(&Exporter::encode, this);
+        }
+
+        sf::View view = settings.view;
+        view.setSize(sf::Vector2f(view.getSize().x, view.getSize().x * settings.height / settings.width));
+        target.setView(view);
+
+        // Frames sample the simulation at exact intervals of simulated time, stepped at the world's own frequency
+        Scalar dt = 1.0f / world->calculationFrequency;
+        double frameInterval = 1.0 / settings.frameRate;
+        long steps = 0;
+        size_t count = frameCount;
+        for (size_t i = 0; i < count && !cancelled; i++)
+        {
+            target.clear(EXPORT_BACKGROUND_COLOR);
+            world->draw(&target);
+            target.display();
+
+            // Step towards the next frame before reading this one back, so the GPU draws while the CPU integrates
+            while (i + 1 < count && (steps + 0.5) * dt < (i + 1) * frameInterval && !cancelled)
+            {
+                world->update(dt);
+                steps++;
+            }
+
+            submit(i, target.getTexture().copyToImage());
+        }
+    }
+
+    // Let the encoders finish the queue, then close the output
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        rendering = false;
+    }
+    frameQueued.notify_all();
+    for (std::thread &encoder : encoders)
+    {
+        encoder.join();
+    }
+    encoders.clear();
+
+    if (pipe != nullptr)
+    {
+#ifdef _WIN32
+        _pclose(pipe);
+#else
+        pclose(pipe);
+#endif
+        pipe = nullptr;
+    }
+
+    delete world;
+    world = nullptr;
+    active = false;
+}
+
+void Exporter::submit(size_t index, sf::Image &&image)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    frameConsumed.wait(lock, [this]
+                       { return queue.size() < EXPORT_QUEUE_DEPTH || cancelled; });
+    if (cancelled)
+        return;
+    queue.push_back(ExportFrame{index, std::move(image)});
+    lock.unlock();
+    frameQueued.notify_one();
+}
+
+void Exporter::encode()
+{
+    while (true)
+    {
+        ExportFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameQueued.wait(lock, [this]
+                             { return !queue.empty() || !rendering || cancelled; });
+            if (cancelled || queue.empty())
+                return;
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        frameConsumed.notify_one();
+
+        if (pipe != nullptr)
+        {
+            size_t bytes = static_cast<size_t>(settings.width) * settings.height * 4;
+            if (std::fwrite(frame.image.getPixelsPtr(), 1, bytes, pipe) != bytes)
+            {
+                fail("the export command stopped reading frames");
+                return;
+            }
+        }
+        else
+        {
+            std::string path = fmt::format("{}/frame_{:06}.png", settings.output, frame.index);
+            if (!frame.image.saveToFile(path))
+            {
+                fail(fmt::format("cannot write '{}'", path));
+                return;
+            }
+        }
+        framesWritten++;
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Config.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "core/World.hpp"
+
+enum ExportFormat
+{
+    EXPORT_PNG,  // Numbered PNG files in a directory, encoded in parallel
+    EXPORT_PIPE, // Raw RGBA frames written in order to the stdin of a command
+};
+
+struct ExportSettings
+{
+    ExportFormat format = EXPORT_PNG;
+    // Directory for PNG frames, or a command such as
+    // "ffmpeg -y -f rawvideo -pix_fmt rgba -s {width}x{height} -r {fps} -i - out.mp4"
+    std::string output = "export";
+    unsigned int width = DEFAULT_EXPORT_WIDTH;
+    unsigned int height = DEFAULT_EXPORT_HEIGHT;
+    float frameRate = DEFAULT_EXPORT_FRAME_RATE;
+    float duration = DEFAULT_EXPORT_DURATION; // Simulated seconds
+    sf::View view;                            // Region to export, its height is fitted to the aspect ratio
+};
+
+// Frame read back from the GPU, waiting for an encoder
+struct ExportFrame
+{
+    size_t index = 0;
+    sf::Image image;
+};
+
+// Renders a copy of the world offscreen at a fixed frame rate, decoupled from wall-clock time.
+// The copy is stepped and drawn on a render thread while a pool of encoders writes the frames,
+// so an export runs as fast as the machine allows and never holds up the live simulation.
+class Exporter
+{
+private:
+    World *world = nullptr; // Private copy, owned by the render thread
+    ExportSettings settings;
+    std::thread renderer;
+    std::vector<std::thread> encoders;
+    std::FILE *pipe = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable frameQueued;   // Wakes the encoders
+    std::condition_variable frameConsumed; // Wakes the renderer when the queue has room
+    std::deque<ExportFrame> queue;         // Guarded by mutex
+    bool rendering = false;                // Guarded by mutex, false once the last frame is queued
+    std::string error;                     // Guarded by mutex, first failure of the export
+
+    std::atomic<bool> active{false};
+    std::atomic<bool> cancelled{false};
+    std::atomic<size_t> framesWritten{0};
+    std::atomic<size_t> frameCount{0};
+
+    void render();                                // Render thread
+    void encode();                                // Encoder loop
+    void submit(size_t index, sf::Image &&image); // Queue a frame, waiting while the encoders are behind
+    void fail(const std::string &message);        // Record the first error and stop the export
+    bool open();                                  // Prepare the output directory or start the command
+
+public:
+    // Constructors & Destructor
+    Exporter() = default;
+    Exporter(const Exporter &) = delete;
+    Exporter &operator=(const Exporter &) = delete;
+    ~Exporter();
+
+    // Methods
+    // Copy the world and start exporting. Called from the thread that owns the world, which is
+    // only held up for the copy; the output is opened by the render thread.
+    void start(const World &source, const ExportSettings &settings);
+    void cancel(); // Stop after the frame being rendered, frames already written are kept
+
+    bool isActive() const;     // Rendering or encoding
+    float getProgress() const; // Fraction of the frames written
+    std::string getError();    // Empty unless the last export failed
+};
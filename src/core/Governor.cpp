@@ -0,0 +1,121 @@
+#include "Governor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+#include <imgui.h>
+
+void QualityGovernor::clampLevels()
+{
+    minStepRate = std::clamp(minStepRate, static_cast<float>(MIN_CALC_FREQ), static_cast<float>(MAX_CALC_FREQ));
+    maxStepRate = std::clamp(maxStepRate, minStepRate, static_cast<float>(MAX_CALC_FREQ));
+    minContactIterations = std::clamp(minContactIterations, 1, MAX_CONTACT_ITERATIONS);
+    maxContactIterations = std::clamp(maxContactIterations, minContactIterations, MAX_CONTACT_ITERATIONS);
+    maxRenderLevel = std::clamp(maxRenderLevel, 0, MAX_RENDER_LEVEL);
+
+    levels.stepRate = std::clamp(levels.stepRate, minStepRate, maxStepRate);
+    levels.contactIterations = std::clamp(levels.contactIterations, minContactIterations, maxContactIterations);
+    levels.renderLevel = std::clamp(levels.renderLevel, 0, maxRenderLevel);
+}
+
+void QualityGovernor::update(float dt, float frame, float render, float step)
+{
+    // Measurements are smoothed even while disabled, so the panel shows them and enabling starts from real values
+    float weight = 1.0f - std::exp(-std::max(dt, 0.0f) / GOVERNOR_SMOOTHING);
+    frameCost += (frame - frameCost) * weight;
+    renderCost += (render - renderCost) * weight;
+    stepCost = step;
+    if (!enabled)
+    {
+        levels = QualityLevels();
+        decision.clear();
+        return;
+    }
+    clampLevels();
+
+    // Simulation thread: fraction of each step period spent stepping
+    simulationCooldown -= dt;
+    float load = stepCost * levels.stepRate;
+    if (simulationCooldown <= 0.0f)
+    {
+        if (load > GOVERNOR_HIGH_LOAD)
+        {
+            if (levels.contactIterations > minContactIterations)
+            {
+                levels.contactIterations--;
+                decision = fmt::format("Simulation at {:.0f}% load, fewer contact iterations", load * 100.0f);
+                simulationCooldown = GOVERNOR_COOLDOWN;
+            }
+            else if (levels.stepRate > minStepRate)
+            {
+                // Proportional cut, bounded so one bad measurement cannot collapse the rate
+                float factor = std::max(GOVERNOR_TARGET_LOAD / load, GOVERNOR_MAX_RATE_CUT);
+                levels.stepRate = std::max(levels.stepRate * factor, minStepRate);
+                decision = fmt::format("Simulation at {:.0f}% load, step rate lowered", load * 100.0f);
+                simulationCooldown = GOVERNOR_COOLDOWN;
+            }
+        }
+        else if (load < GOVERNOR_LOW_LOAD)
+        {
+            if (levels.stepRate < maxStepRate)
+            {
+                levels.stepRate = std::min(levels.stepRate * GOVERNOR_RATE_GROWTH, maxStepRate);
+                decision = fmt::format("Simulation at {:.0f}% load, step rate raised", load * 100.0f);
+                simulationCooldown = GOVERNOR_COOLDOWN;
+            }
+            else if (levels.contactIterations < maxContactIterations)
+            {
+                levels.contactIterations++;
+                decision = fmt::format("Simulation at {:.0f}% load, more contact iterations", load * 100.0f);
+                simulationCooldown = GOVERNOR_COOLDOWN;
+            }
+        }
+    }
+
+    // UI thread: frame cost against the target
+    renderCooldown -= dt;
+    float target = targetFrameTime * 1e-3f;
+    if (renderCooldown <= 0.0f)
+    {
+        if (frameCost > target && levels.renderLevel < maxRenderLevel)
+        {
+            levels.renderLevel++;
+            decision = fmt::format("Frame at {:.1f} ms, coarser rendering", frameCost * 1e3f);
+            renderCooldown = GOVERNOR_COOLDOWN;
+        }
+        else if (frameCost < target * GOVERNOR_RENDER_HEADROOM && levels.renderLevel > 0)
+        {
+            levels.renderLevel--;
+            decision = fmt::format("Frame at {:.1f} ms, finer rendering", frameCost * 1e3f);
+            renderCooldown = GOVERNOR_COOLDOWN;
+        }
+    }
+}
+
+const QualityLevels &QualityGovernor::getLevels() const
+{
+    return levels;
+}
+
+void QualityGovernor::draw()
+{
+    if (!isOpen)
+        return;
+
+    ImGui::Begin("Quality", &isOpen, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize);
+    ImGui::Checkbox("Adapt Quality", &enabled);
+    ImGui::DragFloat("Target Frame Time", &targetFrameTime, TARGET_FRAME_TIME_STEP, MIN_TARGET_FRAME_TIME, MAX_TARGET_FRAME_TIME, "%.1f ms");
+    ImGui::DragFloatRange2("Step Rate", &minStepRate, &maxStepRate, CALC_FREQ_STEP, MIN_CALC_FREQ, MAX_CALC_FREQ, "%.0f Hz");
+    ImGui::DragIntRange2("Contact Iterations", &minContactIterations, &maxContactIterations, 0.1f, 1, MAX_CONTACT_ITERATIONS);
+    ImGui::SliderInt("Coarsest Render Level", &maxRenderLevel, 0, MAX_RENDER_LEVEL);
+
+    ImGui::Separator();
+    ImGui::Text("Frame: %.2f ms (render %.2f ms)", frameCost * 1e3f, renderCost * 1e3f);
+    ImGui::Text("Step: %.2f ms, %.0f%% load", stepCost * 1e3f, stepCost * levels.stepRate * 100.0f);
+    ImGui::Text("Step Rate: %.0f Hz", levels.stepRate);
+    ImGui::Text("Contact Iterations: %d", levels.contactIterations);
+    ImGui::Text("Render Level: %d", levels.renderLevel);
+    if (!decision.empty())
+        ImGui::TextWrapped("%s", decision.c_str());
+    ImGui::End();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Config.h"
+
+#include <string>
+
+// What the governor currently asks for
+struct QualityLevels
+{
+    float stepRate = SIMULATION_STEP_RATE; // Hz
+    int contactIterations = 1;
+    int renderLevel = 0; // 0 draws every body as its own shape
+};
+
+// Holds a frame-time budget by trading quality for speed within user bounds. The simulation side watches the
+// load of the simulation thread (step cost × step rate): over budget it first drops contact iterations and
+// then cuts the step rate in proportion to the overload, with headroom it raises the rate before the iterations.
+// The render side moves the render level against the UI's frame cost. Costs are smoothed, every decision is
+// followed by a cooldown and the improve and degrade thresholds are apart, so the levels settle instead of
+// oscillating; the simulation never catches up on missed steps, so an overload slows it down rather than
+// feeding back into longer steps.
+class QualityGovernor
+{
+private:
+    QualityLevels levels;
+
+    // Smoothed measurements (seconds)
+    float frameCost = 0.0f;
+    float renderCost = 0.0f;
+    float stepCost = 0.0f;
+
+    float simulationCooldown = 0.0f; // seconds until the next decision
+    float renderCooldown = 0.0f;
+    std::string decision; // Last change and why
+
+    void clampLevels(); // Keep the levels inside the bounds
+
+public:
+    // Panel properties
+    bool isOpen = false;
+    bool enabled = false;
+    float targetFrameTime = DEFAULT_TARGET_FRAME_TIME; // ms
+    float minStepRate = DEFAULT_MIN_STEP_RATE;         // Hz
+    float maxStepRate = DEFAULT_MAX_STEP_RATE;         // Hz
+    int minContactIterations = 1;
+    int maxContactIterations = DEFAULT_MAX_CONTACT_ITERATIONS;
+    int maxRenderLevel = MAX_RENDER_LEVEL;
+
+    // Methods
+    // Feed one frame's measurements (seconds): the frame's UI and render work, the part of it spent drawing the
+    // world and the simulation's smoothed step cost. Resets the levels while disabled.
+    void update(float dt, float frame, float render, float step);
+
+    const QualityLevels &getLevels() const;
+    void draw(); // Bounds, measurements and the current decisions
+};
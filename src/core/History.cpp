@@ -0,0 +1,370 @@
+#include "History.hpp"
+
+#include <algorithm>
+
+// Spring lists with the same springs in the same order
+static bool sameSprings(const std::vector<Spring> &a, const std::vector<Spring> &b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Spring &x, const Spring &y)
+                      { return x.a == y.a && x.b == y.b && x.restLength == y.restLength && x.stiffness == y.stiffness &&
+                               x.damping == y.damping && x.breakStrain == y.breakStrain; });
+}
+
+ObjectRecord WorldHistory::capture(const Object *object, ObjectHandle handle, uint32_t stamp)
+{
+    ObjectRecord record;
+    record.handle = handle;
+    record.stamp = stamp;
+    if (object == nullptr)
+        return record;
+
+    record.alive = true;
+    record.id = object->getID();
+    record.shapeType = object->shapeType;
+    record.dimensions = object->dimensions;
+    record.body = *object->body;
+    record.color = object->shape->getFillColor();
+    record.isSelectable = object->isSelectable;
+    record.isStatic = object->isStatic;
+    record.doGravity = object->doGravity;
+    record.doDrag = object->doDrag;
+    record.doFriction = object->doFriction;
+    record.canApplyFriction = object->canApplyFriction;
+    return record;
+}
+
+void WorldHistory::captureSprings(const World &world, std::vector<SpringRecord> &records, uint32_t stamp)
+{
+    // One pass over the springs, each finds the record of its first body's slot
+    for (SpringRecord &record : records)
+    {
+        record.stamp = stamp;
+        record.springs.clear();
+    }
+    for (const Spring &spring : world.getSprings().getSprings())
+    {
+        auto record = std::lower_bound(records.begin(), records.end(), spring.a.index(), [](const SpringRecord &r, uint32_t index)
+                                       { return r.handle.index() < index; });
+        if (record != records.end() && record->handle == spring.a)
+            record->springs.push_back(spring);
+    }
+}
+
+template <typename Record>
+const Record &WorldHistory::recordAt(const RecordTree<Record> &tree, size_t group, size_t chunk, size_t index)
+{
+    static const Record empty;
+    if (group >= tree.size() || tree[group] == nullptr)
+        return empty;
+    const RecordChunk<Record> *records = tree[group]->chunks[chunk].get();
+    return records != nullptr ? records->records[index] : empty;
+}
+
+template <typename Record>
+RecordTree<Record> WorldHistory::withRecords(const RecordTree<Record> &base, const std::vector<Record> &records)
+{
+    RecordTree<Record> tree = base;
+
+    // Each touched group and chunk is copied once, the records come sorted so their slots are in runs
+    const size_t groupSlots = HISTORY_CHUNK_SIZE * HISTORY_GROUP_SIZE;
+    size_t k = 0;
+    while (k < records.size())
+    {
+        size_t group = records[k].handle.index() / groupSlots;
+        if (tree.size() <= group)
+            tree.resize(group + 1);
+        const ChunkGroup<Record> *oldGroup = tree[group].get();
+        std::shared_ptr<ChunkGroup<Record>> newGroup = oldGroup != nullptr ? std::make_shared<ChunkGroup<Record>>(*oldGroup) : std::make_shared<ChunkGroup<Record>>();
+
+        while (k < records.size() && records[k].handle.index() / groupSlots == group)
+        {
+            size_t chunk = records[k].handle.index() / HISTORY_CHUNK_SIZE;
+            std::shared_ptr<const RecordChunk<Record>> &slot = newGroup->chunks[chunk % HISTORY_GROUP_SIZE];
+            std::shared_ptr<RecordChunk<Record>> newChunk = slot != nullptr ? std::make_shared<RecordChunk<Record>>(*slot) : std::make_shared<RecordChunk<Record>>();
+            for (; k < records.size() && records[k].handle.index() / HISTORY_CHUNK_SIZE == chunk; k++)
+            {
+                newChunk->records[records[k].handle.index() % HISTORY_CHUNK_SIZE] = records[k];
+            }
+            slot = newChunk;
+        }
+        tree[group] = newGroup;
+    }
+    return tree;
+}
+
+template <typename Record, typename Visit>
+void WorldHistory::forChanged(const RecordTree<Record> &from, const RecordTree<Record> &to, Visit visit)
+{
+    // Shared groups and chunks are equal, only the copied ones are looked into
+    size_t groupCount = std::max(from.size(), to.size());
+    for (size_t group = 0; group < groupCount; group++)
+    {
+        const ChunkGroup<Record> *fromGroup = group < from.size() ? from[group].get() : nullptr;
+        const ChunkGroup<Record> *toGroup = group < to.size() ? to[group].get() : nullptr;
+        if (fromGroup == toGroup)
+            continue;
+
+        for (size_t chunk = 0; chunk < HISTORY_GROUP_SIZE; chunk++)
+        {
+            const RecordChunk<Record> *fromChunk = fromGroup != nullptr ? fromGroup->chunks[chunk].get() : nullptr;
+            const RecordChunk<Record> *toChunk = toGroup != nullptr ? toGroup->chunks[chunk].get() : nullptr;
+            if (fromChunk == toChunk)
+                continue;
+
+            for (size_t index = 0; index < HISTORY_CHUNK_SIZE; index++)
+            {
+                const Record &fromRecord = recordAt(from, group, chunk, index);
+                const Record &toRecord = recordAt(to, group, chunk, index);
+                if (fromRecord.stamp != toRecord.stamp)
+                    visit(fromRecord, toRecord);
+            }
+        }
+    }
+}
+
+void WorldHistory::restore(World &world, const ObjectRecord &from, const ObjectRecord &to)
+{
+    if (from.alive && (!to.alive || from.handle != to.handle))
+        world.removeObject(from.handle);
+    if (!to.alive)
+        return;
+
+    Object *object = world.getObject(to.handle);
+    if (object == nullptr)
+        object = world.restoreObject(to.handle, to.body.position, to.dimensions, to.shapeType);
+    if (object == nullptr)
+        return; // Slot taken by an object the history never saw
+
+    *object->body = to.body;
+    object->setID(to.id);
+    object->shape->setFillColor(to.color);
+    object->isSelectable = to.isSelectable;
+    object->isStatic = to.isStatic;
+    object->doGravity = to.doGravity;
+    object->doDrag = to.doDrag;
+    object->doFriction = to.doFriction;
+    object->canApplyFriction = to.canApplyFriction;
+    object->finishStep();
+}
+
+void WorldHistory::apply(World &world, const WorldRevision &from, const WorldRevision &to)
+{
+    forChanged(from.objects, to.objects, [&world](const ObjectRecord &fromRecord, const ObjectRecord &toRecord)
+               { restore(world, fromRecord, toRecord); });
+
+    // The touched slots' springs are swapped in one pass, springs whose bodies are gone are left out
+    std::vector<uint32_t> firstBodies;
+    std::vector<Spring> added;
+    forChanged(from.springs, to.springs, [&](const SpringRecord &fromRecord, const SpringRecord &toRecord)
+               {
+                   firstBodies.push_back(fromRecord.handle.value);
+                   firstBodies.push_back(toRecord.handle.value);
+                   for (const Spring &spring : toRecord.springs)
+                   {
+                       if (world.getObject(spring.a) != nullptr && world.getObject(spring.b) != nullptr)
+                           added.push_back(spring);
+                   } });
+    if (!firstBodies.empty())
+    {
+        std::sort(firstBodies.begin(), firstBodies.end());
+        world.getSprings().replace(firstBodies, added);
+    }
+}
+
+void WorldHistory::publish()
+{
+    undoSteps = cursor;
+    redoSteps = steps.size() - cursor;
+}
+
+void WorldHistory::reset(const World &world)
+{
+    steps.clear();
+    cursor = 0;
+    pending.clear();
+    pendingSprings.clear();
+
+    uint32_t stamp = nextStamp++;
+    std::vector<ObjectRecord> records;
+    records.reserve(world.getObjects().size());
+    for (const Object *object : world.getObjects())
+    {
+        records.push_back(capture(object, object->handle, stamp));
+    }
+    std::sort(records.begin(), records.end(), [](const ObjectRecord &a, const ObjectRecord &b)
+              { return a.handle.index() < b.handle.index(); });
+    head = WorldRevision();
+    head.objects = withRecords(head.objects, records);
+
+    std::vector<SpringRecord> springRecords;
+    for (const Spring &spring : world.getSprings().getSprings())
+    {
+        SpringRecord record;
+        record.handle = spring.a;
+        springRecords.push_back(record);
+    }
+    std::sort(springRecords.begin(), springRecords.end(), [](const SpringRecord &a, const SpringRecord &b)
+              { return a.handle.index() < b.handle.index(); });
+    springRecords.erase(std::unique(springRecords.begin(), springRecords.end(), [](const SpringRecord &a, const SpringRecord &b)
+                                    { return a.handle.index() == b.handle.index(); }),
+                        springRecords.end());
+    captureSprings(world, springRecords, stamp);
+    head.springs = withRecords(head.springs, springRecords);
+    publish();
+}
+
+void WorldHistory::change(const World &world, ObjectHandle handle)
+{
+    const Object *object = world.getObject(handle);
+    if (object != nullptr)
+        pending.push_back(capture(object, handle, 0));
+}
+
+void WorldHistory::add(ObjectHandle handle)
+{
+    if (handle.isNull())
+        return;
+    pending.push_back(capture(nullptr, handle, 0));
+
+    // A new object has no springs yet, the ones it gets in the edit are found at commit
+    SpringRecord record;
+    record.handle = handle;
+    pendingSprings.push_back(record);
+}
+
+void WorldHistory::changeSprings(const World &world, ObjectHandle handle)
+{
+    // The body's own slot, and the slots of the springs' first bodies where it is the second one
+    std::vector<SpringRecord> records(1);
+    records[0].handle = handle;
+    for (const Spring &spring : world.getSprings().getSprings())
+    {
+        if (spring.b == handle)
+        {
+            records.emplace_back();
+            records.back().handle = spring.a;
+        }
+    }
+    std::sort(records.begin(), records.end(), [](const SpringRecord &a, const SpringRecord &b)
+              { return a.handle.index() < b.handle.index(); });
+    records.erase(std::unique(records.begin(), records.end(), [](const SpringRecord &a, const SpringRecord &b)
+                              { return a.handle.index() == b.handle.index(); }),
+                  records.end());
+    captureSprings(world, records, 0);
+    pendingSprings.insert(pendingSprings.end(), records.begin(), records.end());
+}
+
+void WorldHistory::commit(const World &world, uint32_t mergeKey)
+{
+    if (pending.empty() && pendingSprings.empty())
+        return;
+
+    // One record per slot, the first touch holds the state before the edit
+    std::stable_sort(pending.begin(), pending.end(), [](const ObjectRecord &a, const ObjectRecord &b)
+                     { return a.handle.index() < b.handle.index(); });
+    pending.erase(std::unique(pending.begin(), pending.end(), [](const ObjectRecord &a, const ObjectRecord &b)
+                              { return a.handle.index() == b.handle.index(); }),
+                  pending.end());
+    std::stable_sort(pendingSprings.begin(), pendingSprings.end(), [](const SpringRecord &a, const SpringRecord &b)
+                     { return a.handle.index() < b.handle.index(); });
+    pendingSprings.erase(std::unique(pendingSprings.begin(), pendingSprings.end(), [](const SpringRecord &a, const SpringRecord &b)
+                                     { return a.handle.index() == b.handle.index(); }),
+                         pendingSprings.end());
+
+    uint32_t beforeStamp = nextStamp++;
+    uint32_t afterStamp = nextStamp++;
+    std::vector<ObjectRecord> after;
+    after.reserve(pending.size());
+    for (ObjectRecord &record : pending)
+    {
+        record.stamp = beforeStamp;
+        after.push_back(capture(world.getObject(record.handle), record.handle, afterStamp));
+    }
+
+    // Slots whose springs came out the same are dropped, an edit that changed no spring keeps the spring tree
+    std::vector<SpringRecord> springsAfter = pendingSprings;
+    captureSprings(world, springsAfter, afterStamp);
+    size_t kept = 0;
+    for (size_t k = 0; k < pendingSprings.size(); k++)
+    {
+        if (sameSprings(pendingSprings[k].springs, springsAfter[k].springs))
+            continue;
+        pendingSprings[k].stamp = beforeStamp;
+        if (kept != k)
+        {
+            pendingSprings[kept] = std::move(pendingSprings[k]);
+            springsAfter[kept] = std::move(springsAfter[k]);
+        }
+        kept++;
+    }
+    pendingSprings.resize(kept);
+    springsAfter.resize(kept);
+    if (pending.empty() && pendingSprings.empty())
+        return;
+
+    if (mergeKey != 0 && cursor > 0 && cursor == steps.size() && steps.back().mergeKey == mergeKey)
+    {
+        // Same object edited again, the step keeps its state from before the first edit
+        steps.back().after.objects = withRecords(head.objects, after);
+        steps.back().after.springs = withRecords(head.springs, springsAfter);
+        head = steps.back().after;
+    }
+    else
+    {
+        Step step;
+        step.before.objects = withRecords(head.objects, pending);
+        step.before.springs = withRecords(head.springs, pendingSprings);
+        step.after.objects = withRecords(step.before.objects, after);
+        step.after.springs = withRecords(step.before.springs, springsAfter);
+        step.mergeKey = mergeKey;
+        head = step.after;
+
+        // A new edit drops the undone steps, the oldest go when the history is full
+        steps.erase(steps.begin() + cursor, steps.end());
+        steps.push_back(step);
+        if (steps.size() > HISTORY_CAPACITY)
+            steps.pop_front();
+        cursor = steps.size();
+    }
+
+    pending.clear();
+    pendingSprings.clear();
+    publish();
+}
+
+bool WorldHistory::undo(World &world)
+{
+    commit(world);
+    if (cursor == 0)
+        return false;
+
+    const Step &step = steps[--cursor];
+    apply(world, step.after, step.before);
+    head = step.before;
+    steps[cursor].mergeKey = 0; // An undone step is never extended
+    publish();
+    return true;
+}
+
+bool WorldHistory::redo(World &world)
+{
+    commit(world);
+    if (cursor == steps.size())
+        return false;
+
+    const Step &step = steps[cursor++];
+    apply(world, step.before, step.after);
+    head = step.after;
+    publish();
+    return true;
+}
+
+size_t WorldHistory::getUndoSteps() const
+{
+    return undoSteps;
+}
+
+size_t WorldHistory::getRedoSteps() const
+{
+    return redoSteps;
+}
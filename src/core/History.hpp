@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Config.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "core/World.hpp"
+
+// One pool slot as the history recorded it, enough to rebuild its object
+struct ObjectRecord
+{
+    ObjectHandle handle; // Object the slot held or is about to hold
+    uint32_t stamp = 0;  // Commit that wrote the record, records with equal stamps are equal
+    bool alive = false;  // Empty slot when false, the fields below are unused
+
+    int id = 0;
+    ShapeType shapeType = CIRCLE;
+    Vec2 dimensions;
+    Body body{Vec2(), 0.0f};
+    sf::Color color = sf::Color::White;
+    bool isSelectable = true;
+    bool isStatic = false;
+    bool doGravity = true;
+    bool doDrag = true;
+    bool doFriction = true;
+    bool canApplyFriction = true;
+};
+
+// The springs whose first body is one pool slot's object, as the history recorded them
+struct SpringRecord
+{
+    ObjectHandle handle; // Object the slot held, the first body of every spring below
+    uint32_t stamp = 0;  // Commit that wrote the record, records with equal stamps are equal
+    std::vector<Spring> springs;
+};
+
+// Records of HISTORY_CHUNK_SIZE consecutive slots and pointers to HISTORY_GROUP_SIZE consecutive chunks.
+// Neither changes once a revision holds it, so revisions share them; a null pointer is all empty slots.
+template <typename Record>
+struct RecordChunk
+{
+    Record records[HISTORY_CHUNK_SIZE];
+};
+
+template <typename Record>
+struct ChunkGroup
+{
+    std::shared_ptr<const RecordChunk<Record>> chunks[HISTORY_GROUP_SIZE];
+};
+
+template <typename Record>
+using RecordTree = std::vector<std::shared_ptr<const ChunkGroup<Record>>>;
+
+// One version of the edited world: its objects and its springs, both by pool slot
+struct WorldRevision
+{
+    RecordTree<ObjectRecord> objects;
+    RecordTree<SpringRecord> springs; // Each spring under the slot of its first body
+};
+
+// Undo and redo for edits made with the tools. Revisions are persistent: a commit copies only the groups and
+// chunks holding the slots it touched and shares the rest with the revision before, so a step costs a few
+// chunks whatever the size of the world. Undo and redo find the touched slots by comparing pointers down the
+// two revisions and rebuild only those objects and springs, restored objects get their old handles back.
+// Records are taken when an edit touches a slot, the bodies in between keep moving without being recorded.
+// Used by the thread that owns the world, except the step counts.
+class WorldHistory
+{
+private:
+    struct Step
+    {
+        WorldRevision before;  // Touched slots as they were before the edit
+        WorldRevision after;   // And after it, everything else shared with before
+        uint32_t mergeKey = 0; // Later commits with the same key fold into this step
+    };
+
+    std::deque<Step> steps; // Oldest first
+    size_t cursor = 0;      // Steps before it are done, from it on undone
+    WorldRevision head;     // Base of the next commit
+    uint32_t nextStamp = 1;
+
+    // Edit in progress
+    std::vector<ObjectRecord> pending;        // Touched slots before the edit
+    std::vector<SpringRecord> pendingSprings; // Slots whose springs the edit may change, before it
+
+    std::atomic<size_t> undoSteps{0};
+    std::atomic<size_t> redoSteps{0};
+
+    static ObjectRecord capture(const Object *object, ObjectHandle handle, uint32_t stamp); // Empty record when object is nullptr
+    static void captureSprings(const World &world, std::vector<SpringRecord> &records, uint32_t stamp); // Fill in the springs, records sorted by slot
+    template <typename Record>
+    static const Record &recordAt(const RecordTree<Record> &tree, size_t group, size_t chunk, size_t index);
+    template <typename Record>
+    static RecordTree<Record> withRecords(const RecordTree<Record> &base, const std::vector<Record> &records); // Copy of base with the records replaced, records sorted by slot
+    template <typename Record, typename Visit>
+    static void forChanged(const RecordTree<Record> &from, const RecordTree<Record> &to, Visit visit); // visit(from, to) for every slot whose records differ
+    static void restore(World &world, const ObjectRecord &from, const ObjectRecord &to); // Turn one slot's object from one record into the other
+    static void apply(World &world, const WorldRevision &from, const WorldRevision &to); // Restore every slot that differs
+
+    void publish(); // Update the step counts
+
+public:
+    // Methods
+    void reset(const World &world); // Forget every step and take the world as it is as the base
+
+    // An edit: call change before changing or erasing an object, add after creating one, changeSprings before
+    // adding springs from a body or removing its springs, then commit. A created object's springs need no
+    // changeSprings. Commits with the same non-zero merge key in a row are one step.
+    void change(const World &world, ObjectHandle handle);
+    void add(ObjectHandle handle);
+    void changeSprings(const World &world, ObjectHandle handle);
+    void commit(const World &world, uint32_t mergeKey = 0);
+
+    bool undo(World &world); // false when there is nothing to undo, an edit in progress is committed first
+    bool redo(World &world);
+
+    // Any thread
+    size_t getUndoSteps() const;
+    size_t getRedoSteps() const;
+};
@@ -0,0 +1,97 @@
+#include "Inspector.hpp"
+
+#include <imgui.h>
+
+void ObjectInspector::setTarget(ObjectHandle handle)
+{
+    if (handle == target)
+        return;
+
+    target = handle;
+    title.clear();
+    title.append("Object Properties##{}", handle.value);
+    stale = true;
+    synced = false;
+}
+
+ObjectHandle ObjectInspector::getTarget() const
+{
+    return target;
+}
+
+const BodyProperties &ObjectInspector::getProperties() const
+{
+    return properties;
+}
+
+void ObjectInspector::refresh(const ObjectReadout &readout)
+{
+    identity.clear();
+    shape.clear();
+    if (readout.shape == CIRCLE)
+    {
+        identity.append("Circle [{}]", readout.id);
+        shape.append("Radius: {:.2f} m\n", readout.dimensions.x);
+    }
+    else
+    {
+        identity.append("Rectangle [{}]", readout.id);
+        shape.append("Width: {:.2f} m\nHeight: {:.2f} m\n", readout.dimensions.x, readout.dimensions.y);
+    }
+    shape.append("Mass: {:.2f} kg", readout.mass);
+
+    motion.clear();
+    motion.append("Net Force: {} N\n", readout.acceleration * readout.mass);
+    motion.append("Acceleration: {} m/s²\n", readout.acceleration);
+    motion.append("Velocity: {} m/s\n", readout.velocity);
+    motion.append("Position: {} m\n", readout.position);
+    motion.append("Angle: {:.2f} rad\n", readout.angle);
+    motion.append("Angular Velocity: {:.2f} rad/s", readout.angularVelocity);
+
+    energy.clear();
+    energy.append("Kinetic Energy: {:.2f} J\n", readout.kineticEnergy);
+    energy.append("Gravitational Potential: {:.2f} J\n", readout.gravitationalPotential);
+    energy.append("Total Mechanical Energy: {:.2f} J", readout.totalEnergy);
+}
+
+bool ObjectInspector::draw(const ObjectReadout &readout, float dt, float refreshRate)
+{
+    // The readout lags a step behind a new target, keep the window hidden until it catches up
+    if (target.isNull() || readout.handle != target)
+        return false;
+
+    if (!synced)
+    {
+        properties = readout.properties;
+        synced = true;
+    }
+
+    sinceRefresh += dt;
+    if (stale || sinceRefresh * refreshRate >= 1.0f)
+    {
+        refresh(readout);
+        sinceRefresh = 0.0f;
+        stale = false;
+    }
+
+    ImGui::Begin(title.c_str(), nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize);
+    ImGui::TextUnformatted(identity.begin(), identity.end());
+    ImGui::Separator();
+    ImGui::TextUnformatted(shape.begin(), shape.end());
+    ImGui::Separator();
+    ImGui::TextUnformatted(motion.begin(), motion.end());
+    ImGui::Separator();
+    ImGui::TextUnformatted(energy.begin(), energy.end());
+    ImGui::Separator();
+
+    // Editable properties stay live, the caller forwards them to the simulation
+    bool edited = false;
+    edited |= dragScalar("Charge", &properties.charge, CHARGE_STEP, MIN_CHARGE, MAX_CHARGE);
+    edited |= dragScalar("Drag Coefficient", &properties.dragCoefficient, DRAG_STEP, MIN_DRAG, MAX_DRAG);
+    edited |= dragScalar("Static Friction", &properties.staticFriction, FRICTION_STEP, MIN_FRICTION, MAX_FRICTION);
+    edited |= dragScalar("Kinetic Friction", &properties.kineticFriction, FRICTION_STEP, MIN_FRICTION, MAX_FRICTION);
+    edited |= dragScalar("Restitution", &properties.restitution, RESTITUTION_STEP, MIN_RESTITUTION, MAX_RESTITUTION);
+    ImGui::End();
+
+    return edited;
+}
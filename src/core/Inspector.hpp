@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Config.h"
+
+#include "core/Simulation.hpp"
+#include "core/UI.hpp"
+
+// Properties window for one object, fed by the readout in the simulation's snapshots. Readouts are formatted
+// into fixed buffers at a limited rate and redrawn from them in between, so an open inspector neither
+// allocates nor formats every frame.
+class ObjectInspector
+{
+private:
+    typedef TextBuffer<INSPECTOR_TEXT_CAPACITY> Text;
+
+    ObjectHandle target;
+    Text title;    // Window title, unique per target
+    Text identity; // Shape and ID
+    Text shape;    // Size and mass
+    Text motion;   // Forces and kinematics
+    Text energy;   // Energy terms
+    BodyProperties properties; // Editable values, taken from the first readout of a new target
+    float sinceRefresh = 0.0f;
+    bool stale = true;
+    bool synced = false;
+
+    void refresh(const ObjectReadout &readout); // Reformat every readout
+
+public:
+    // Methods
+    void setTarget(ObjectHandle handle); // Null handles hide the window
+    ObjectHandle getTarget() const;
+
+    // Draw the window from the simulation's readout, refreshing the text at most refreshRate times per second.
+    // Returns true when a property was edited.
+    bool draw(const ObjectReadout &readout, float dt, float refreshRate);
+    const BodyProperties &getProperties() const; // Edited values to apply to the target
+};
@@ -0,0 +1,44 @@
+#include "Notepad.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+Notepad::Notepad(const std::string &name, AssetCache &assets, const Notepad *source)
+    : name(name), telemetry(new TelemetryChannel()), tools(assets), simulation(world)
+{
+    if (source != nullptr)
+    {
+        world.copyContents(source->world);
+        settings = source->settings;
+        std::copy(std::begin(source->programSource), std::end(source->programSource), programSource);
+        view = source->view;
+        accumulatedZoom = source->accumulatedZoom;
+        predictor.enabled = source->predictor.enabled;
+        predictor.predictAll = source->predictor.predictAll;
+        predictor.horizon = source->predictor.horizon;
+    }
+    else
+    {
+        world.addBoundaries();
+        settings = world.getSettings();
+        view = sf::View(sf::FloatRect(sf::Vector2f(-DEF_HEIGHT / 2, -DEF_WIDTH / 2), sf::Vector2f(DEF_WIDTH, DEF_HEIGHT)));
+        view.setCenter(sf::Vector2f(0, DEF_HEIGHT / 2));
+    }
+    world.telemetry = telemetry;
+    history.reset(world);
+}
+
+Notepad::~Notepad()
+{
+    // Stop stepping before the world, predictor and telemetry channel go away
+    simulation.stop();
+    delete telemetry;
+}
+
+void Notepad::setRunning(bool run)
+{
+    if (run)
+        simulation.start();
+    else
+        simulation.stop();
+}
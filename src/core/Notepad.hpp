@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Config.h"
+
+#include <atomic>
+#include <string>
+#include <SFML/Graphics.hpp>
+#include "core/AssetCache.hpp"
+#include "core/History.hpp"
+#include "core/Inspector.hpp"
+#include "core/Predictor.hpp"
+#include "core/Simulation.hpp"
+#include "core/Telemetry.hpp"
+#include "core/Tools.hpp"
+#include "core/World.hpp"
+
+// One world and everything the UI keeps about it: its simulation thread, view, tools, selection and panels.
+// Notepads only share the window, the assets, the exporter and the engine's thread pool, so several of them
+// step side by side on their own threads. A notepad that is not running has no thread at all.
+class Notepad
+{
+public:
+    std::string name;
+    World world;
+    Predictor predictor;
+    WorldHistory history; // Edits made with the tools, used by the simulation thread like the world
+    TelemetryChannel *telemetry;
+    TelemetryPanel telemetryPanel;
+    ObjectInspector inspector;
+    Tools tools;
+
+    // Settings edited by the UI, sent to the simulation as a whole when they change
+    WorldSettings settings;
+
+    // Custom force program source, compiled on the UI thread so errors show immediately
+    char programSource[PROGRAM_SOURCE_CAPACITY] = "k = 5\nc = vec(0, 3)\nF = -k*(p - c) - 0.5*v";
+    std::string programError;
+
+    // View and interaction state
+    sf::View view;
+    float accumulatedZoom = 1.0f;
+    bool isPanning = false;
+    bool toolFieldActive = false;
+    bool fluidEmitterActive = false;
+    bool predictionDirty = false;
+    bool paused = false; // Chosen by the user, hidden notepads are suspended regardless
+
+    // Handles stop resolving once their object is erased, so they never dangle
+    ObjectHandle selectedHandle;
+    ObjectHandle grabbedHandle;
+    ObjectHandle springStart; // Body a spring is being dragged from
+
+    // Objects drawn by the UI are created on the simulation thread, which reports their handle here
+    std::atomic<uint32_t> createdHandle{0};
+
+    Simulation simulation; // Declared last so its thread is joined before the rest goes away
+
+    // Constructors & Destructor
+    // A new world inside the boundaries, or a copy of source, which must not be running
+    Notepad(const std::string &name, AssetCache &assets, const Notepad *source = nullptr);
+    Notepad(const Notepad &) = delete;
+    Notepad &operator=(const Notepad &) = delete;
+    ~Notepad();
+
+    // Methods
+    void setRunning(bool run); // Step in real time or suspend the thread, edits still apply while suspended
+};
@@ -0,0 +1,131 @@
+#include "ObjectPool.hpp"
+
+#include <new>
+
+ObjectPool::~ObjectPool()
+{
+    clear();
+    for (Slot *slab : slabs)
+    {
+        delete[] slab;
+    }
+}
+
+ObjectPool::Slot &ObjectPool::slot(uint32_t index) const
+{
+    return slabs[index / OBJECT_SLAB_SIZE][index % OBJECT_SLAB_SIZE];
+}
+
+Object *ObjectPool::create(const Vec2 &position, const Vec2 &dimensions, Scalar density, ShapeType type)
+{
+    uint32_t index;
+    if (freeHead >= 0)
+    {
+        index = static_cast<uint32_t>(freeHead);
+        freeHead = slot(index).nextFree;
+        if (freeHead >= 0)
+            slot(freeHead).prevFree = -1;
+    }
+    else
+    {
+        if (slotCount == slabs.size() * OBJECT_SLAB_SIZE)
+            slabs.push_back(new Slot[OBJECT_SLAB_SIZE]);
+        index = slotCount++;
+    }
+    slot(index).highWater = slot(index).generation; // One past the old high-water mark, or 1 for a new slot
+    return construct(index, position, dimensions, density, type);
+}
+
+Object *ObjectPool::restore(ObjectHandle handle, const Vec2 &position, const Vec2 &dimensions, Scalar density, ShapeType type)
+{
+    uint32_t index = handle.index();
+    if (handle.isNull() || index >= slotCount || slot(index).alive)
+        return nullptr;
+    Slot &entry = slot(index);
+    if (handle.generation() == entry.generation)
+        return nullptr; // Never handed out, restoring it would let the next create reissue it
+
+    // Unlink the slot from the free list. The restored object lives under its old generation, the high-water
+    // mark is left alone so the next destroy still bumps past every generation handed out.
+    if (entry.prevFree >= 0)
+        slot(entry.prevFree).nextFree = entry.nextFree;
+    else
+        freeHead = entry.nextFree;
+    if (entry.nextFree >= 0)
+        slot(entry.nextFree).prevFree = entry.prevFree;
+    entry.generation = handle.generation();
+    return construct(index, position, dimensions, density, type);
+}
+
+Object *ObjectPool::construct(uint32_t index, const Vec2 &position, const Vec2 &dimensions, Scalar density, ShapeType type)
+{
+    Slot &entry = slot(index);
+    Object *object = new (entry.storage) Object(position, dimensions, density, type);
+    object->handle = ObjectHandle(index, entry.generation);
+    entry.alive = true;
+    entry.denseIndex = static_cast<uint32_t>(objects.size());
+    objects.push_back(object);
+    denseSlots.push_back(index);
+    return object;
+}
+
+bool ObjectPool::destroy(ObjectHandle handle)
+{
+    if (get(handle) == nullptr)
+        return false;
+
+    uint32_t index = handle.index();
+    Slot &entry = slot(index);
+    uint32_t dense = entry.denseIndex;
+    Object *object = objects[dense];
+
+    // Swap the last live object into the gap
+    uint32_t lastSlot = denseSlots.back();
+    objects[dense] = objects.back();
+    denseSlots[dense] = lastSlot;
+    slot(lastSlot).denseIndex = dense;
+    objects.pop_back();
+    denseSlots.pop_back();
+
+    object->~Object();
+    entry.alive = false;
+    entry.generation = (entry.highWater + 1) & OBJECT_GENERATION_MASK;
+    if (entry.generation == 0)
+        entry.generation = 1; // Keep the null handle unreachable
+    entry.nextFree = freeHead;
+    entry.prevFree = -1;
+    if (freeHead >= 0)
+        slot(freeHead).prevFree = static_cast<int>(index);
+    freeHead = static_cast<int>(index);
+    return true;
+}
+
+void ObjectPool::clear()
+{
+    while (!objects.empty())
+    {
+        destroy(objects.back()->handle);
+    }
+}
+
+Object *ObjectPool::get(ObjectHandle handle) const
+{
+    uint32_t index = handle.index();
+    if (handle.isNull() || index >= slotCount)
+        return nullptr;
+
+    const Slot &entry = slot(index);
+    if (!entry.alive || entry.generation != handle.generation())
+        return nullptr;
+    return objects[entry.denseIndex];
+}
+
+const std::vector<Object *> &ObjectPool::getObjects() const
+{
+    return objects;
+}
+
+size_t ObjectPool::size() const
+{
+    return objects.size();
+}
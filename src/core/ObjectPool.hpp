@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Config.h"
+
+#include <vector>
+#include "objects/Object.hpp"
+#include "objects/ObjectHandle.hpp"
+
+#define OBJECT_SLAB_SIZE 256 // Objects per slab
+
+// Arena for objects. Objects are constructed in place in fixed-size slabs, so addresses stay stable.
+// The live objects are packed in a dense array for iteration; removal swaps the last one into the gap.
+// Freed slots are reused through a free list, and their generation is bumped so old handles stop resolving.
+// An undo can bring an object back into its freed slot under its old handle. The bump starts from the newest
+// generation the slot ever handed out, so a slot freed after a restore never hands out a generation twice.
+class ObjectPool
+{
+private:
+    struct Slot
+    {
+        alignas(Object) unsigned char storage[sizeof(Object)];
+        uint32_t generation = 1; // Of the live object, or the next one to hand out while dead
+        uint32_t highWater = 0;  // Newest generation ever handed out, never lowered by restores
+        uint32_t denseIndex = 0; // Position in objects while alive
+        int nextFree = -1;       // Next slot in the free list while dead
+        int prevFree = -1;       // Previous slot in the free list while dead, -1 at its head
+        bool alive = false;
+    };
+
+    std::vector<Slot *> slabs;         // Blocks of OBJECT_SLAB_SIZE slots
+    std::vector<Object *> objects;     // Live objects, packed
+    std::vector<uint32_t> denseSlots;  // Slot index of each entry in objects
+    uint32_t slotCount = 0;            // Slots handed out so far
+    int freeHead = -1;                 // First reusable slot
+
+    Slot &slot(uint32_t index) const;
+    Object *construct(uint32_t index, const Vec2 &position, const Vec2 &dimensions, Scalar density, ShapeType type); // Build the object of a slot
+
+public:
+    // Constructors & Destructor
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+    ~ObjectPool();
+
+    // Methods
+    Object *create(const Vec2 &position, const Vec2 &dimensions, Scalar density, ShapeType type); // Construct an object in a free slot
+    bool destroy(ObjectHandle handle); // Destroy the object and free its slot, false for stale handles
+    // Construct an object under a handle whose object was destroyed, nullptr if its slot is taken
+    Object *restore(ObjectHandle handle, const Vec2 &position, const Vec2 &dimensions, Scalar density, ShapeType type);
+    void clear();                      // Destroy every object, slabs are kept for reuse
+
+    Object *get(ObjectHandle handle) const; // nullptr once the object has been destroyed
+
+    const std::vector<Object *> &getObjects() const;
+    size_t size() const;
+};
@@ -0,0 +1,167 @@
+#include "Predictor.hpp"
+
+#include <unordered_map>
+
+Predictor::Predictor()
+{
+    worker = std::thread(&Predictor::run, this);
+}
+Predictor::~Predictor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        generation++;
+    }
+    condition.notify_one();
+    worker.join();
+
+    delete pendingSnapshot;
+}
+
+void Predictor::request(const World &world, const Object *selectedObject, bool all, float seconds)
+{
+    // Copy the objects to predict into a private world owned by the worker
+    World *snapshot = new World();
+    snapshot->gravity = world.gravity;
+    snapshot->airDensity = world.airDensity;
+    snapshot->calculationFrequency = world.calculationFrequency;
+    snapshot->nbody = world.nbody;
+    for (ForceField *field : world.getFields())
+    {
+        snapshot->addField(new ForceField(*field));
+    }
+    for (const ForceProgram &program : world.getPrograms())
+    {
+        snapshot->addProgram(program);
+    }
+    snapshot->setODESolver(world.getODESolver());
+
+    std::unordered_map<uint32_t, ObjectHandle> copies; // Handle in the world to handle in the snapshot
+    for (Object *object : world.getObjects())
+    {
+        if (object->isStatic || object->isGrabbed)
+            continue;
+        if (!all && object != selectedObject)
+            continue;
+
+        // cloneObject leaves the grab, which follows the live mouse, and the forces the snapshot rebuilds behind.
+        // The snapshot has no fluid, predictions ignore it.
+        Object *copy = snapshot->cloneObject(*object);
+        copies[object->handle.value] = copy->handle;
+    }
+
+    // Springs between copied bodies come along, springs to walls and other static anchors do not
+    for (const Spring &spring : world.getSprings().getSprings())
+    {
+        auto a = copies.find(spring.a.value);
+        auto b = copies.find(spring.b.value);
+        if (a == copies.end() || b == copies.end())
+            continue;
+        Spring copy = spring;
+        copy.a = a->second;
+        copy.b = b->second;
+        snapshot->getSprings().add(copy);
+    }
+
+    if (snapshot->getObjects().empty())
+    {
+        delete snapshot;
+        clear();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        delete pendingSnapshot;
+        pendingSnapshot = snapshot;
+        pendingHorizon = seconds;
+        generation++;
+    }
+    condition.notify_one();
+}
+
+void Predictor::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    delete pendingSnapshot;
+    pendingSnapshot = nullptr;
+    generation++;
+    paths.clear();
+}
+
+void Predictor::run()
+{
+    while (true)
+    {
+        World *snapshot = nullptr;
+        unsigned int snapshotGeneration = 0;
+        float seconds = 0.0f;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]
+                           { return pendingSnapshot != nullptr || !running; });
+            if (!running)
+                return;
+
+            snapshot = pendingSnapshot;
+            snapshotGeneration = generation;
+            seconds = pendingHorizon;
+            pendingSnapshot = nullptr;
+        }
+
+        predict(snapshot, snapshotGeneration, seconds);
+        delete snapshot;
+    }
+}
+
+void Predictor::predict(World *snapshot, unsigned int snapshotGeneration, float seconds)
+{
+    const std::vector<Object *> &objects = snapshot->getObjects();
+    Scalar dt = 1.0f / snapshot->calculationFrequency;
+    SolverType solver = snapshot->getODESolver();
+    int steps = static_cast<int>(seconds / dt);
+
+    Vec2 minMeters = Vec2(-WORLD_WIDTH / 2, DEF_HEIGHT - WORLD_HEIGHT + HALF_WALL_THICKNESS) / pixelsPerMeter;
+    Vec2 maxMeters = Vec2(WORLD_WIDTH / 2, DEF_HEIGHT - HALF_WALL_THICKNESS) / pixelsPerMeter;
+
+    std::vector<sf::VertexArray> result(objects.size(), sf::VertexArray(sf::PrimitiveType::LineStrip));
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        Vec2 pos = objects[i]->body->position * pixelsPerMeter;
+        result[i].append(sf::Vertex{sf::Vector2f(pos.x, pos.y), PREDICTION_COLOR});
+    }
+
+    // Contacts are ignored, the path follows the object's forces only
+    for (int step = 0; step < steps; step++)
+    {
+        if (generation != snapshotGeneration)
+            return;
+
+        snapshot->applyGlobalForces();
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            Body next = simulateObject(solver, *objects[i], dt);
+            next.position.constrain(minMeters, maxMeters);
+            *objects[i]->body = next;
+
+            Vec2 pos = next.position * pixelsPerMeter;
+            result[i].append(sf::Vertex{sf::Vector2f(pos.x, pos.y), PREDICTION_COLOR});
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (generation == snapshotGeneration)
+    {
+        paths = std::move(result);
+    }
+}
+
+void Predictor::draw(sf::RenderWindow *window)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const sf::VertexArray &path : paths)
+    {
+        window->draw(path);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Config.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "core/World.hpp"
+
+// Computes predicted paths on a worker thread from a snapshot of the world.
+// A new prediction is only requested when inputs change, the UI thread draws the cached polylines.
+class Predictor
+{
+private:
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    World *pendingSnapshot = nullptr;       // Latest snapshot waiting for the worker
+    float pendingHorizon = 0.0f;            // Horizon captured with the pending snapshot
+    std::vector<sf::VertexArray> paths;     // Cached polylines, guarded by mutex
+    std::atomic<unsigned int> generation{0}; // Bumped on every request so stale work can be abandoned
+    bool running = true;
+
+    void run();                                                                    // Worker loop
+    void predict(World *snapshot, unsigned int snapshotGeneration, float seconds); // Integrate a snapshot forward
+
+public:
+    // Prediction properties
+    bool enabled = true;                        // Show the predicted path overlay
+    bool predictAll = false;                    // Predict every object instead of only the selected one
+    float horizon = DEFAULT_PREDICTION_HORIZON; // Seconds to look ahead
+
+    // Constructors & Destructor
+    Predictor();
+    ~Predictor();
+
+    // Methods
+    // Snapshot the world and schedule a new prediction. Called from the thread that owns the world,
+    // so the settings above are passed in rather than read.
+    void request(const World &world, const Object *selectedObject, bool all, float seconds);
+    void clear(); // Drop the cached paths
+
+    void draw(sf::RenderWindow *window); // Draw the cached paths
+};
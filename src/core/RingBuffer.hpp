@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Fixed-capacity single-producer/single-consumer queue without locks.
+// Exactly one thread may push and exactly one thread may pop at a time.
+template <typename T, size_t Capacity>
+class RingBuffer
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "RingBuffer capacity must be a power of two");
+
+private:
+    T buffer[Capacity];
+    alignas(64) std::atomic<size_t> head{0}; // Next slot to write, owned by the producer
+    alignas(64) std::atomic<size_t> tail{0}; // Next slot to read, owned by the consumer
+
+public:
+    // Methods
+    bool push(const T &item) // Returns false when full
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        buffer[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool push(T &&item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        buffer[h & (Capacity - 1)] = std::move(item);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item) // Returns false when empty
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+
+        item = std::move(buffer[t & (Capacity - 1)]);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+};
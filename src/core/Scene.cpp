@@ -0,0 +1,305 @@
+#include "Scene.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <fmt/format.h>
+
+static std::string lowercase(std::string text)
+{
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c)
+                   { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+template <typename T>
+static bool parseNumber(const std::string &text, T &value)
+{
+    char *end = nullptr;
+    double parsed = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0')
+        return false;
+    value = static_cast<T>(parsed);
+    return true;
+}
+
+static bool parseSwitch(const std::string &text, bool &value)
+{
+    std::string word = lowercase(text);
+    if (word == "on" || word == "true" || word == "1")
+        value = true;
+    else if (word == "off" || word == "false" || word == "0")
+        value = false;
+    else
+        return false;
+    return true;
+}
+
+static bool parseSolver(const std::string &text, SolverType &value)
+{
+    for (int i = EULER; i <= AM; i++)
+    {
+        SolverType type = static_cast<SolverType>(i);
+        if (lowercase(solverTypeToString(type)) == lowercase(text) && isSolverImplemented(type))
+        {
+            value = type;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Scene::set(const std::string &name, const std::string &value)
+{
+    if (name == "gravity")
+        return parseNumber(value, gravity);
+    if (name == "air_density")
+        return parseNumber(value, airDensity);
+    if (name == "restitution")
+        return parseNumber(value, restitution);
+    if (name == "solver")
+        return parseSolver(value, solver);
+    if (name == "frequency")
+        return parseNumber(value, frequency) && frequency > 0.0f;
+    if (name == "walls")
+        return parseSwitch(value, walls);
+    if (name == "mutual_gravity")
+        return parseSwitch(value, nbody.doGravity);
+    if (name == "gravitational_constant")
+        return parseNumber(value, nbody.gravitationalConstant);
+    if (name == "electrostatics")
+        return parseSwitch(value, nbody.doElectrostatics);
+    if (name == "coulomb_constant")
+        return parseNumber(value, nbody.coulombConstant);
+    if (name == "opening_angle")
+        return parseNumber(value, nbody.openingAngle);
+    if (name == "softening")
+        return parseNumber(value, nbody.softening);
+    return false;
+}
+
+// Per-object options after the shape's position and size
+static bool parseObjectOption(const std::string &option, SceneObject &object)
+{
+    if (option == "static")
+    {
+        object.isStatic = true;
+        return true;
+    }
+
+    size_t equals = option.find('=');
+    if (equals == std::string::npos)
+        return false;
+    std::string key = option.substr(0, equals);
+    std::string value = option.substr(equals + 1);
+
+    if (key == "density")
+        return parseNumber(value, object.density) && object.density > 0.0f;
+    if (key == "vx")
+        return parseNumber(value, object.velocity.x);
+    if (key == "vy")
+        return parseNumber(value, object.velocity.y);
+    if (key == "angle")
+        return parseNumber(value, object.angle);
+    if (key == "spin")
+        return parseNumber(value, object.angularVelocity);
+    if (key == "charge")
+        return parseNumber(value, object.charge);
+    if (key == "restitution")
+        return parseNumber(value, object.restitution);
+    if (key == "drag")
+        return parseNumber(value, object.dragCoefficient);
+    return false;
+}
+
+// Soft-body options after the lattice's position and size
+static bool parseSoftBodyOption(const std::string &option, SceneSoftBody &body)
+{
+    if (option == "round")
+    {
+        body.round = true;
+        return true;
+    }
+
+    size_t equals = option.find('=');
+    if (equals == std::string::npos)
+        return false;
+    std::string key = option.substr(0, equals);
+    std::string value = option.substr(equals + 1);
+
+    if (key == "spacing")
+        return parseNumber(value, body.prototype.restLength) && body.prototype.restLength > 0.0f;
+    if (key == "stiffness")
+        return parseNumber(value, body.prototype.stiffness) && body.prototype.stiffness >= 0.0f;
+    if (key == "damping")
+        return parseNumber(value, body.prototype.damping) && body.prototype.damping >= 0.0f;
+    if (key == "break")
+        return parseNumber(value, body.prototype.breakStrain) && body.prototype.breakStrain >= 0.0f;
+    if (key == "density")
+        return parseNumber(value, body.density) && body.density > 0.0f;
+    return false;
+}
+
+bool Scene::parse(std::istream &input, std::string &error)
+{
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(input, line))
+    {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream words(line);
+        std::vector<std::string> tokens;
+        std::string token;
+        while (words >> token)
+        {
+            tokens.push_back(token);
+        }
+        if (tokens.empty())
+            continue;
+
+        const std::string &keyword = tokens[0];
+        if (keyword == "force")
+        {
+            // The program is the rest of the line, ';' separates its statements
+            ForceProgram program;
+            program.name = fmt::format("scene{}", programs.size());
+            std::string programError;
+            if (!ForceProgram::compile(line.substr(line.find(keyword) + keyword.size()), program, programError))
+            {
+                error = fmt::format("line {}: force program {}", lineNumber, programError);
+                return false;
+            }
+            programs.push_back(program);
+        }
+        else if (keyword == "circle" || keyword == "rect")
+        {
+            SceneObject object;
+            object.shape = keyword == "circle" ? CIRCLE : RECTANGLE;
+            size_t sizeCount = object.shape == CIRCLE ? 1 : 2;
+            if (tokens.size() < 3 + sizeCount)
+            {
+                error = fmt::format("line {}: {} needs a position and {}", lineNumber, keyword, object.shape == CIRCLE ? "a radius" : "a width and height");
+                return false;
+            }
+
+            bool valid = parseNumber(tokens[1], object.position.x) && parseNumber(tokens[2], object.position.y) && parseNumber(tokens[3], object.dimensions.x);
+            if (object.shape == CIRCLE)
+                object.dimensions.y = object.dimensions.x;
+            else
+                valid = valid && parseNumber(tokens[4], object.dimensions.y);
+            if (!valid || object.dimensions.x <= 0.0f || object.dimensions.y <= 0.0f)
+            {
+                error = fmt::format("line {}: invalid {} position or size", lineNumber, keyword);
+                return false;
+            }
+
+            for (size_t i = 3 + sizeCount; i < tokens.size(); i++)
+            {
+                if (!parseObjectOption(tokens[i], object))
+                {
+                    error = fmt::format("line {}: unknown or invalid option '{}'", lineNumber, tokens[i]);
+                    return false;
+                }
+            }
+            objects.push_back(object);
+        }
+        else if (keyword == "fluid")
+        {
+            SceneFluid fluid;
+            bool valid = tokens.size() == 5 && parseNumber(tokens[1], fluid.position.x) && parseNumber(tokens[2], fluid.position.y) &&
+                         parseNumber(tokens[3], fluid.dimensions.x) && parseNumber(tokens[4], fluid.dimensions.y);
+            if (!valid || fluid.dimensions.x <= 0.0f || fluid.dimensions.y <= 0.0f)
+            {
+                error = fmt::format("line {}: fluid needs a position, a width and a height", lineNumber);
+                return false;
+            }
+            fluids.push_back(fluid);
+        }
+        else if (keyword == "softbody")
+        {
+            SceneSoftBody body;
+            bool valid = tokens.size() >= 5 && parseNumber(tokens[1], body.position.x) && parseNumber(tokens[2], body.position.y) &&
+                         parseNumber(tokens[3], body.columns) && parseNumber(tokens[4], body.rows);
+            if (!valid || body.columns < 1 || body.rows < 1)
+            {
+                error = fmt::format("line {}: softbody needs a position, columns and rows", lineNumber);
+                return false;
+            }
+
+            for (size_t i = 5; i < tokens.size(); i++)
+            {
+                if (!parseSoftBodyOption(tokens[i], body))
+                {
+                    error = fmt::format("line {}: unknown or invalid option '{}'", lineNumber, tokens[i]);
+                    return false;
+                }
+            }
+            softBodies.push_back(body);
+        }
+        else if (tokens.size() != 2 || !set(keyword, tokens[1]))
+        {
+            error = fmt::format("line {}: unknown or invalid setting '{}'", lineNumber, line);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Scene::load(const std::string &path, std::string &error)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = fmt::format("cannot open '{}'", path);
+        return false;
+    }
+    return parse(file, error);
+}
+
+void Scene::instantiate(World &world) const
+{
+    world.gravity = Vec2(0.0f, gravity);
+    world.airDensity = airDensity;
+    world.setODESolver(solver);
+    world.calculationFrequency = frequency;
+    world.nbody = nbody;
+
+    if (walls)
+        world.addBoundaries();
+
+    for (const ForceProgram &program : programs)
+    {
+        world.addProgram(program);
+    }
+
+    for (const SceneObject &description : objects)
+    {
+        // The world's frame has y pointing down
+        Object *object = world.createObject(standardizePosition(description.position), description.dimensions, description.density, description.shape);
+        object->body->velocity = Vec2(description.velocity.x, -description.velocity.y);
+        object->body->angle = -description.angle;
+        object->body->angularVelocity = -description.angularVelocity;
+        object->body->charge = description.charge;
+        object->body->restitution = description.restitution >= 0.0f ? description.restitution : restitution;
+        if (description.dragCoefficient >= 0.0f)
+            object->body->dragCoefficient = description.dragCoefficient;
+        if (description.isStatic)
+            object->setStatic(true);
+        object->finishStep();
+    }
+
+    for (const SceneSoftBody &body : softBodies)
+    {
+        world.addSoftBody(standardizePosition(body.position), body.columns, body.rows, body.density, body.prototype, body.round);
+    }
+
+    for (const SceneFluid &fluid : fluids)
+    {
+        Vec2 center = standardizePosition(fluid.position);
+        world.getFluid().addBlock(center - fluid.dimensions * 0.5f, center + fluid.dimensions * 0.5f);
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Config.h"
+
+#include <istream>
+#include <string>
+#include <vector>
+#include "core/World.hpp"
+
+// Object description, in the user-facing frame: x from the center, y up from the ground
+struct SceneObject
+{
+    ShapeType shape = CIRCLE;
+    Vec2 position;                     // m
+    Vec2 dimensions;                   // Radius, or width and height (m)
+    Scalar density = DEFAULT_DENSITY;  // kg/m²
+    Vec2 velocity;                     // m/s
+    Scalar angle = 0.0f;               // rad, counter-clockwise
+    Scalar angularVelocity = 0.0f;     // rad/s, counter-clockwise
+    Scalar charge = DEFAULT_CHARGE;    // C
+    Scalar restitution = -1.0f;        // Negative uses the scene's restitution
+    Scalar dragCoefficient = -1.0f;    // Negative keeps the body's default
+    bool isStatic = false;
+};
+
+// Block of fluid at rest, in the same frame as the objects
+struct SceneFluid
+{
+    Vec2 position;   // Center (m)
+    Vec2 dimensions; // Width and height (m)
+};
+
+// Lattice of nodes joined by springs, see World::addSoftBody
+struct SceneSoftBody
+{
+    Vec2 position; // Center (m)
+    int columns = DEFAULT_LATTICE_SIZE;
+    int rows = DEFAULT_LATTICE_SIZE;
+    Scalar density = DEFAULT_DENSITY;
+    Spring prototype; // Spacing and spring properties
+    bool round = false;
+};
+
+// World settings and objects read from a text file, instantiated into as many worlds as needed
+//
+//   # comment
+//   gravity 10              (m/s², positive is down, like the settings panel)
+//   air_density 1.225
+//   restitution 0.7         (for objects without their own)
+//   solver RK4
+//   frequency 120           (Hz, the fixed step is 1 / frequency)
+//   walls on
+//   mutual_gravity off      (also gravitational_constant, electrostatics, coulomb_constant,
+//                            opening_angle, softening)
+//   circle x y radius [density=1 vx=0 vy=0 angle=0 spin=0 charge=0 restitution=0.7 drag=0.47 static]
+//   rect x y width height [same options]
+//   fluid x y width height  (a block of fluid particles centered at x, y)
+//   softbody x y columns rows [spacing=0.25 stiffness=50 damping=0.2 break=0 density=1 round]
+//   force F = -5*(p - vec(0, 3))   (a force program for the rest of the line, see ForceProgram)
+class Scene
+{
+public:
+    Scalar gravity = DEFAULT_GRAVITY.y;
+    Scalar airDensity = DEFAULT_AIR_DENSITY;
+    Scalar restitution = DEFAULT_RESTITUTION;
+    SolverType solver = DEFAULT_SOLVER;
+    float frequency = DEFAULT_CALC_FREQ;
+    bool walls = true;
+    NBodyParameters nbody;
+
+    std::vector<SceneObject> objects;
+    std::vector<SceneFluid> fluids;
+    std::vector<SceneSoftBody> softBodies;
+    std::vector<ForceProgram> programs;
+
+    // Methods
+    bool load(const std::string &path, std::string &error); // Read a scene file, error names the offending line
+    bool parse(std::istream &input, std::string &error);
+
+    // Change one scene-wide setting by its file keyword, used by the loader and by parameter sweeps
+    bool set(const std::string &name, const std::string &value);
+
+    void instantiate(World &world) const; // Add the scene's settings and objects to an empty world
+};
@@ -0,0 +1,360 @@
+#include "Simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "math/Util.hpp"
+
+Simulation::Simulation(World &world) : world(world)
+{
+}
+Simulation::~Simulation()
+{
+    stop();
+}
+
+void Simulation::start()
+{
+    if (running)
+        return;
+
+    // Seed the snapshots so the first frame has something to draw
+    publish();
+    running = true;
+    worker = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop()
+{
+    if (!running)
+        return;
+
+    running = false;
+    worker.join();
+    drain();
+}
+
+bool Simulation::isRunning() const
+{
+    return running;
+}
+
+void Simulation::drain()
+{
+    SimulationCommand command;
+    while (commands.pop(command))
+    {
+        command(world);
+    }
+}
+
+void Simulation::run()
+{
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point last = Clock::now();
+    Clock::time_point next = last;
+    float cost = 0.0f;
+    while (running)
+    {
+        drain();
+
+        // Step by the real time elapsed, clamped like a slow frame used to be
+        Clock::time_point now = Clock::now();
+        float dt = std::min(std::chrono::duration<float>(now - last).count(), MAX_DT);
+        last = now;
+        if (dt > 0.0f)
+            world.update(dt);
+
+        publish();
+        float elapsed = std::chrono::duration<float>(Clock::now() - now).count();
+        cost += (elapsed - cost) * SIMULATION_COST_SMOOTHING;
+        stepCost.store(cost, std::memory_order_relaxed);
+
+        // Keep a steady rate, but never try to catch up after falling behind
+        const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / stepRate.load(std::memory_order_relaxed)));
+        next = std::max(next + period, now);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void Simulation::publish()
+{
+    RenderSnapshot &snapshot = snapshots.writeBuffer();
+
+    snapshot.bodies.clear();
+    for (Object *object : world.getObjects())
+    {
+        RenderBody body;
+        body.handle = object->handle;
+        body.shape = object->shapeType;
+        Vec2 position = object->body->position * pixelsPerMeter;
+        Vec2 size = object->dimensions * pixelsPerMeter;
+        body.position = sf::Vector2f(static_cast<float>(position.x), static_cast<float>(position.y));
+        body.size = sf::Vector2f(static_cast<float>(size.x), static_cast<float>(size.y));
+        body.angle = static_cast<float>(object->body->angle);
+        body.color = object->shape->getFillColor();
+        body.isSelectable = object->isSelectable;
+        snapshot.bodies.push_back(body);
+
+        uint32_t slot = object->handle.index();
+        if (slot >= bodyBySlot.size())
+            bodyBySlot.resize(slot + 1);
+        bodyBySlot[slot] = static_cast<uint32_t>(snapshot.bodies.size() - 1);
+    }
+
+    // Every spring's bodies are alive, so their slots were just filled
+    snapshot.springs.clear();
+    for (const Spring &spring : world.getSprings().getSprings())
+    {
+        snapshot.springs.push_back(bodyBySlot[spring.a.index()]);
+        snapshot.springs.push_back(bodyBySlot[spring.b.index()]);
+    }
+    world.getFluid().getPixelPositions(snapshot.particles);
+
+    ObjectReadout &readout = snapshot.inspected;
+    ObjectHandle handle = ObjectHandle::fromValue(inspectedHandle.load(std::memory_order_relaxed));
+    Object *object = world.getObject(handle);
+    readout.handle = object != nullptr ? handle : ObjectHandle();
+    if (object != nullptr)
+    {
+        const Body *body = object->body;
+        readout.id = object->getID();
+        readout.shape = object->shapeType;
+        readout.dimensions = object->dimensions;
+        readout.mass = body->mass;
+        readout.acceleration = body->acceleration;
+        readout.velocity = body->velocity;
+        readout.position = standardizePosition(body->position);
+        readout.angle = body->angle;
+        readout.angularVelocity = body->angularVelocity;
+        readout.kineticEnergy = body->kineticEnergy;
+        readout.gravitationalPotential = body->gravitationalPotential;
+        readout.totalEnergy = body->totalEnergy;
+        readout.properties.charge = body->charge;
+        readout.properties.dragCoefficient = body->dragCoefficient;
+        readout.properties.staticFriction = body->staticFriction;
+        readout.properties.kineticFriction = body->kineticFriction;
+        readout.properties.restitution = body->restitution;
+    }
+
+    snapshot.simulationTime = world.simulationTime;
+    snapshot.publishedAt = std::chrono::steady_clock::now();
+    snapshots.publish();
+}
+
+void Simulation::setStepRate(float rate)
+{
+    stepRate.store(std::max(rate, 1.0f), std::memory_order_relaxed);
+}
+
+float Simulation::getStepRate() const
+{
+    return stepRate.load(std::memory_order_relaxed);
+}
+
+float Simulation::getStepCost() const
+{
+    return stepCost.load(std::memory_order_relaxed);
+}
+
+void Simulation::post(SimulationCommand command)
+{
+    // Stopped worlds are the caller's, the edit shows in a fresh snapshot right away
+    if (!running)
+    {
+        command(world);
+        publish();
+        return;
+    }
+
+    // The queue only fills if the simulation stalls, wait for it rather than lose user input
+    while (!commands.push(std::move(command)))
+    {
+        std::this_thread::yield();
+    }
+}
+
+void Simulation::inspect(ObjectHandle handle)
+{
+    inspectedHandle.store(handle.value, std::memory_order_relaxed);
+}
+
+bool Simulation::poll()
+{
+    if (!snapshots.acquire())
+        return false;
+
+    // Copies reuse the capacity of the older snapshot
+    std::swap(previous, current);
+    current = snapshots.readBuffer();
+
+    previousBySlot.assign(previousBySlot.size(), NO_BODY);
+    for (size_t i = 0; i < previous.bodies.size(); i++)
+    {
+        uint32_t slot = previous.bodies[i].handle.index();
+        if (slot >= previousBySlot.size())
+            previousBySlot.resize(slot + 1, NO_BODY);
+        previousBySlot[slot] = static_cast<uint32_t>(i);
+    }
+    return true;
+}
+
+const RenderSnapshot &Simulation::latest() const
+{
+    return current;
+}
+
+ObjectHandle Simulation::pick(const sf::Vector2f &pixels) const
+{
+    for (const RenderBody &body : current.bodies)
+    {
+        if (!body.isSelectable)
+            continue;
+
+        sf::Vector2f offset = pixels - body.position;
+        if (body.shape == CIRCLE)
+        {
+            if (offset.x * offset.x + offset.y * offset.y <= body.size.x * body.size.x)
+                return body.handle;
+            continue;
+        }
+
+        // Point in the rectangle's local frame
+        float cos = std::cos(body.angle);
+        float sin = std::sin(body.angle);
+        float localX = offset.x * cos + offset.y * sin;
+        float localY = -offset.x * sin + offset.y * cos;
+        if (std::abs(localX) <= body.size.x / 2 && std::abs(localY) <= body.size.y / 2)
+            return body.handle;
+    }
+    return ObjectHandle();
+}
+
+void Simulation::draw(sf::RenderWindow *window, int level)
+{
+    // Render one step behind, blending from the previous snapshot to the current one over a step interval
+    float alpha = 1.0f;
+    float interval = std::chrono::duration<float>(current.publishedAt - previous.publishedAt).count();
+    if (interval > 0.0f)
+    {
+        float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - current.publishedAt).count();
+        alpha = std::clamp(elapsed / interval, 0.0f, 1.0f);
+    }
+
+    size_t count = current.bodies.size();
+    drawnPositions.resize(count);
+    drawnAngles.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const RenderBody &body = current.bodies[i];
+        sf::Vector2f position = body.position;
+        float angle = body.angle;
+
+        uint32_t slot = body.handle.index();
+        if (slot < previousBySlot.size() && previousBySlot[slot] != NO_BODY)
+        {
+            const RenderBody &before = previous.bodies[previousBySlot[slot]];
+            if (before.handle == body.handle)
+            {
+                position = before.position + (body.position - before.position) * alpha;
+                angle = before.angle + (body.angle - before.angle) * alpha;
+            }
+        }
+        drawnPositions[i] = position;
+        drawnAngles[i] = angle;
+    }
+
+    // Springs go under the bodies they join
+    if (!current.springs.empty())
+    {
+        springVertices.setPrimitiveType(sf::PrimitiveType::Lines);
+        springVertices.resize(current.springs.size());
+        for (size_t k = 0; k < current.springs.size(); k++)
+        {
+            springVertices[k] = sf::Vertex{drawnPositions[current.springs[k]], SPRING_COLOR};
+        }
+        window->draw(springVertices);
+    }
+
+    if (level > 0)
+    {
+        drawBatched(window, level);
+        FluidSystem::drawParticles(window, current.particles, particleVertices);
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const RenderBody &body = current.bodies[i];
+        sf::Shape *shape;
+        if (body.shape == CIRCLE)
+        {
+            circle.setRadius(body.size.x);
+            circle.setOrigin(sf::Vector2f(body.size.x, body.size.x));
+            shape = &circle;
+        }
+        else
+        {
+            rectangle.setSize(body.size);
+            rectangle.setOrigin(body.size / 2.0f);
+            shape = &rectangle;
+        }
+        shape->setPosition(drawnPositions[i]);
+        shape->setRotation(sf::radians(drawnAngles[i]));
+        shape->setFillColor(body.color);
+        window->draw(*shape);
+    }
+
+    FluidSystem::drawParticles(window, current.particles, particleVertices);
+}
+
+void Simulation::drawBatched(sf::RenderWindow *window, int level)
+{
+    // Halve the circle segments each level
+    int segments = std::max(RENDER_CIRCLE_SEGMENTS >> (level - 1), RENDER_MIN_CIRCLE_SEGMENTS);
+    circleDirections.resize(segments + 1);
+    for (int s = 0; s <= segments; s++)
+    {
+        float theta = 2.0f * static_cast<float>(M_PI) * s / segments;
+        circleDirections[s] = sf::Vector2f(std::cos(theta), std::sin(theta));
+    }
+
+    const sf::View &view = window->getView();
+    sf::Vector2f low = view.getCenter() - view.getSize() / 2.0f;
+    sf::Vector2f high = view.getCenter() + view.getSize() / 2.0f;
+
+    bodyVertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+    bodyVertices.clear();
+    for (size_t i = 0; i < current.bodies.size(); i++)
+    {
+        const RenderBody &body = current.bodies[i];
+        sf::Vector2f position = drawnPositions[i];
+
+        // Bodies entirely outside the view are skipped
+        float reach = body.shape == CIRCLE ? body.size.x : 0.5f * std::hypot(body.size.x, body.size.y);
+        if (position.x + reach < low.x || position.x - reach > high.x || position.y + reach < low.y || position.y - reach > high.y)
+            continue;
+
+        if (body.shape == CIRCLE)
+        {
+            for (int s = 0; s < segments; s++)
+            {
+                bodyVertices.append(sf::Vertex{position, body.color});
+                bodyVertices.append(sf::Vertex{position + circleDirections[s] * body.size.x, body.color});
+                bodyVertices.append(sf::Vertex{position + circleDirections[s + 1] * body.size.x, body.color});
+            }
+            continue;
+        }
+
+        sf::Vector2f u(std::cos(drawnAngles[i]), std::sin(drawnAngles[i]));
+        sf::Vector2f v(-u.y, u.x);
+        u *= body.size.x / 2.0f;
+        v *= body.size.y / 2.0f;
+        sf::Vector2f corners[4] = {position - u - v, position + u - v, position + u + v, position - u + v};
+        for (int k : {0, 1, 2, 0, 2, 3})
+        {
+            bodyVertices.append(sf::Vertex{corners[k], body.color});
+        }
+    }
+    window->draw(bodyVertices);
+}
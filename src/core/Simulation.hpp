@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Config.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "core/RingBuffer.hpp"
+#include "core/TripleBuffer.hpp"
+#include "core/World.hpp"
+
+// Drawable state of one object
+struct RenderBody
+{
+    ObjectHandle handle;
+    ShapeType shape = CIRCLE;
+    sf::Vector2f position; // Center (px)
+    sf::Vector2f size;     // Radius twice for circles, width and height for rectangles (px)
+    float angle = 0.0f;    // radians
+    sf::Color color;
+    bool isSelectable = true;
+};
+
+// Properties the UI may edit on a body
+struct BodyProperties
+{
+    Scalar charge = 0.0f;
+    Scalar dragCoefficient = 0.0f;
+    Scalar staticFriction = 0.0f;
+    Scalar kineticFriction = 0.0f;
+    Scalar restitution = 0.0f;
+};
+
+// Everything the object inspector shows, captured for one object per snapshot
+struct ObjectReadout
+{
+    ObjectHandle handle; // Null when nothing is inspected or the object is gone
+    int id = 0;
+    ShapeType shape = CIRCLE;
+    Vec2 dimensions;
+    Scalar mass = 0.0f;
+    Vec2 acceleration;
+    Vec2 velocity;
+    Vec2 position; // User space, y up from the ground
+    Scalar angle = 0.0f;
+    Scalar angularVelocity = 0.0f;
+    Scalar kineticEnergy = 0.0f;
+    Scalar gravitationalPotential = 0.0f;
+    Scalar totalEnergy = 0.0f;
+    BodyProperties properties;
+};
+
+// State published by the simulation after each step
+struct RenderSnapshot
+{
+    std::vector<RenderBody> bodies;
+    std::vector<uint32_t> springs;       // Pairs of indices into bodies
+    std::vector<sf::Vector2f> particles; // Fluid particle centers (px), not interpolated since they are reordered every step
+    ObjectReadout inspected;
+    Scalar simulationTime = 0.0f;
+    std::chrono::steady_clock::time_point publishedAt;
+};
+
+// Change to the world, run by the simulation thread between steps
+typedef std::function<void(World &)> SimulationCommand;
+
+// Steps a world on its own thread. The UI never touches the world while it runs: it posts commands,
+// which are applied at step boundaries, and draws from the latest published snapshot,
+// interpolating between the last two so motion stays smooth at any frame rate.
+class Simulation
+{
+private:
+    World &world;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<float> stepRate{SIMULATION_STEP_RATE}; // Hz, steps attempted per second
+    std::atomic<float> stepCost{0.0f};                 // seconds, smoothed cost of a step and its snapshot
+
+    RingBuffer<SimulationCommand, SIMULATION_COMMAND_CAPACITY> commands; // UI to simulation
+    TripleBuffer<RenderSnapshot> snapshots;                              // Simulation to UI
+    std::atomic<uint32_t> inspectedHandle{0};                            // Object captured in each snapshot's readout
+
+    // Owned by the UI thread
+    RenderSnapshot previous;
+    RenderSnapshot current;
+    std::vector<uint32_t> previousBySlot; // Index into previous.bodies for each pool slot, NO_BODY if absent
+    sf::CircleShape circle;
+    sf::RectangleShape rectangle;
+    sf::VertexArray particleVertices;
+    sf::VertexArray springVertices;
+    sf::VertexArray bodyVertices;               // Batched body triangles for the coarser render levels
+    std::vector<sf::Vector2f> circleDirections; // Unit vectors around a batched circle
+    std::vector<sf::Vector2f> drawnPositions; // Interpolated pose of each body in current
+    std::vector<float> drawnAngles;
+
+    std::vector<uint32_t> bodyBySlot; // Owned by the simulation thread, index into the snapshot's bodies for each pool slot
+
+    static constexpr uint32_t NO_BODY = ~0u;
+
+    void run();      // Simulation loop
+    void drain();    // Apply every pending command
+    void publish();  // Capture the world into the back snapshot
+    void drawBatched(sf::RenderWindow *window, int level); // Draw the visible bodies of current as one triangle list
+
+public:
+    // Constructors & Destructor
+    Simulation(World &world);
+    Simulation(const Simulation &) = delete;
+    Simulation &operator=(const Simulation &) = delete;
+    ~Simulation();
+
+    // Methods
+    void start(); // Start stepping the world in real time
+    void stop();  // Join the thread and apply what is still queued, the world is the caller's again
+    bool isRunning() const;
+
+    // UI thread only
+    void setStepRate(float rate);         // Hz, taken from the next step on
+    float getStepRate() const;
+    float getStepCost() const;            // seconds
+    void post(SimulationCommand command); // Queue a change, applied and published immediately while stopped
+    void inspect(ObjectHandle handle);    // Choose the object captured in the readout
+    bool poll();                          // Take the newest snapshot, false if none was published since
+
+    const RenderSnapshot &latest() const;
+    ObjectHandle pick(const sf::Vector2f &pixels) const; // First selectable body under a point, null if none
+
+    // Draw the springs and bodies between the last two snapshots, then the fluid. Level 0 draws every body as its own shape,
+    // higher levels batch the visible bodies into one draw with coarser circles.
+    void draw(sf::RenderWindow *window, int level = 0);
+};
@@ -0,0 +1,99 @@
+#include "Telemetry.hpp"
+
+#include <algorithm>
+#include <imgui.h>
+
+void TelemetryPanel::consume(TelemetryChannel &channel)
+{
+    TelemetrySample sample;
+    while (channel.pop(sample))
+    {
+        // A time jump backwards means the world was reset
+        if (!history.empty() && sample.time < history.back().time)
+            history.clear();
+        history.push_back(sample);
+    }
+
+    while (!history.empty() && history.back().time - history.front().time > window)
+    {
+        history.pop_front();
+    }
+}
+
+void TelemetryPanel::clear()
+{
+    history.clear();
+}
+
+void TelemetryPanel::plot(const char *label, const char *unit, float (*metric)(const TelemetrySample &))
+{
+    ImGui::Text("%s: %.2f %s", label, history.empty() ? 0.0f : metric(history.back()), unit);
+
+    ImVec2 size(TELEMETRY_PLOT_WIDTH, TELEMETRY_PLOT_HEIGHT);
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::Dummy(size);
+
+    ImDrawList *drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), IM_COL32(20, 20, 20, 200));
+    if (history.size() < 2)
+        return;
+
+    float low = metric(history.front());
+    float high = low;
+    for (const TelemetrySample &sample : history)
+    {
+        float value = metric(sample);
+        low = std::min(low, value);
+        high = std::max(high, value);
+    }
+    float range = high - low > 1e-6f ? high - low : 1.0f;
+    auto toY = [&](float value)
+    { return origin.y + size.y - (value - low) / range * size.y; };
+
+    // Reduce the samples falling in each pixel column to their min and max
+    int columns = static_cast<int>(size.x);
+    size_t count = history.size();
+    float lastY = toY(metric(history.front()));
+    for (int column = 0; column < columns; column++)
+    {
+        size_t begin = count * column / columns;
+        size_t end = std::max(count * (column + 1) / columns, begin + 1);
+        if (begin >= count)
+            break;
+
+        float columnMin = metric(history[begin]);
+        float columnMax = columnMin;
+        for (size_t i = begin + 1; i < end && i < count; i++)
+        {
+            float value = metric(history[i]);
+            columnMin = std::min(columnMin, value);
+            columnMax = std::max(columnMax, value);
+        }
+
+        float x = origin.x + column + 0.5f;
+        float top = toY(columnMax);
+        float bottom = toY(columnMin);
+        drawList->AddLine(ImVec2(x - 1.0f, lastY), ImVec2(x, std::clamp(lastY, top, bottom)), TELEMETRY_PLOT_COLOR);
+        drawList->AddLine(ImVec2(x, top), ImVec2(x, bottom + 1.0f), TELEMETRY_PLOT_COLOR);
+        lastY = toY(metric(history[std::min(end, count) - 1]));
+    }
+}
+
+void TelemetryPanel::draw()
+{
+    if (!isOpen)
+        return;
+
+    ImGui::Begin("Telemetry", &isOpen, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize);
+    ImGui::DragFloat("Window", &window, TELEMETRY_WINDOW_STEP, MIN_TELEMETRY_WINDOW, MAX_TELEMETRY_WINDOW);
+    ImGui::Separator();
+    plot("Total Energy", "J", [](const TelemetrySample &s)
+         { return s.energy; });
+    plot("Momentum", "kg m/s", [](const TelemetrySample &s)
+         { return s.momentum; });
+    plot("Max Speed", "m/s", [](const TelemetrySample &s)
+         { return s.maxSpeed; });
+    plot("Contacts", "", [](const TelemetrySample &s)
+         { return static_cast<float>(s.contacts); });
+    ImGui::End();
+}
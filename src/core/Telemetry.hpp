@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Config.h"
+
+#include <deque>
+#include "core/RingBuffer.hpp"
+
+// Compact per-step summary of the world, pushed by the simulation
+struct TelemetrySample
+{
+    float time = 0.0f;     // Simulation time (s)
+    float energy = 0.0f;   // Total mechanical energy (J)
+    float momentum = 0.0f; // Magnitude of the total linear momentum (kg·m/s)
+    float maxSpeed = 0.0f; // Fastest dynamic body (m/s)
+    int contacts = 0;      // Colliding pairs this step
+};
+
+// Lock-free channel from the simulation to the plotting panels
+typedef RingBuffer<TelemetrySample, TELEMETRY_CAPACITY> TelemetryChannel;
+
+// Consumes telemetry samples and draws them as decimated plots
+class TelemetryPanel
+{
+private:
+    std::deque<TelemetrySample> history; // Samples inside the visible window
+
+    // Draw one metric with min/max per pixel column
+    void plot(const char *label, const char *unit, float (*metric)(const TelemetrySample &));
+
+public:
+    // Panel properties
+    bool isOpen = false;
+    float window = DEFAULT_TELEMETRY_WINDOW; // Seconds of history to show
+
+    // Methods
+    void consume(TelemetryChannel &channel); // Drain new samples, must be called even while hidden
+    void clear();
+    void draw();
+};
@@ -2,11 +2,12 @@
 #include "Tools.hpp"
 
 
-Tools::Tools() : currentTool(nullptr)
+Tools::Tools(AssetCache &assets) : currentTool(nullptr)
 {
+    const TextureAtlas &atlas = assets.getToolAtlas();
     for (int i = SELECT; i < TOOL_END; i++)
     {
-        tools.push_back(new Tool(static_cast<ToolType>(i), getToolTexture(static_cast<ToolType>(i))));
+        tools.push_back(new Tool(static_cast<ToolType>(i), &atlas.texture, atlas.regions[i]));
     }
 
     currentTool = tools[0];
@@ -57,6 +58,9 @@ void Tools::setCurrentTool(Tool *tool)
         case DRAW_SPRING:
             settings = new SpringSettings();
             break;
+        case POUR_FLUID:
+            settings = new FluidSettings();
+            break;
         default:
             settings = new ToolSettings();
             break;
@@ -72,7 +76,8 @@ void Tools::draw()
     for (Tool *tool : tools)
     {
         bool selected = (tool == currentTool);
-        bool pressed = ImGui::ImageButton(tool->getId(), *tool->texture, sf::Vector2f(TOOLS_ICON_SIZE, TOOLS_ICON_SIZE), selected ? TOOL_SELECT_COLOR : TOOL_BG_COLOR);
+        sf::Sprite icon(*tool->atlas, tool->icon);
+        bool pressed = ImGui::ImageButton(tool->getId(), icon, sf::Vector2f(TOOLS_ICON_SIZE, TOOLS_ICON_SIZE), selected ? TOOL_SELECT_COLOR : TOOL_BG_COLOR);
         if (pressed)
         {
             setCurrentTool(tool);
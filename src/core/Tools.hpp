@@ -2,22 +2,26 @@
 
 #include "Config.h"
 
+#include "core/AssetCache.hpp"
 #include "objects/Tool.hpp"
 
 struct ToolSettings {};
 
 struct PushSettings : ToolSettings {
     float forceMagnitude = DEFAULT_FORCE;
+    float radius = DEFAULT_FIELD_RADIUS;
 };
 
 struct PullSettings : ToolSettings {
     float forceMagnitude = DEFAULT_FORCE;
+    float radius = DEFAULT_FIELD_RADIUS;
 };
 
 struct CircleSettings : ToolSettings {
     bool isStatic = false;
     float radius = DEFAULT_LENGTH;
     float density = DEFAULT_DENSITY;
+    float charge = DEFAULT_CHARGE;
     float dragCoefficient = DEFAULT_DRAG;
     float staticFriction = DEFAULT_FRICTION;
     float kineticFriction = DEFAULT_FRICTION;
@@ -29,6 +33,7 @@ struct RectSettings : ToolSettings {
     float width = DEFAULT_LENGTH * 2;
     float height = DEFAULT_LENGTH * 2;
     float density = DEFAULT_DENSITY;
+    float charge = DEFAULT_CHARGE;
     float dragCoefficient = DEFAULT_DRAG;
     float staticFriction = DEFAULT_FRICTION;
     float kineticFriction = DEFAULT_FRICTION;
@@ -37,9 +42,27 @@ struct RectSettings : ToolSettings {
 
 struct RopeSettings : ToolSettings {};
 
+enum SpringMode
+{
+    SPRING_CONNECT,   // Join two bodies
+    SPRING_SOFT_BOX,  // Place a rectangular lattice
+    SPRING_SOFT_BALL, // Place a round lattice
+};
+
 struct SpringSettings : ToolSettings {
+    int mode = SPRING_CONNECT;
     float springConstant = DEFAULT_SPRING_CONSTANT;
-    float restLength = DEFAULT_LENGTH;
+    float restLength = DEFAULT_LENGTH; // Also the lattice spacing
+    float damping = DEFAULT_SPRING_DAMPING;
+    float breakStrain = DEFAULT_BREAK_STRAIN;
+    int columns = DEFAULT_LATTICE_SIZE;
+    int rows = DEFAULT_LATTICE_SIZE;
+    float density = DEFAULT_DENSITY;
+};
+
+struct FluidSettings : ToolSettings {
+    float rate = DEFAULT_FLUID_RATE;
+    float radius = DEFAULT_EMITTER_RADIUS;
 };
 
 class Tools
@@ -51,7 +74,7 @@ private:
 public:
     ToolSettings *settings;
     
-    Tools();
+    Tools(AssetCache &assets);
     ~Tools();
 
     void addTool(Tool *tool);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free handoff of the latest value from one writer thread to one reader thread.
+// The writer fills its back buffer and publishes it; the reader takes the newest published buffer.
+// Neither side ever waits, and the writer never touches the buffer the reader is using.
+template <typename T>
+class TripleBuffer
+{
+private:
+    static constexpr unsigned int INDEX_MASK = 3;
+    static constexpr unsigned int FRESH = 4; // Set while the middle buffer has not been read
+
+    T buffers[3];
+    std::atomic<unsigned int> middle{1}; // Index of the buffer in transit, plus the FRESH flag
+    unsigned int back = 0;               // Owned by the writer
+    unsigned int front = 2;              // Owned by the reader
+
+public:
+    // Methods
+    T &writeBuffer() // Buffer the writer fills next
+    {
+        return buffers[back];
+    }
+
+    void publish() // Hand the back buffer to the reader
+    {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    bool acquire() // Take the newest published buffer, false if nothing new was published
+    {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T &readBuffer() const // Buffer taken by the last successful acquire
+    {
+        return buffers[front];
+    }
+};
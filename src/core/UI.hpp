@@ -2,7 +2,52 @@
 
 #include "Config.h"
 
+#include <algorithm>
+#include <utility>
 #include <SFML/Graphics.hpp>
+#include <fmt/format.h>
+#include <imgui.h>
+#include "math/Scalar.hpp"
+
+// Fixed buffer that fmt formats into without allocating, text that does not fit is cut off
+template <size_t Capacity>
+class TextBuffer
+{
+private:
+    char data[Capacity] = {};
+    size_t length = 0;
+
+public:
+    void clear()
+    {
+        length = 0;
+        data[0] = '\0';
+    }
+
+    template <typename... Args>
+    void append(fmt::format_string<Args...> format, Args &&...args)
+    {
+        size_t space = Capacity - 1 - length;
+        auto result = fmt::format_to_n(data + length, space, format, std::forward<Args>(args)...);
+        length += std::min(result.size, space);
+        data[length] = '\0';
+    }
+
+    const char *begin() const { return data; }
+    const char *end() const { return data + length; }
+    const char *c_str() const { return data; }
+};
+
+// Drag widgets for physics values in either precision
+inline bool dragScalar(const char *label, float *value, float speed, float min, float max)
+{
+    return ImGui::DragFloat(label, value, speed, min, max);
+}
+
+inline bool dragScalar(const char *label, double *value, float speed, double min, double max)
+{
+    return ImGui::DragScalar(label, ImGuiDataType_Double, value, speed, &min, &max, "%.3f");
+}
 
 inline void handleResize(sf::Window *window, sf::View *newView, sf::View *oldView, const sf::Event::Resized *resized)
 {
@@ -1,70 +1,296 @@
 #include "World.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include "engine/CCD.hpp"
 #include "engine/Collision.hpp"
+#include "engine/Log.hpp"
+#include "engine/ThreadPool.hpp"
 
-World::World() : gravity(DEFAULT_GRAVITY), airDensity(DEFAULT_AIR_DENSITY) {}
+World::World() : fluid(Vec2(-WORLD_WIDTH / 2 + WALL_THICKNESS, DEF_HEIGHT - WORLD_HEIGHT + WALL_THICKNESS) / pixelsPerMeter,
+                       Vec2(WORLD_WIDTH / 2 - WALL_THICKNESS, DEF_HEIGHT - WALL_THICKNESS) / pixelsPerMeter),
+                 granular(Vec2(-WORLD_WIDTH / 2, DEF_HEIGHT - WORLD_HEIGHT) / pixelsPerMeter, Vec2(WORLD_WIDTH / 2, DEF_HEIGHT) / pixelsPerMeter),
+                 gravity(DEFAULT_GRAVITY), airDensity(DEFAULT_AIR_DENSITY)
+{
+    Vec2 minMeters = Vec2(-WORLD_WIDTH / 2, DEF_HEIGHT - WORLD_HEIGHT) / pixelsPerMeter;
+    Vec2 maxMeters = Vec2(WORLD_WIDTH / 2, DEF_HEIGHT) / pixelsPerMeter;
+    grid = SpatialGrid(minMeters, maxMeters, SPATIAL_CELL_SIZE);
+}
 World::~World()
 {
-    for (Object *object : objects)
+    for (ForceField *field : fields)
     {
-        delete object;
+        delete field;
     }
 }
 
-void World::addObject(Object *object)
+Object *World::createObject(const Vec2 &position, const Vec2 &dimensions, Scalar density, ShapeType type)
 {
+    Object *object = pool.create(position, dimensions, density, type);
     object->setID(nextObjectID++);
     object->setGravityPointer(&gravity);
-    object->switchSolver(odeSolver);
-    objects.push_back(object);
+    return object;
 }
 
-void World::removeObject(size_t index)
+Object *World::cloneObject(const Object &source)
 {
-    if (index < objects.size())
+    Object *object = createObject(source.body->position, source.dimensions, 1.0f, source.shapeType);
+    object->copyFrom(source);
+    stripDerivedForces(object);
+    return object;
+}
+
+void World::stripDerivedForces(Object *object)
+{
+    static const char *derived[] = {"grab", "nbody", "field", "program", "spring", "fluid"};
+    for (const char *name : derived)
     {
-        objects.erase(objects.begin() + index);
+        object->deleteForce(name);
     }
 }
 
-void World::clearObjects()
+Object *World::restoreObject(ObjectHandle handle, const Vec2 &position, const Vec2 &dimensions, ShapeType type)
 {
-    for (Object *object : objects)
+    Object *object = pool.restore(handle, position, dimensions, 1.0f, type);
+    if (object != nullptr)
+        object->setGravityPointer(&gravity);
+    return object;
+}
+
+void World::copyContents(const World &source)
+{
+    applySettings(source.getSettings());
+    contactIterations = source.contactIterations;
+    for (ForceField *field : source.getFields())
+    {
+        addField(new ForceField(*field));
+    }
+    for (const ForceProgram &program : source.getPrograms())
+    {
+        addProgram(program);
+    }
+    std::unordered_map<uint32_t, ObjectHandle> clones; // Handle in the source to handle in the copy
+    for (Object *object : source.getObjects())
+    {
+        Object *clone = cloneObject(*object);
+        clones[object->handle.value] = clone->handle;
+        // The grab follows the live mouse, the copy lets go. Its derived forces were left behind by cloneObject.
+        clone->isGrabbed = false;
+        clone->finishStep();
+    }
+    for (Spring spring : source.springs.getSprings())
     {
-        delete object;
+        spring.a = clones[spring.a.value];
+        spring.b = clones[spring.b.value];
+        springs.add(spring);
     }
-    objects.clear();
+    // The particles come along, the pour follows the live mouse like the grab
+    fluid = source.fluid;
+    fluid.stopEmitter();
+    simulationTime = source.simulationTime;
+}
+
+bool World::removeObject(ObjectHandle handle)
+{
+    Object *object = pool.get(handle);
+    if (object == nullptr)
+        return false;
+
+    fieldTargets.erase(std::remove(fieldTargets.begin(), fieldTargets.end(), object), fieldTargets.end());
+    springs.removeBody(handle);
+    return pool.destroy(handle);
+}
+
+Object *World::getObject(ObjectHandle handle) const
+{
+    return pool.get(handle);
+}
+
+void World::clearObjects()
+{
+    pool.clear();
+    fieldTargets.clear();
+    springs.clear();
+    springTargets.clear();
+    fluid.clear();
+    fluid.stopEmitter();
     nextObjectID = 0;
+    simulationTime = 0.0f;
 }
 
-void World::update(float dt)
+void World::addBoundaries()
 {
-    // Apply global forces
+    Vec2 horizontalSize = Vec2(WORLD_WIDTH, WALL_THICKNESS) / pixelsPerMeter;
+    Vec2 verticalSize = Vec2(WALL_THICKNESS, WORLD_HEIGHT) / pixelsPerMeter;
+    Scalar wallCenterY = (DEF_HEIGHT - HALF_WALL_THICKNESS) - (WORLD_HEIGHT / 2);
+
+    Object *walls[4] = {
+        createObject(Vec2(0, DEF_HEIGHT - HALF_WALL_THICKNESS) / pixelsPerMeter, horizontalSize, 1.0f, RECTANGLE),                     // Ground
+        createObject(Vec2(-(WORLD_WIDTH / 2 - HALF_WALL_THICKNESS), wallCenterY) / pixelsPerMeter, verticalSize, 1.0f, RECTANGLE),    // Left wall
+        createObject(Vec2(WORLD_WIDTH / 2 - HALF_WALL_THICKNESS, wallCenterY) / pixelsPerMeter, verticalSize, 1.0f, RECTANGLE),       // Right wall
+        createObject(Vec2(0, (DEF_HEIGHT + HALF_WALL_THICKNESS) - WORLD_HEIGHT) / pixelsPerMeter, horizontalSize, 1.0f, RECTANGLE), // Ceiling
+    };
+    for (Object *wall : walls)
+    {
+        wall->setConstant();
+        wall->shape->setFillColor(WALL_COLOR);
+        wall->finishStep();
+    }
+}
+
+void World::addField(ForceField *field)
+{
+    removeField(field->name);
+    fields.push_back(field);
+}
+
+void World::removeField(const std::string &name)
+{
+    for (auto it = fields.begin(); it != fields.end(); ++it)
+    {
+        if ((*it)->name == name)
+        {
+            delete *it;
+            fields.erase(it);
+            break;
+        }
+    }
+}
+
+ForceField *World::getField(const std::string &name) const
+{
+    for (ForceField *field : fields)
+    {
+        if (field->name == name)
+            return field;
+    }
+    return nullptr;
+}
+
+const std::vector<ForceField *> &World::getFields() const
+{
+    return fields;
+}
+
+void World::addProgram(const ForceProgram &program)
+{
+    removeProgram(program.name);
+    programs.push_back(program);
+}
+
+void World::removeProgram(const std::string &name)
+{
+    programs.erase(std::remove_if(programs.begin(), programs.end(), [&name](const ForceProgram &program)
+                                  { return program.name == name; }),
+                   programs.end());
+}
+
+const std::vector<ForceProgram> &World::getPrograms() const
+{
+    return programs;
+}
+
+SpringNetwork &World::getSprings()
+{
+    return springs;
+}
+
+const SpringNetwork &World::getSprings() const
+{
+    return springs;
+}
+
+void World::addSoftBody(const Vec2 &center, int columns, int rows, Scalar density, const Spring &prototype, bool round)
+{
+    Scalar spacing = prototype.restLength;
+    Vec2 corner = center - Vec2(columns - 1, rows - 1) * (spacing * 0.5f);
+    Vec2 radii = Vec2(columns, rows) * (spacing * 0.5f);
+
+    // Lay out the nodes row by row, holes are left where a round body has none
+    std::vector<ObjectHandle> lattice(static_cast<size_t>(columns) * rows);
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < columns; x++)
+        {
+            Vec2 position = corner + Vec2(x, y) * spacing;
+            Vec2 offset = position - center;
+            if (round && (offset.x * offset.x) / (radii.x * radii.x) + (offset.y * offset.y) / (radii.y * radii.y) > 1.0f)
+                continue;
+
+            Scalar radius = spacing * SOFT_BODY_NODE_RADIUS;
+            Object *node = createObject(position, Vec2(radius, radius), density, CIRCLE);
+            node->body->dragCoefficient = 0.0f; // Keeps the nodes on the solvers' linear path
+            node->shape->setFillColor(SOFT_BODY_COLOR);
+            node->finishStep();
+            lattice[y * columns + x] = node->handle;
+        }
+    }
+
+    // Structural springs to the right and below, shear springs along both diagonals
+    const int links[4][2] = {{1, 0}, {0, 1}, {1, 1}, {-1, 1}};
+    for (int y = 0; y < rows; y++)
+    {
+        for (int x = 0; x < columns; x++)
+        {
+            ObjectHandle from = lattice[y * columns + x];
+            if (from.isNull())
+                continue;
+            for (const int *link : links)
+            {
+                int nx = x + link[0], ny = y + link[1];
+                if (nx < 0 || nx >= columns || ny >= rows || lattice[ny * columns + nx].isNull())
+                    continue;
+
+                Spring spring = prototype;
+                spring.a = from;
+                spring.b = lattice[ny * columns + nx];
+                spring.restLength = spacing * std::sqrt(static_cast<Scalar>(link[0] * link[0] + link[1] * link[1]));
+                springs.add(spring);
+            }
+        }
+    }
+}
+
+FluidSystem &World::getFluid()
+{
+    return fluid;
+}
+
+const FluidSystem &World::getFluid() const
+{
+    return fluid;
+}
+
+void World::queryObjects(const Vec2 &min, const Vec2 &max, std::vector<int> &result) const
+{
+    grid.query(min, max, result);
+}
+
+void World::applyGlobalForces()
+{
+    const std::vector<Object *> &objects = pool.getObjects();
     for (Object *object : objects)
     {
         Body *body = object->body;
 
+        // Gravity is refreshed every step, so it is a constant force and free-flying bodies stay on the closed-form path
         if (object->doGravity)
         {
-            Vec2 *gravityPointer = &gravity;
-            ForceSource gravitySource("gravity", [gravityPointer](Body state)
-                                      {
-                Vec2 gForce = *gravityPointer * state.mass;
-                return Force(Vec2(0, 0), gForce); });
-            object->applyForce(gravitySource);
+            object->applyForce(ForceSource("gravity", Force(Vec2(0, 0), gravity * body->mass)));
         }
 
         if (object->doDrag && body->dragCoefficient != 0.0f)
         {
-            float airDensity = this->airDensity;
-            float area = object->dimensions.x;
+            Scalar airDensity = this->airDensity;
+            Scalar area = object->dimensions.x;
             ForceSource dragSource("drag", [airDensity, area](Body state)
                                    {
                 Vec2 df = state.velocity * -1.0f;
-                float speedSq = state.velocity.lengthSquared();
+                Scalar speedSq = state.velocity.lengthSquared();
                 if (speedSq > 0.0f)
                 {
                     df = df.normalized();
-                    float dragMagnitude = 0.5f * airDensity * speedSq * area * state.dragCoefficient;
+                    Scalar dragMagnitude = 0.5f * airDensity * speedSq * area * state.dragCoefficient;
                     df *= dragMagnitude;
                 }
                 return Force(Vec2(0, 0), df); });
@@ -72,60 +298,572 @@ void World::update(float dt)
         }
     }
 
-    // Collision detection and forces
+    applyNBodyForces();
+    applyFieldForces();
+    applyProgramForces();
+    applySpringForces();
+}
+
+void World::applyFieldForces()
+{
+    const std::vector<Object *> &objects = pool.getObjects();
+    // Rebuild the spatial grid over the object bounds
+    objectMins.resize(objects.size());
+    objectMaxs.resize(objects.size());
     for (size_t i = 0; i < objects.size(); i++)
     {
-        for (size_t j = i + 1; j < objects.size(); j++)
-        {
-            Object *objA = objects[i];
-            Object *objB = objects[j];
+        objects[i]->getBounds(objectMins[i], objectMaxs[i]);
+    }
+    grid.build(objectMins, objectMaxs);
 
-            if (objA->isStatic && objB->isStatic)
+    for (Object *object : fieldTargets)
+    {
+        object->deleteForce("field");
+    }
+    fieldTargets.clear();
+
+    if (fields.empty())
+        return;
+
+    fieldForces.resize(objects.size());
+    fieldMarks.resize(objects.size(), 0);
+
+    // Only the objects inside a field's cutoff region are visited
+    std::vector<int> hits;
+    std::vector<int> touched;
+    for (ForceField *field : fields)
+    {
+        Vec2 min, max;
+        field->getBounds(min, max);
+        hits.clear();
+        grid.query(min, max, hits);
+
+        for (int index : hits)
+        {
+            Object *object = objects[index];
+            if (object->isStatic || object->isGrabbed)
                 continue;
 
-            CollisionInfo info = checkCollision(objA, objB);
+            if (!fieldMarks[index])
+            {
+                fieldMarks[index] = 1;
+                fieldForces[index] = Vec2(0.0f, 0.0f);
+                touched.push_back(index);
+            }
+            fieldForces[index] += field->sample(object->body->position);
+        }
+    }
+
+    // The summed field force is held constant over the step
+    for (int index : touched)
+    {
+        fieldMarks[index] = 0;
+        objects[index]->applyForce(ForceSource("field", Force(Vec2(0, 0), fieldForces[index])));
+        fieldTargets.push_back(objects[index]);
+    }
+}
 
-            if (info.isColliding)
+void World::applyProgramForces()
+{
+    const std::vector<Object *> &objects = pool.getObjects();
+    if (programs.empty())
+    {
+        if (hadProgramForces)
+        {
+            for (Object *object : objects)
             {
-                resolveCollision(objA, objB, info, dt);
+                object->deleteForce("program");
             }
+            hadProgramForces = false;
         }
+        return;
     }
 
-    // Update all objects
-    float energySum = 0.0f;
+    // Gather the dynamic bodies, in the user's frame with y up from the ground
+    Scalar ground = pixelsToMeters(DEF_HEIGHT - WALL_THICKNESS);
+    programBodies.clear();
     for (Object *object : objects)
     {
-        object->update(dt);
+        if (object->isStatic || object->isGrabbed)
+        {
+            if (hadProgramForces)
+                object->deleteForce("program");
+            continue;
+        }
+        programBodies.push_back(object);
+    }
+    hadProgramForces = true;
+
+    programEvaluator.programs = &programs;
+    programEvaluator.ground = ground;
+    programEvaluator.uniforms[UNIFORM_TIME] = simulationTime;
+    programEvaluator.uniforms[UNIFORM_GX] = gravity.x;
+    programEvaluator.uniforms[UNIFORM_GY] = -gravity.y;
+    // A program that is not affine in p and v is evaluated by the solvers at every stage, one pass over all bodies per stage
+    // A program that is not affine in p and v is evaluated by the solvers at every stage, like the n-body forces
+    bool affine = std::all_of(programs.begin(), programs.end(), [](const ForceProgram &program)
+                              { return program.isAffine(); });
+    if (!affine)
+    {
+        for (Object *object : programBodies)
+        {
+            object->applyForce(ForceSource("program", &programEvaluator, 0));
+        }
+        return;
+    }
+
+    // Otherwise only the lanes besides p and v are gathered, those two are replaced by the probes
+    size_t count = programBodies.size();
+    for (std::vector<Scalar> &lane : programLanes)
+    {
+        lane.resize(count);
+    }
+    programZeros.assign(count, 0.0f);
+    programOnes.assign(count, 1.0f);
+    programForceX.resize(count);
+    programForceY.resize(count);
+    for (int probe = 0; probe < PROGRAM_PROBES; probe++)
+    {
+        programSumX[probe].assign(count, 0.0f);
+        programSumY[probe].assign(count, 0.0f);
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        const Body *body = programBodies[i]->body;
+        programLanes[INPUT_MASS][i] = body->mass;
+        programLanes[INPUT_CHARGE][i] = body->charge;
+        programLanes[INPUT_ANGLE][i] = -body->angle;
+        programLanes[INPUT_SPIN][i] = -body->angularVelocity;
+    }
+
+    ProgramInputs inputs;
+    for (int lane = 0; lane < PROGRAM_LANE_INPUTS; lane++)
+    {
+        inputs.lanes[lane] = programLanes[lane].data();
+    }
+    std::copy(programEvaluator.uniforms, programEvaluator.uniforms + PROGRAM_UNIFORMS, inputs.uniforms);
+
+    // Each chunk runs every program over its own slice of the lanes, once per probe
+    Scalar *forceX = programForceX.data(), *forceY = programForceY.data();
+    ThreadPool::shared().parallelFor(count, [this, &inputs, forceX, forceY](size_t begin, size_t end)
+                                     {
+        thread_local std::vector<Scalar> scratch;
+        ProgramInputs slice = inputs;
+        for (int lane = 0; lane < PROGRAM_LANE_INPUTS; lane++)
+        {
+            slice.lanes[lane] += begin;
+        }
+        for (int probe = 0; probe < PROGRAM_PROBES; probe++)
+        {
+            for (int lane = INPUT_PX; lane <= INPUT_VY; lane++)
+            {
+                slice.lanes[lane] = (probe == lane + 1 ? programOnes.data() : programZeros.data()) + begin;
+            }
+            Scalar *sumX = programSumX[probe].data(), *sumY = programSumY[probe].data();
+            for (const ForceProgram &program : programs)
+            {
+                program.run(slice, end - begin, forceX + begin, forceY + begin, scratch);
+                for (size_t i = begin; i < end; i++)
+                {
+                    sumX[i] += forceX[i];
+                    sumY[i] += forceY[i];
+                }
+            }
+        } }, PROGRAM_BATCH_SIZE);
+
+    // F = a + A·p + B·v becomes a linear force when A and B are multiples of the identity, which the closed-form
+    // paths of the solvers integrate exactly. Anything else, e.g. a pull along one axis, is evaluated per stage.
+    for (size_t i = 0; i < count; i++)
+    {
+        Vec2 offset(programSumX[0][i], programSumY[0][i]);
+        Vec2 gain[PROGRAM_PROBES - 1]; // Column of A or B for px, py, vx and vy
+        for (int probe = 1; probe < PROGRAM_PROBES; probe++)
+        {
+            gain[probe - 1] = Vec2(programSumX[probe][i], programSumY[probe][i]) - offset;
+        }
+
+        Scalar scale = std::abs(offset.x) + std::abs(offset.y);
+        Scalar mismatch = 0.0f;
+        for (int k = 0; k < 4; k += 2)
+        {
+            scale += std::abs(gain[k].x) + std::abs(gain[k + 1].y);
+            mismatch += std::abs(gain[k].y) + std::abs(gain[k + 1].x) + std::abs(gain[k].x - gain[k + 1].y);
+        }
+        if (mismatch > PROGRAM_ISOTROPY_TOLERANCE * scale)
+        {
+            programBodies[i]->applyForce(ForceSource("program", &programEvaluator, 0));
+            continue;
+        }
+
+        // Back to the world's frame, where the user's y is ground - y
+        Scalar positionGain = 0.5f * (gain[0].x + gain[1].y);
+        Scalar velocityGain = 0.5f * (gain[2].x + gain[3].y);
+        Vec2 worldOffset(offset.x, -offset.y - positionGain * ground);
+        if (positionGain == 0.0f && velocityGain == 0.0f)
+            programBodies[i]->applyForce(ForceSource("program", Force(Vec2(0, 0), worldOffset)));
+        else
+            programBodies[i]->applyForce(ForceSource::linear("program", worldOffset, positionGain, velocityGain));
+    }
+}
+
+void World::applyFluidForces(Scalar dt)
+{
+    const std::vector<Object *> &objects = pool.getObjects();
+    if (!fluid.isActive())
+    {
+        if (hadFluidForces)
+        {
+            for (Object *object : objects)
+            {
+                object->deleteForce("fluid");
+            }
+            hadFluidForces = false;
+        }
+        return;
+    }
+
+    fluid.step(dt, gravity, objects, fluidForces, fluidTorques);
+
+    // The average reaction over the fluid's substeps, force and torque, is held constant over the object step
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        Object *object = objects[i];
+        if (fluidForces[i].lengthSquared() == 0.0f && fluidTorques[i] == 0.0f)
+        {
+            if (hadFluidForces)
+                object->deleteForce("fluid");
+            continue;
+        }
+        object->applyForce(ForceSource("fluid", Force(Vec2(0, 0), fluidForces[i], fluidTorques[i])));
+    }
+    hadFluidForces = true;
+}
+
+void World::applySpringForces()
+{
+    const std::vector<ObjectHandle> &nodes = springs.getNodes();
+    if (nodes.empty() && springTargets.empty())
+        return;
+
+    springBodies.resize(nodes.size());
+    for (size_t n = 0; n < nodes.size(); n++)
+    {
+        springBodies[n] = pool.get(nodes[n])->body;
+    }
+    springs.computeForces(springBodies);
+
+    // Bodies that lost their last spring keep no stale force
+    if (springTargets != nodes)
+    {
+        for (ObjectHandle handle : springTargets)
+        {
+            Object *object = pool.get(handle);
+            if (object != nullptr)
+                object->deleteForce("spring");
+        }
+        springTargets = nodes;
+    }
+
+    // Linear in the body's own state, so the solvers integrate it without extra force calls
+    for (size_t n = 0; n < nodes.size(); n++)
+    {
+        Object *object = pool.get(nodes[n]);
+        if (object->isStatic || object->isGrabbed)
+        {
+            object->deleteForce("spring");
+            continue;
+        }
+        object->applyForce(ForceSource::linear("spring", springs.getOffset(n), springs.getPositionGain(n), springs.getVelocityGain(n)));
+    }
+}
+
+void World::applyNBodyForces()
+{
+    const std::vector<Object *> &objects = pool.getObjects();
+    if (!nbody.doGravity && !nbody.doElectrostatics)
+    {
+        if (hadNBodyForces)
+        {
+            for (Object *object : objects)
+            {
+                object->deleteForce("nbody");
+            }
+            hadNBodyForces = false;
+        }
+        return;
+    }
+
+    // Walls and grabbed objects do not take part
+    std::vector<const Body *> bodies;
+    std::vector<int> treeIndices(objects.size(), -1);
+    bodies.reserve(objects.size());
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        if (!objects[i]->isSelectable || objects[i]->isGrabbed)
+            continue;
+        treeIndices[i] = static_cast<int>(bodies.size());
+        bodies.push_back(objects[i]->body);
+    }
+    nbodyTree.build(bodies);
+
+    // The tree is evaluated at every integrator stage, so each stage sees the other bodies as of the step start.
+    // Sources only carry the body's index into the tree, nothing is allocated per body.
+    nbodyEvaluator.tree = &nbodyTree;
+    nbodyEvaluator.params = nbody;
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        Object *object = objects[i];
+        int self = treeIndices[i];
+        if (object->isStatic || self < 0)
+        {
+            object->deleteForce("nbody");
+            continue;
+        }
+        object->applyForce(ForceSource("nbody", &nbodyEvaluator, self));
+    }
+    hadNBodyForces = true;
+}
+
+void World::resolveSwept(Scalar dt)
+{
+    const std::vector<Object *> &objects = pool.getObjects();
+    if (sweptIndices.empty())
+        return;
+
+    // The grid still holds the bounds from the start of the step while other bodies are taken where they ended,
+    // so queries are widened by the furthest any bounds have moved since, grown again as impacts move bodies
+    Scalar margin = 0.0f;
+    auto widen = [this, &objects, &margin](size_t i)
+    {
+        Vec2 min, max;
+        objects[i]->getBounds(min, max);
+        margin = std::max({margin, objectMins[i].x - min.x, objectMins[i].y - min.y, max.x - objectMaxs[i].x, max.y - objectMaxs[i].y});
+    };
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        widen(i);
+    }
+
+    for (size_t k = 0; k < sweptIndices.size(); k++)
+    {
+        Object *object = objects[sweptIndices[k]];
+        Body start = sweptStarts[k];
+        Scalar remaining = dt;
+        bool settled = false;
+
+        for (int pass = 0; pass < CCD_MAX_SUBSTEPS && !settled; pass++)
+        {
+            // Earliest impact along the integrated path, other bodies are taken at their end-of-step positions.
+            // Only the objects near the path's bounds are swept against.
+            Vec2 move = object->body->position - start.position;
+            Scalar travel = move.length();
+            Vec2 pathMin, pathMax;
+            object->getBounds(pathMin, pathMax);
+            pathMin = Vec2(std::min(pathMin.x, pathMin.x - move.x), std::min(pathMin.y, pathMin.y - move.y)) - Vec2(margin, margin);
+            pathMax = Vec2(std::max(pathMax.x, pathMax.x - move.x), std::max(pathMax.y, pathMax.y - move.y)) + Vec2(margin, margin);
+            candidates.clear();
+            grid.query(pathMin, pathMax, candidates);
+
+            Scalar earliest = 1.0f;
+            int hit = -1;
+            CollisionInfo hitInfo;
+            for (int j : candidates)
+            {
+                Object *other = objects[j];
+                if (other == object || other->isGrabbed)
+                    continue;
+
+                Scalar toi;
+                CollisionInfo info;
+                if (sweepObjects(object, start.position, move, other, other->body->position, Vec2(0.0f, 0.0f), toi, info) && toi < earliest)
+                {
+                    earliest = toi;
+                    hit = j;
+                    hitInfo = info;
+                }
+            }
+
+            if (hit < 0)
+            {
+                settled = true;
+                break;
+            }
+
+            // Advance to just before the impact, bounce, then spend the rest of the step from there
+            Scalar fraction = travel > 0.0f ? std::max<Scalar>(earliest - CCD_SKIN / travel, 0.0f) : 0.0f;
+            Scalar impactTime = remaining * fraction;
+            *object->body = start;
+            Body advanced = simulateObject(odeSolver, *object, impactTime);
+            advanced.position = start.position + move * fraction;
+            *object->body = advanced;
+            resolveCollision(object, objects[hit], hitInfo, impactTime);
+            widen(hit);
+
+            remaining -= impactTime;
+            start = *object->body;
+            *object->body = simulateObject(odeSolver, *object, remaining);
+        }
+
+        // Out of sub-steps, stay at the last safe position rather than tunnel
+        if (!settled)
+        {
+            LOG_DEBUG(LOG_SOLVER, "object {} ran out of swept sub-steps, held at its last safe position", object->getID());
+            object->body->position = start.position;
+        }
+
+        object->finishStep();
+        widen(sweptIndices[k]);
+    }
+}
+
+void World::update(Scalar dt)
+{
+    const std::vector<Object *> &objects = pool.getObjects();
+    // Apply global forces
+    applyGlobalForces();
+    applyFluidForces(dt);
+
+    // Collision detection and forces. Candidate pairs come from the spatial grid built with the global forces, bodies have
+    // not moved since; they are bucketed by shape combination for the narrowphase and circle pairs go to the granular solver.
+    narrowphase.clear();
+    granular.select(objects, granularMask);
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        // Granular circles only meet other objects from the other object's side
+        if (granularMask[i])
+            continue;
+
+        candidates.clear();
+        grid.query(objectMins[i], objectMaxs[i], candidates);
+        for (int j : candidates)
+        {
+            if (j <= static_cast<int>(i) && !granularMask[j])
+                continue;
+
+            Object *objA = objects[i];
+            Object *objB = objects[j];
+            if (objA->isStatic && objB->isStatic)
+                continue;
+            narrowphase.add(objA, objB);
+        }
+    }
+
+    narrowphase.run();
+    int contacts = narrowphase.resolve(dt, contactIterations);
+    contacts += granular.resolve(contactIterations);
+
+    // Remember where fast bodies started so their motion can be swept afterwards
+    sweptIndices.clear();
+    sweptStarts.clear();
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        Object *object = objects[i];
+        if (!object->isStatic && !object->isGrabbed && needsContinuous(object, dt))
+        {
+            sweptIndices.push_back(static_cast<int>(i));
+            sweptStarts.push_back(*object->body);
+        }
+    }
+
+    // Update all objects, large worlds are integrated in parallel
+    SolverType solver = odeSolver;
+    ThreadPool::shared().parallelFor(objects.size(), [&objects, solver, dt](size_t begin, size_t end)
+                                     { integrateObjects(solver, objects.data() + begin, end - begin, dt); }, PARALLEL_MIN_CHUNK);
 
-        energySum += object->body->totalEnergy;
+    resolveSwept(dt);
+
+    Scalar energySum = 0.0f;
+    Vec2 momentumSum;
+    Scalar maxSpeedSq = 0.0f;
+    for (Object *object : objects)
+    {
+        // Static bodies never exchange energy, they are left out like their momentum
+        if (!object->isStatic)
+        {
+            energySum += object->body->totalEnergy;
+            momentumSum += object->body->velocity * object->body->mass;
+            maxSpeedSq = std::max(maxSpeedSq, object->body->velocity.lengthSquared());
+        }
     }
     totalEnergy = energySum;
+    contactCount = contacts;
+    momentum = momentumSum.length();
+    maxSpeed = std::sqrt(maxSpeedSq);
+    simulationTime += dt;
+
+    // Publish a telemetry sample, dropped when the consumer falls behind
+    if (telemetry != nullptr)
+    {
+        TelemetrySample sample;
+        sample.time = static_cast<float>(simulationTime);
+        sample.energy = static_cast<float>(totalEnergy);
+        sample.momentum = static_cast<float>(momentum);
+        sample.maxSpeed = static_cast<float>(maxSpeed);
+        sample.contacts = contactCount;
+        telemetry->push(sample);
+    }
 }
 
-void World::draw(sf::RenderWindow *window)
+void World::draw(sf::RenderTarget *target)
 {
+    const std::vector<Object *> &objects = pool.getObjects();
+    const std::vector<Spring> &connections = springs.getSprings();
+    springVertices.setPrimitiveType(sf::PrimitiveType::Lines);
+    springVertices.resize(connections.size() * 2);
+    for (size_t s = 0; s < connections.size(); s++)
+    {
+        Vec2 a = pool.get(connections[s].a)->body->position * pixelsPerMeter;
+        Vec2 b = pool.get(connections[s].b)->body->position * pixelsPerMeter;
+        springVertices[s * 2] = sf::Vertex{sf::Vector2f(static_cast<float>(a.x), static_cast<float>(a.y)), SPRING_COLOR};
+        springVertices[s * 2 + 1] = sf::Vertex{sf::Vector2f(static_cast<float>(b.x), static_cast<float>(b.y)), SPRING_COLOR};
+    }
+    if (!connections.empty())
+        target->draw(springVertices);
+
     for (Object *object : objects)
     {
-        object->draw(window);
+        object->draw(target);
     }
+
+    fluid.getPixelPositions(fluidPixels);
+    FluidSystem::drawParticles(target, fluidPixels, fluidVertices);
 }
 
 const std::vector<Object *> &World::getObjects() const
 {
-    return objects;
+    return pool.getObjects();
 }
 
 void World::setODESolver(SolverType type)
 {
-    odeSolver = type;
-    for (Object *object : objects)
+    // Unimplemented solvers keep the current one
+    if (isSolverImplemented(type))
     {
-        object->switchSolver(type);
+        odeSolver = type;
     }
 }
 
 SolverType World::getODESolver() const
 {
     return odeSolver;
-}
\ No newline at end of file
+}
+
+WorldSettings World::getSettings() const
+{
+    WorldSettings settings;
+    settings.gravity = gravity;
+    settings.airDensity = airDensity;
+    settings.calculationFrequency = calculationFrequency;
+    settings.nbody = nbody;
+    settings.solver = odeSolver;
+    return settings;
+}
+
+void World::applySettings(const WorldSettings &settings)
+{
+    gravity = settings.gravity;
+    airDensity = settings.airDensity;
+    calculationFrequency = settings.calculationFrequency;
+    nbody = settings.nbody;
+    setODESolver(settings.solver);
+}
@@ -3,37 +3,155 @@
 #include <vector>
 #include <SFML/Graphics.hpp>
 #include "objects/Object.hpp"
+#include "core/ObjectPool.hpp"
+#include "engine/BarnesHut.hpp"
+#include "engine/Collision.hpp"
+#include "engine/ForceField.hpp"
+#include "engine/Fluid.hpp"
+#include "engine/ForceProgram.hpp"
+#include "engine/Granular.hpp"
+#include "engine/Narrowphase.hpp"
+#include "engine/SpatialGrid.hpp"
+#include "engine/SpringNetwork.hpp"
+#include "core/Telemetry.hpp"
+
+// Tunable world parameters, copied as a whole when they cross threads
+struct WorldSettings
+{
+    Vec2 gravity = DEFAULT_GRAVITY;
+    Scalar airDensity = DEFAULT_AIR_DENSITY;
+    float calculationFrequency = DEFAULT_CALC_FREQ;
+    NBodyParameters nbody;
+    SolverType solver = DEFAULT_SOLVER;
+};
 
 class World
 {
 private:
-    std::vector<Object *> objects;         // List of objects in the world
+    ObjectPool pool;                       // Objects in the world, packed for iteration
     SolverType odeSolver = DEFAULT_SOLVER; // Default ODE solver
     int nextObjectID = 0;                  // ID counter for objects
 
+    BarnesHutTree nbodyTree;       // Quadtree over body positions, rebuilt every step
+    NBodyEvaluator nbodyEvaluator; // Force of nbodyTree, shared by every body's n-body source
+    bool hadNBodyForces = false;   // Whether objects still carry n-body force sources
+
+    std::vector<ForceField *> fields;    // Tool and other world-level force fields
+    std::vector<Object *> fieldTargets; // Objects that received field forces last step
+    std::vector<Vec2> fieldForces;      // Per-object field force scratch, indexed like objects
+    std::vector<char> fieldMarks;       // Per-object flag for objects already in fieldTargets
+    SpatialGrid grid;                   // Object bounds, rebuilt every step for spatial queries
+    std::vector<Vec2> objectMins;       // Bounds the grid was built from, indexed like objects
+    std::vector<Vec2> objectMaxs;
+    std::vector<int> candidates;        // Broadphase query scratch
+
+    // Affine programs are run at p = v = 0 and with each of px, py, vx and vy set to 1 to find their gains
+    static constexpr int PROGRAM_PROBES = 5;
+
+    std::vector<ForceProgram> programs;                                          // User force expressions, summed per body
+    std::vector<Object *> programBodies;                                         // Bodies the programs ran on this step
+    std::vector<Scalar> programLanes[PROGRAM_LANE_INPUTS];                       // SoA inputs of programBodies, in user space
+    std::vector<Scalar> programZeros, programOnes;                               // Probe values of the p and v lanes
+    std::vector<Scalar> programForceX, programForceY;                            // Output of one program
+    std::vector<Scalar> programSumX[PROGRAM_PROBES], programSumY[PROGRAM_PROBES]; // Output of all programs per probe
+    ProgramEvaluator programEvaluator;                                           // Programs evaluated at every stage
+    bool hadProgramForces = false;                                               // Whether objects still carry program force sources
+
+    SpringNetwork springs;                   // Springs between bodies, including soft-body lattices
+    std::vector<const Body *> springBodies;  // Body of each spring node, in the network's node order
+    std::vector<ObjectHandle> springTargets; // Bodies that received spring forces last step
+    sf::VertexArray springVertices;          // Spring lines, reused between draws
+
+    FluidSystem fluid;                // Liquid particles, stepped with the objects
+    std::vector<Vec2> fluidForces;    // Per-object reaction of the fluid, indexed like objects
+    std::vector<Scalar> fluidTorques; // Per-object reaction torque about the center
+    bool hadFluidForces = false;      // Whether objects still carry fluid force sources
+    std::vector<sf::Vector2f> fluidPixels; // Particle centers, reused between draws
+    sf::VertexArray fluidVertices;         // Particle quads, reused between draws
+
+    GranularSolver granular;        // Packed circle–circle contacts
+    std::vector<char> granularMask; // Per-object flag for the circles the granular solver took this step
+
+    Narrowphase narrowphase; // Candidate pairs bucketed by shape combination
+
+    std::vector<int> sweptIndices; // Fast bodies checked for tunneling this step, indexed like objects
+    std::vector<Body> sweptStarts; // Their state before integration
+
+    void applyNBodyForces(); // Rebuild the quadtree and attach pairwise forces
+    void applyFieldForces(); // Sample the force fields for the objects inside their cutoff
+    void applyProgramForces(); // Attach the force programs to every dynamic body, as linear forces when they are affine
+    void applySpringForces();  // Accumulate the spring forces over the network's rows
+    void applyFluidForces(Scalar dt); // Step the fluid and apply its reactions to the objects
+    void resolveSwept(Scalar dt); // Sub-step fast bodies to their first impact
+
 public:
     // World properties
     float calculationFrequency = DEFAULT_CALC_FREQ; // Frequency of physics calculations (Hz)
     Vec2 gravity = DEFAULT_GRAVITY;                 // Default gravity pointing downwards
-    float airDensity = DEFAULT_AIR_DENSITY;         // Air density for drag calculations
+    Scalar airDensity = DEFAULT_AIR_DENSITY;        // Air density for drag calculations
+    NBodyParameters nbody;                          // Pairwise gravitation & electrostatics
+    int contactIterations = 1;                      // Impulse passes over the contacts each step
 
     // World Variables
-    float totalEnergy = 0.0f; // Total energy in the world
+    Scalar totalEnergy = 0.0f;    // Total energy in the world
+    Scalar simulationTime = 0.0f; // Seconds simulated so far
+    int contactCount = 0;         // Colliding pairs in the last step
+    Scalar momentum = 0.0f;       // Magnitude of the total linear momentum
+    Scalar maxSpeed = 0.0f;       // Fastest dynamic body
+
+    TelemetryChannel *telemetry = nullptr; // Receives one sample per step when set
 
     // Constructors & Destructor
     World();
     ~World();
 
     // Methods
-    void addObject(Object *object);  // Add an object to the world
-    void removeObject(size_t index); // Remove an object from the world by index
-    void clearObjects();             // Remove all objects from the world
+    // Construct an object in the world's pool
+    Object *createObject(const Vec2 &position, const Vec2 &dimensions, Scalar density, ShapeType type);
+    Object *cloneObject(const Object &source);    // Add a copy of an object, possibly from another world, without derived forces
+    // Remove the force sources a world attaches every step or that follow the live mouse: grab, n-body, field,
+    // program, spring and fluid. They may point into the world that attached them, a copy rebuilds its own.
+    static void stripDerivedForces(Object *object);
+    // Bring a removed object back under its old handle, nullptr if its slot is taken. The caller restores its state.
+    Object *restoreObject(ObjectHandle handle, const Vec2 &position, const Vec2 &dimensions, ShapeType type);
+    bool removeObject(ObjectHandle handle);       // Remove and destroy an object in O(1), false for stale handles
+    Object *getObject(ObjectHandle handle) const; // nullptr once the object has been removed
+    void clearObjects();                          // Remove all objects from the world
+    void addBoundaries();                         // Add the static ground, walls and ceiling around the world
+    // Take over another world's settings, fields, programs, fluid and time and add copies of its objects and springs.
+    // Grabs and the pour follow the live mouse, so the copies let go of them.
+    void copyContents(const World &source);
+
+    void addField(ForceField *field);          // Add a force field to the world, replacing one with the same name
+    void removeField(const std::string &name); // Remove a force field by name
+    ForceField *getField(const std::string &name) const;
+    const std::vector<ForceField *> &getFields() const;
+
+    void addProgram(const ForceProgram &program); // Add a compiled force program, replacing one with the same name
+    void removeProgram(const std::string &name);  // Remove a force program by name
+    const std::vector<ForceProgram> &getPrograms() const;
 
-    void update(float dt);               // Update each object in the world based on forces and time step
-    void draw(sf::RenderWindow *window); // Draw all objects in the world
+    SpringNetwork &getSprings();
+    const SpringNetwork &getSprings() const;
+    // Add a lattice of circles joined by structural and shear springs, spaced at the prototype's rest length.
+    // A round body keeps the nodes inside the ellipse inscribed in the lattice.
+    void addSoftBody(const Vec2 &center, int columns, int rows, Scalar density, const Spring &prototype, bool round);
+
+    FluidSystem &getFluid();
+    const FluidSystem &getFluid() const;
+
+    // Append the indices of the objects whose bounds overlap [min, max], valid after the step's global forces
+    void queryObjects(const Vec2 &min, const Vec2 &max, std::vector<int> &result) const;
+
+    void applyGlobalForces();            // Apply gravity, drag, n-body, field, program and spring forces to every object
+    void update(Scalar dt);              // Update each object in the world based on forces and time step
+    void draw(sf::RenderTarget *target); // Draw the springs, objects and fluid in the world
 
     const std::vector<Object *> &getObjects() const; // Get the list of objects
 
     void setODESolver(SolverType type); // Set the ODE solver type
     SolverType getODESolver() const;    // Get the current ODE solver type
+
+    WorldSettings getSettings() const;
+    void applySettings(const WorldSettings &settings);
 };
\ No newline at end of file
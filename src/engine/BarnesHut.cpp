@@ -0,0 +1,195 @@
+#include "BarnesHut.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#define BARNES_HUT_MAX_DEPTH 32 // Bodies closer than the deepest cell share a leaf
+
+void BarnesHutTree::build(const std::vector<const Body *> &bodies)
+{
+    nodes.clear();
+    positions.resize(bodies.size());
+    masses.resize(bodies.size());
+    charges.resize(bodies.size());
+    nextBody.assign(bodies.size(), -1);
+
+    if (bodies.empty())
+        return;
+
+    // Square root cell enclosing every body
+    Vec2 min = bodies[0]->position;
+    Vec2 max = bodies[0]->position;
+    for (size_t i = 0; i < bodies.size(); i++)
+    {
+        positions[i] = bodies[i]->position;
+        masses[i] = bodies[i]->mass;
+        charges[i] = bodies[i]->charge;
+        min.set(std::min(min.x, positions[i].x), std::min(min.y, positions[i].y));
+        max.set(std::max(max.x, positions[i].x), std::max(max.y, positions[i].y));
+    }
+
+    QuadNode root;
+    root.center = (min + max) * 0.5f;
+    root.halfSize = std::max(max.x - min.x, max.y - min.y) * 0.5f + 1e-3f;
+    nodes.reserve(bodies.size() * 2 + 1);
+    nodes.push_back(root);
+
+    for (size_t i = 0; i < bodies.size(); i++)
+    {
+        insert(0, static_cast<int>(i), 0);
+    }
+
+    // Aggregate mass and charge bottom-up, children always come after their parent
+    for (size_t n = nodes.size(); n-- > 0;)
+    {
+        QuadNode &node = nodes[n];
+        Vec2 massMoment;
+        Vec2 chargeMoment;
+        if (node.firstChild < 0)
+        {
+            for (int b = node.firstBody; b >= 0; b = nextBody[b])
+            {
+                node.mass += masses[b];
+                node.charge += charges[b];
+                node.absCharge += std::abs(charges[b]);
+                massMoment += positions[b] * masses[b];
+                chargeMoment += positions[b] * std::abs(charges[b]);
+            }
+        }
+        else
+        {
+            for (int c = node.firstChild; c < node.firstChild + 4; c++)
+            {
+                const QuadNode &child = nodes[c];
+                node.mass += child.mass;
+                node.charge += child.charge;
+                node.absCharge += child.absCharge;
+                massMoment += child.massCenter * child.mass;
+                chargeMoment += child.chargeCenter * child.absCharge;
+            }
+        }
+        node.massCenter = node.mass > 0.0f ? massMoment / node.mass : node.center;
+        node.chargeCenter = node.absCharge > 0.0f ? chargeMoment / node.absCharge : node.center;
+    }
+}
+
+void BarnesHutTree::insert(int node, int body, int depth)
+{
+    while (nodes[node].firstChild >= 0)
+    {
+        node = childFor(node, positions[body]);
+        depth++;
+    }
+
+    if (nodes[node].bodyCount == 0 || depth >= BARNES_HUT_MAX_DEPTH)
+    {
+        nextBody[body] = nodes[node].firstBody;
+        nodes[node].firstBody = body;
+        nodes[node].bodyCount++;
+        return;
+    }
+
+    // Occupied leaf: push the resident body down one level and retry
+    int resident = nodes[node].firstBody;
+    nodes[node].firstBody = -1;
+    nodes[node].bodyCount = 0;
+    subdivide(node);
+    insert(childFor(node, positions[resident]), resident, depth + 1);
+    insert(node, body, depth);
+}
+
+void BarnesHutTree::subdivide(int node)
+{
+    Scalar quarter = nodes[node].halfSize * 0.5f;
+    Vec2 center = nodes[node].center;
+    nodes[node].firstChild = static_cast<int>(nodes.size());
+    for (int i = 0; i < 4; i++)
+    {
+        QuadNode child;
+        child.halfSize = quarter;
+        child.center = center + Vec2((i & 1) ? quarter : -quarter, (i & 2) ? quarter : -quarter);
+        nodes.push_back(child);
+    }
+}
+
+int BarnesHutTree::childFor(int node, const Vec2 &position) const
+{
+    const QuadNode &parent = nodes[node];
+    int index = (position.x >= parent.center.x ? 1 : 0) + (position.y >= parent.center.y ? 2 : 0);
+    return parent.firstChild + index;
+}
+
+Vec2 BarnesHutTree::evaluate(const Vec2 &position, Scalar mass, Scalar charge, int self, const NBodyParameters &params) const
+{
+    Vec2 force;
+    if (nodes.empty())
+        return force;
+
+    Scalar softeningSq = params.softening * params.softening;
+    Scalar thetaSq = params.openingAngle * params.openingAngle;
+    Scalar gm = params.doGravity ? params.gravitationalConstant * mass : 0.0f;
+    Scalar kq = params.doElectrostatics ? params.coulombConstant * charge : 0.0f;
+
+    // Attraction towards a mass and repulsion from a like charge
+    auto interact = [&](const Vec2 &massCenter, Scalar otherMass, const Vec2 &chargeCenter, Scalar otherCharge)
+    {
+        if (gm != 0.0f && otherMass != 0.0f)
+        {
+            Vec2 d = massCenter - position;
+            Scalar r2 = d.lengthSquared() + softeningSq;
+            force += d * (gm * otherMass / (r2 * std::sqrt(r2)));
+        }
+        if (kq != 0.0f && otherCharge != 0.0f)
+        {
+            Vec2 d = position - chargeCenter;
+            Scalar r2 = d.lengthSquared() + softeningSq;
+            force += d * (kq * otherCharge / (r2 * std::sqrt(r2)));
+        }
+    };
+
+    int stack[4 * BARNES_HUT_MAX_DEPTH + 4];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const QuadNode &node = nodes[stack[--top]];
+        if (node.mass == 0.0f && node.absCharge == 0.0f)
+            continue;
+
+        if (node.firstChild < 0)
+        {
+            for (int b = node.firstBody; b >= 0; b = nextBody[b])
+            {
+                if (b != self)
+                    interact(positions[b], masses[b], positions[b], charges[b]);
+            }
+            continue;
+        }
+
+        // Far enough away: treat the whole cell as a single body
+        Scalar size = node.halfSize * 2.0f;
+        Scalar distanceSq = (node.center - position).lengthSquared();
+        if (size * size < thetaSq * distanceSq)
+        {
+            interact(node.massCenter, node.mass, node.chargeCenter, node.charge);
+            continue;
+        }
+
+        for (int c = node.firstChild; c < node.firstChild + 4; c++)
+        {
+            stack[top++] = c;
+        }
+    }
+
+    return force;
+}
+
+size_t BarnesHutTree::bodyCount() const
+{
+    return positions.size();
+}
+
+Force NBodyEvaluator::evaluate(const Body &state, int index) const
+{
+    return Force(Vec2(0.0f, 0.0f), tree->evaluate(state.position, state.mass, state.charge, index, params));
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Config.h"
+
+#include <vector>
+#include "math/Vec2.hpp"
+#include "objects/Body.hpp"
+#include "objects/Force.hpp"
+
+// Parameters for pairwise gravitation and electrostatic forces
+struct NBodyParameters
+{
+    bool doGravity = false;                                       // Mutual gravitational attraction
+    bool doElectrostatics = false;                                // Coulomb forces between charged bodies
+    float gravitationalConstant = DEFAULT_GRAVITATIONAL_CONSTANT; // G
+    float coulombConstant = DEFAULT_COULOMB_CONSTANT;             // k
+    float openingAngle = DEFAULT_OPENING_ANGLE;                   // Barnes-Hut theta, 0 gives the exact O(n²) sum
+    float softening = DEFAULT_SOFTENING;                          // Softening length (m) to keep close encounters finite
+};
+
+// Quadtree node, children are stored as four consecutive nodes
+struct QuadNode
+{
+    Vec2 center; // Geometric center of the cell
+    Scalar halfSize;
+
+    int firstChild = -1; // Index of the first child, -1 for leaves
+    int firstBody = -1;  // Head of the body list for leaves
+    int bodyCount = 0;
+
+    Scalar mass = 0.0f;
+    Vec2 massCenter;
+    Scalar charge = 0.0f;
+    Scalar absCharge = 0.0f;
+    Vec2 chargeCenter; // Weighted by |q| so mixed signs stay inside the cell
+};
+
+// Barnes-Hut quadtree over body positions, rebuilt every step and evaluated at any integrator stage
+class BarnesHutTree
+{
+private:
+    std::vector<QuadNode> nodes;
+    std::vector<Vec2> positions;
+    std::vector<Scalar> masses;
+    std::vector<Scalar> charges;
+    std::vector<int> nextBody; // Linked lists of bodies sharing a leaf
+
+    void insert(int node, int body, int depth); // Insert a body below a node
+    void subdivide(int node);                    // Create the four children of a leaf
+    int childFor(int node, const Vec2 &position) const;
+
+public:
+    // Methods
+    void build(const std::vector<const Body *> &bodies); // Rebuild the tree over the given bodies
+
+    // Net force on a body in the given state, skipping the body's own entry (self < 0 skips nothing)
+    Vec2 evaluate(const Vec2 &position, Scalar mass, Scalar charge, int self, const NBodyParameters &params) const;
+
+    size_t bodyCount() const;
+};
+
+// The tree's force on the bodies it was built over, each source indexes its body's entry in the tree
+class NBodyEvaluator : public ForceEvaluator
+{
+public:
+    const BarnesHutTree *tree = nullptr;
+    NBodyParameters params;
+
+    Force evaluate(const Body &state, int index) const override;
+};
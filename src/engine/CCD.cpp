@@ -0,0 +1,245 @@
+#include "CCD.hpp"
+
+#include <cmath>
+#include <limits>
+
+// Rotate into and out of a box's frame
+static inline Vec2 toLocal(const OrientedBox &box, const Vec2 &v)
+{
+    return Vec2(v.x * box.cos + v.y * box.sin, -v.x * box.sin + v.y * box.cos);
+}
+
+static inline Vec2 toWorld(const OrientedBox &box, const Vec2 &v)
+{
+    return Vec2(v.x * box.cos - v.y * box.sin, v.x * box.sin + v.y * box.cos);
+}
+
+// Earliest t in [0, 1] where a point moving along move reaches the given distance from a fixed point
+static bool sweepPointCircle(const Vec2 &offset, const Vec2 &move, Scalar radius, Scalar &t)
+{
+    Scalar a = move.lengthSquared();
+    Scalar b = 2.0f * dot(offset, move);
+    Scalar c = offset.lengthSquared() - radius * radius;
+    if (a == 0.0f || c < 0.0f || b >= 0.0f)
+        return false; // Not moving, already inside or moving away
+
+    Scalar discriminant = b * b - 4.0f * a * c;
+    if (discriminant < 0.0f)
+        return false;
+
+    t = (-b - std::sqrt(discriminant)) / (2.0f * a);
+    return t >= 0.0f && t <= 1.0f;
+}
+
+bool sweepCircleCircle(const Vec2 &startA, const Vec2 &moveA, Scalar radiusA,
+                       const Vec2 &startB, const Vec2 &moveB, Scalar radiusB,
+                       Scalar &toi, CollisionInfo &info)
+{
+    Vec2 offset = startA - startB;
+    Vec2 move = moveA - moveB;
+    if (!sweepPointCircle(offset, move, radiusA + radiusB, toi))
+        return false;
+
+    Vec2 positionB = startB + moveB * toi;
+    info.isColliding = true;
+    info.penetration = 0.0f;
+    info.normal = (offset + move * toi).normalized();
+    info.contact = positionB + info.normal * radiusB;
+    return true;
+}
+
+bool sweepCircleBox(const Vec2 &startA, const Vec2 &moveA, Scalar radiusA,
+                    const OrientedBox &boxB, const Vec2 &moveB,
+                    Scalar &toi, CollisionInfo &info)
+{
+    // Circle motion relative to the box, in the box's frame
+    Vec2 p = toLocal(boxB, startA - boxB.center);
+    Vec2 d = toLocal(boxB, moveA - moveB);
+    Vec2 h = boxB.halfSize;
+
+    Vec2 closest(std::max(-h.x, std::min(p.x, h.x)), std::max(-h.y, std::min(p.y, h.y)));
+    if ((p - closest).lengthSquared() < radiusA * radiusA)
+        return false;
+
+    Scalar best = std::numeric_limits<Scalar>::max();
+    Vec2 localNormal;
+    Vec2 localContact;
+
+    // Faces pushed out by the radius
+    for (int sign = -1; sign <= 1; sign += 2)
+    {
+        if (d.x * sign < 0.0f)
+        {
+            Scalar t = (sign * (h.x + radiusA) - p.x) / d.x;
+            Scalar y = p.y + d.y * t;
+            if (t >= 0.0f && t <= 1.0f && t < best && std::abs(y) <= h.y)
+            {
+                best = t;
+                localNormal = Vec2(static_cast<Scalar>(sign), 0.0f);
+                localContact = Vec2(sign * h.x, y);
+            }
+        }
+        if (d.y * sign < 0.0f)
+        {
+            Scalar t = (sign * (h.y + radiusA) - p.y) / d.y;
+            Scalar x = p.x + d.x * t;
+            if (t >= 0.0f && t <= 1.0f && t < best && std::abs(x) <= h.x)
+            {
+                best = t;
+                localNormal = Vec2(0.0f, static_cast<Scalar>(sign));
+                localContact = Vec2(x, sign * h.y);
+            }
+        }
+    }
+
+    // Rounded corners
+    for (int i = 0; i < 4; i++)
+    {
+        Vec2 corner((i & 1) ? h.x : -h.x, (i & 2) ? h.y : -h.y);
+        Scalar t;
+        if (sweepPointCircle(p - corner, d, radiusA, t) && t < best)
+        {
+            best = t;
+            localNormal = (p + d * t - corner).normalized();
+            localContact = corner;
+        }
+    }
+
+    if (best > 1.0f)
+        return false;
+
+    toi = best;
+    info.isColliding = true;
+    info.penetration = 0.0f;
+    info.normal = toWorld(boxB, localNormal);
+    info.contact = boxB.center + moveB * toi + toWorld(boxB, localContact);
+    return true;
+}
+
+bool sweepBoxBox(const OrientedBox &boxA, const Vec2 &moveA,
+                 const OrientedBox &boxB, const Vec2 &moveB,
+                 Scalar &toi, CollisionInfo &info)
+{
+    const Vec2 axes[4] = {
+        Vec2(boxA.cos, boxA.sin), Vec2(-boxA.sin, boxA.cos),
+        Vec2(boxB.cos, boxB.sin), Vec2(-boxB.sin, boxB.cos)};
+    Vec2 move = moveA - moveB;
+
+    Scalar first = 0.0f;
+    Scalar last = 1.0f;
+    bool separated = false;
+    int firstAxis = 0;
+    Vec2 firstNormal;
+
+    // Swept separating axis test: the boxes touch once every axis's intervals overlap
+    for (int i = 0; i < 4; i++)
+    {
+        const Vec2 &n = axes[i];
+        Scalar radiusA = boxA.halfSize.x * std::abs(dot(axes[0], n)) + boxA.halfSize.y * std::abs(dot(axes[1], n));
+        Scalar radiusB = boxB.halfSize.x * std::abs(dot(axes[2], n)) + boxB.halfSize.y * std::abs(dot(axes[3], n));
+        Scalar centerA = dot(boxA.center, n);
+        Scalar centerB = dot(boxB.center, n);
+        Scalar speed = dot(move, n);
+
+        Scalar gapBelow = (centerB - radiusB) - (centerA + radiusA); // A below B on this axis
+        Scalar gapAbove = (centerA - radiusA) - (centerB + radiusB); // A above B on this axis
+
+        Scalar arrive;
+        Scalar leave;
+        Vec2 normal;
+        if (gapBelow > 0.0f)
+        {
+            if (speed <= 0.0f)
+                return false;
+            arrive = gapBelow / speed;
+            leave = (centerB + radiusB - (centerA - radiusA)) / speed;
+            normal = n * -1.0f;
+            separated = true;
+        }
+        else if (gapAbove > 0.0f)
+        {
+            if (speed >= 0.0f)
+                return false;
+            arrive = gapAbove / -speed;
+            leave = (centerA + radiusA - (centerB - radiusB)) / -speed;
+            normal = n;
+            separated = true;
+        }
+        else
+        {
+            arrive = 0.0f;
+            if (speed > 0.0f)
+                leave = -gapAbove / speed;
+            else if (speed < 0.0f)
+                leave = -gapBelow / -speed;
+            else
+                leave = std::numeric_limits<Scalar>::max();
+        }
+
+        if (arrive > first)
+        {
+            first = arrive;
+            firstAxis = i;
+            firstNormal = normal;
+        }
+        last = std::min(last, leave);
+        if (first > last)
+            return false;
+    }
+
+    if (!separated)
+        return false;
+
+    toi = first;
+    OrientedBox touchingA = boxA;
+    OrientedBox touchingB = boxB;
+    touchingA.center += moveA * toi;
+    touchingB.center += moveB * toi;
+
+    info.isColliding = true;
+    info.penetration = 0.0f;
+    info.normal = firstNormal;
+    info.contact = boxContactPoint(touchingA, touchingB, firstNormal, firstAxis);
+    return true;
+}
+
+bool sweepObjects(const Object *objA, const Vec2 &startA, const Vec2 &moveA,
+                  const Object *objB, const Vec2 &startB, const Vec2 &moveB,
+                  Scalar &toi, CollisionInfo &info)
+{
+    auto boxAt = [](const Object *rect, const Vec2 &center)
+    {
+        OrientedBox box = makeBox(rect);
+        box.center = center;
+        return box;
+    };
+
+    if (objA->shapeType == CIRCLE && objB->shapeType == CIRCLE)
+    {
+        return sweepCircleCircle(startA, moveA, objA->dimensions.x, startB, moveB, objB->dimensions.x, toi, info);
+    }
+    else if (objA->shapeType == RECTANGLE && objB->shapeType == RECTANGLE)
+    {
+        return sweepBoxBox(boxAt(objA, startA), moveA, boxAt(objB, startB), moveB, toi, info);
+    }
+    else if (objA->shapeType == CIRCLE && objB->shapeType == RECTANGLE)
+    {
+        return sweepCircleBox(startA, moveA, objA->dimensions.x, boxAt(objB, startB), moveB, toi, info);
+    }
+    else if (objA->shapeType == RECTANGLE && objB->shapeType == CIRCLE)
+    {
+        if (!sweepCircleBox(startB, moveB, objB->dimensions.x, boxAt(objA, startA), moveA, toi, info))
+            return false;
+        // Invert normal for correct direction
+        info.normal *= -1.0f;
+        return true;
+    }
+    return false;
+}
+
+bool needsContinuous(const Object *object, Scalar dt)
+{
+    Scalar extent = object->shapeType == CIRCLE ? object->dimensions.x : std::min(object->dimensions.x, object->dimensions.y) * 0.5f;
+    Scalar travel = object->body->velocity.length() * dt;
+    return travel > extent * CCD_SPEED_RATIO;
+}
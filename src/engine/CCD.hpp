@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Config.h"
+
+#include "engine/Collision.hpp"
+
+// Swept time-of-impact tests, shapes translate linearly over the step and keep their orientation.
+// Each returns true with toi in [0, 1] as a fraction of the motion when the shapes first touch,
+// info then holds the contact at that time with the normal pointing from B to A.
+// Pairs that already overlap at the start are left to the discrete tests.
+
+bool sweepCircleCircle(const Vec2 &startA, const Vec2 &moveA, Scalar radiusA,
+                       const Vec2 &startB, const Vec2 &moveB, Scalar radiusB,
+                       Scalar &toi, CollisionInfo &info);
+
+bool sweepCircleBox(const Vec2 &startA, const Vec2 &moveA, Scalar radiusA,
+                    const OrientedBox &boxB, const Vec2 &moveB,
+                    Scalar &toi, CollisionInfo &info);
+
+bool sweepBoxBox(const OrientedBox &boxA, const Vec2 &moveA,
+                 const OrientedBox &boxB, const Vec2 &moveB,
+                 Scalar &toi, CollisionInfo &info);
+
+// Shape dispatch, the objects' bodies only supply orientation
+bool sweepObjects(const Object *objA, const Vec2 &startA, const Vec2 &moveA,
+                  const Object *objB, const Vec2 &startB, const Vec2 &moveB,
+                  Scalar &toi, CollisionInfo &info);
+
+// Whether a body moves far enough in one step to tunnel through thin shapes
+bool needsContinuous(const Object *object, Scalar dt);
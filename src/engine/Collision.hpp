@@ -1,7 +1,8 @@
 #pragma once
 
-#include <iostream>
+#include <vector>
 #include <fmt/format.h>
+#include "engine/Log.hpp"
 #include "math/Vec2.hpp"
 #include "objects/Object.hpp"
 
@@ -9,75 +10,240 @@
 struct CollisionInfo
 {
     bool isColliding;
-    Vec2 normal;       // Direction to push objects apart
-    float penetration; // How deep the overlap is
+    Vec2 normal;        // Direction to push objects apart
+    Scalar penetration; // How deep the overlap is
+    Vec2 contact;       // World-space contact point
+};
+
+// Oriented box in world space
+struct OrientedBox
+{
+    Vec2 center;
+    Vec2 halfSize;
+    Scalar cos;
+    Scalar sin;
+};
+
+inline OrientedBox makeBox(const Object *rect)
+{
+    return OrientedBox{rect->body->position, rect->dimensions * 0.5f, std::cos(rect->body->angle), std::sin(rect->body->angle)};
+}
+
+// Separating-axis test between two oriented boxes on their four face axes.
+// Written as straight-line arithmetic with selects instead of branches so a loop over a batch can vectorize.
+// overlap > 0 means the boxes intersect, the normal points from B to A and axis is 0-1 for A's faces, 2-3 for B's.
+inline void satBoxBox(Scalar acx, Scalar acy, Scalar ahx, Scalar ahy, Scalar ac, Scalar as,
+                      Scalar bcx, Scalar bcy, Scalar bhx, Scalar bhy, Scalar bc, Scalar bs,
+                      Scalar &overlap, Scalar &nx, Scalar &ny, int &axis)
+{
+    Scalar dx = acx - bcx;
+    Scalar dy = acy - bcy;
+
+    // Rotation of B relative to A
+    Scalar c00 = std::abs(ac * bc + as * bs);
+    Scalar c01 = std::abs(-ac * bs + as * bc);
+    Scalar c10 = std::abs(-as * bc + ac * bs);
+    Scalar c11 = std::abs(as * bs + ac * bc);
+
+    // Center offset along each axis
+    Scalar da0 = dx * ac + dy * as;
+    Scalar da1 = -dx * as + dy * ac;
+    Scalar db0 = dx * bc + dy * bs;
+    Scalar db1 = -dx * bs + dy * bc;
+
+    Scalar o0 = ahx + bhx * c00 + bhy * c01 - std::abs(da0);
+    Scalar o1 = ahy + bhx * c10 + bhy * c11 - std::abs(da1);
+    Scalar o2 = bhx + ahx * c00 + ahy * c10 - std::abs(db0);
+    Scalar o3 = bhy + ahx * c01 + ahy * c11 - std::abs(db1);
+
+    // Minimum overlap axis
+    Scalar ax = ac, ay = as, d = da0;
+    overlap = o0;
+    axis = 0;
+    bool pick = o1 < overlap;
+    overlap = pick ? o1 : overlap;
+    ax = pick ? -as : ax;
+    ay = pick ? ac : ay;
+    d = pick ? da1 : d;
+    axis = pick ? 1 : axis;
+    pick = o2 < overlap;
+    overlap = pick ? o2 : overlap;
+    ax = pick ? bc : ax;
+    ay = pick ? bs : ay;
+    d = pick ? db0 : d;
+    axis = pick ? 2 : axis;
+    pick = o3 < overlap;
+    overlap = pick ? o3 : overlap;
+    ax = pick ? -bs : ax;
+    ay = pick ? bc : ay;
+    d = pick ? db1 : d;
+    axis = pick ? 3 : axis;
+
+    Scalar sign = d >= 0 ? 1.0f : -1.0f;
+    nx = ax * sign;
+    ny = ay * sign;
+}
+
+// Contact point of two intersecting boxes: the incident box's deepest vertices, averaged when a face lies flat
+inline Vec2 boxContactPoint(const OrientedBox &boxA, const OrientedBox &boxB, const Vec2 &normal, int axis)
+{
+    // The reference face belongs to A for axes 0-1, so B's vertices penetrate A along +normal
+    const OrientedBox &incident = axis < 2 ? boxB : boxA;
+    Vec2 direction = axis < 2 ? normal : normal * -1.0f;
+
+    Vec2 u(incident.cos, incident.sin);
+    Vec2 v(-incident.sin, incident.cos);
+    Vec2 corners[4] = {
+        incident.center + u * incident.halfSize.x + v * incident.halfSize.y,
+        incident.center - u * incident.halfSize.x + v * incident.halfSize.y,
+        incident.center - u * incident.halfSize.x - v * incident.halfSize.y,
+        incident.center + u * incident.halfSize.x - v * incident.halfSize.y,
+    };
+
+    Scalar deepest = dot(corners[0], direction);
+    for (int i = 1; i < 4; i++)
+    {
+        deepest = std::max(deepest, dot(corners[i], direction));
+    }
+
+    Scalar tolerance = 0.02f * std::min(incident.halfSize.x, incident.halfSize.y);
+    Vec2 contact;
+    int count = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        if (dot(corners[i], direction) >= deepest - tolerance)
+        {
+            contact += corners[i];
+            count++;
+        }
+    }
+    return contact / static_cast<Scalar>(count);
+}
+
+// Structure-of-arrays batch of box pairs for the SAT narrowphase
+struct BoxPairBatch
+{
+    std::vector<Scalar> acx, acy, ahx, ahy, ac, as;
+    std::vector<Scalar> bcx, bcy, bhx, bhy, bc, bs;
+    std::vector<Scalar> overlap, nx, ny;
+    std::vector<int> axis;
+
+    void clear()
+    {
+        for (std::vector<Scalar> *lane : {&acx, &acy, &ahx, &ahy, &ac, &as, &bcx, &bcy, &bhx, &bhy, &bc, &bs})
+        {
+            lane->clear();
+        }
+    }
+
+    void push(const OrientedBox &a, const OrientedBox &b)
+    {
+        acx.push_back(a.center.x);
+        acy.push_back(a.center.y);
+        ahx.push_back(a.halfSize.x);
+        ahy.push_back(a.halfSize.y);
+        ac.push_back(a.cos);
+        as.push_back(a.sin);
+        bcx.push_back(b.center.x);
+        bcy.push_back(b.center.y);
+        bhx.push_back(b.halfSize.x);
+        bhy.push_back(b.halfSize.y);
+        bc.push_back(b.cos);
+        bs.push_back(b.sin);
+    }
+
+    size_t size() const
+    {
+        return acx.size();
+    }
+
+    // Boxes of pair k as pushed, so later passes need not rebuild them from the objects
+    OrientedBox boxA(size_t k) const
+    {
+        return OrientedBox{Vec2(acx[k], acy[k]), Vec2(ahx[k], ahy[k]), ac[k], as[k]};
+    }
+
+    OrientedBox boxB(size_t k) const
+    {
+        return OrientedBox{Vec2(bcx[k], bcy[k]), Vec2(bhx[k], bhy[k]), bc[k], bs[k]};
+    }
+
+    // Test every pair in one pass
+    void run()
+    {
+        size_t count = size();
+        overlap.resize(count);
+        nx.resize(count);
+        ny.resize(count);
+        axis.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            satBoxBox(acx[i], acy[i], ahx[i], ahy[i], ac[i], as[i],
+                      bcx[i], bcy[i], bhx[i], bhy[i], bc[i], bs[i],
+                      overlap[i], nx[i], ny[i], axis[i]);
+        }
+    }
 };
 
 // Circle-Circle collision detection
-CollisionInfo checkCircleCircleCollision(Object *objA, Object *objB)
+inline CollisionInfo checkCircleCircleCollision(Object *objA, Object *objB)
 {
     CollisionInfo info;
     info.isColliding = false;
 
     Vec2 diff = objA->body->position - objB->body->position;
-    float distance = diff.length();
-    float radiusSum = objA->dimensions.x + objB->dimensions.x;
+    Scalar distance = diff.length();
+    Scalar radiusSum = objA->dimensions.x + objB->dimensions.x;
 
     if (distance < radiusSum)
     {
         info.isColliding = true;
         info.penetration = radiusSum - distance;
         info.normal = (distance > 0.0f) ? diff.normalized() : Vec2(1.0f, 0.0f);
+        info.contact = objB->body->position + info.normal * objB->dimensions.x;
     }
 
     return info;
 }
 
-// Rectangle-Rectangle collision detection
-CollisionInfo checkRectRectCollision(Object *objA, Object *objB)
+// Oriented Rectangle-Rectangle collision detection
+inline CollisionInfo checkRectRectCollision(Object *objA, Object *objB)
 {
     CollisionInfo info;
     info.isColliding = false;
 
-    Vec2 halfSizeA = objA->dimensions * 0.5f;
-    Vec2 halfSizeB = objB->dimensions * 0.5f;
+    OrientedBox boxA = makeBox(objA);
+    OrientedBox boxB = makeBox(objB);
 
-    Vec2 diff = objA->body->position - objB->body->position;
+    Scalar overlap, nx, ny;
+    int axis;
+    satBoxBox(boxA.center.x, boxA.center.y, boxA.halfSize.x, boxA.halfSize.y, boxA.cos, boxA.sin,
+              boxB.center.x, boxB.center.y, boxB.halfSize.x, boxB.halfSize.y, boxB.cos, boxB.sin,
+              overlap, nx, ny, axis);
 
-    // Calculate overlap on each axis
-    float overlapX = (halfSizeA.x + halfSizeB.x) - std::abs(diff.x);
-    float overlapY = (halfSizeA.y + halfSizeB.y) - std::abs(diff.y);
-
-    if (overlapX > 0 && overlapY > 0)
+    if (overlap > 0)
     {
         info.isColliding = true;
 
-        std::cout << diff.toString() << std::endl;
+        LOG_TRACE(LOG_COLLISION, "box contact, offset {}", (objA->body->position - objB->body->position).toString());
 
-        // Choose the axis with smallest overlap (minimum penetration)
-        if (overlapX < overlapY)
-        {
-            info.penetration = overlapX;
-            info.normal = Vec2(diff.x > 0 ? 1.0f : -1.0f, 0.0f);
-        }
-        else
-        {
-            info.penetration = overlapY;
-            info.normal = Vec2(0.0f, diff.y > 0 ? 1.0f : -1.0f);
-        }
+        info.penetration = overlap;
+        info.normal = Vec2(nx, ny);
+        info.contact = boxContactPoint(boxA, boxB, info.normal, axis);
     }
 
     return info;
 }
 
-// Circle-Rectangle collision detection
-CollisionInfo checkCircleRectCollision(Object *circle, Object *rect)
+// Oriented Circle-Rectangle collision detection, solved in the rectangle's local frame
+inline CollisionInfo checkCircleRectCollision(Object *circle, Object *rect)
 {
     CollisionInfo info;
     info.isColliding = false;
 
+    Scalar angle = rect->body->angle;
     Vec2 halfSize = rect->dimensions * 0.5f;
-    Vec2 diff = circle->body->position - rect->body->position;
+    Vec2 diff = (circle->body->position - rect->body->position).rotated(-angle);
 
     // Find closest point on rectangle to circle center
     Vec2 closest;
@@ -86,18 +252,19 @@ CollisionInfo checkCircleRectCollision(Object *circle, Object *rect)
 
     // Calculate vector from closest point to circle center
     Vec2 delta = diff - closest;
-    float distSquared = delta.lengthSquared();
-    float radius = circle->dimensions.x;
+    Scalar distSquared = delta.lengthSquared();
+    Scalar radius = circle->dimensions.x;
 
     if (distSquared < radius * radius)
     {
         info.isColliding = true;
-        float dist = std::sqrt(distSquared);
+        Scalar dist = std::sqrt(distSquared);
+        Vec2 localNormal;
 
         if (dist > 0.0f)
         {
             info.penetration = radius - dist;
-            info.normal = delta.normalized();
+            localNormal = delta.normalized();
         }
         else
         {
@@ -106,25 +273,28 @@ CollisionInfo checkCircleRectCollision(Object *circle, Object *rect)
             if (halfSize.x - absClosest.x < halfSize.y - absClosest.y)
             {
                 info.penetration = radius + (halfSize.x - absClosest.x);
-                info.normal = Vec2(diff.x > 0 ? 1.0f : -1.0f, 0.0f);
+                localNormal = Vec2(diff.x > 0 ? 1.0f : -1.0f, 0.0f);
             }
             else
             {
                 info.penetration = radius + (halfSize.y - absClosest.y);
-                info.normal = Vec2(0.0f, diff.y > 0 ? 1.0f : -1.0f);
+                localNormal = Vec2(0.0f, diff.y > 0 ? 1.0f : -1.0f);
             }
         }
+
+        info.normal = localNormal.rotated(angle);
+        info.contact = rect->body->position + closest.rotated(angle);
     }
 
     return info;
 }
 
 // General Collision detection
-CollisionInfo checkCollision(Object *objA, Object *objB)
+inline CollisionInfo checkCollision(Object *objA, Object *objB)
 {
     if (objA->isGrabbed || objB->isGrabbed)
     {
-        return CollisionInfo{false, Vec2(0, 0), 0.0f};
+        return CollisionInfo{false, Vec2(0, 0), 0.0f, Vec2(0, 0)};
     }
 
     if (objA->shapeType == CIRCLE && objB->shapeType == CIRCLE)
@@ -146,11 +316,12 @@ CollisionInfo checkCollision(Object *objA, Object *objB)
         info.normal *= -1.0f;
         return info;
     }
-    return CollisionInfo{false, Vec2(0, 0), 0.0f};
+    return CollisionInfo{false, Vec2(0, 0), 0.0f, Vec2(0, 0)};
 }
 
-// Calculate and apply normal and friction forces based on collision info
-void resolveCollision(Object *objA, Object *objB, const CollisionInfo &info, float dt)
+// Calculate and apply normal and friction forces based on collision info.
+// Extra contact iterations pass correctPosition = false to only refine the impulse.
+inline void resolveCollision(Object *objA, Object *objB, const CollisionInfo &info, Scalar dt, bool correctPosition = true)
 {
     // Don't resolve collision if both objects are static
     if (objA->isStatic && objB->isStatic)
@@ -161,38 +332,53 @@ void resolveCollision(Object *objA, Object *objB, const CollisionInfo &info, flo
     Body *bodyA = objA->body;
     Body *bodyB = objB->body;
 
-    // Calculate inverse masses (0 for static objects)
-    float invMassA = objA->isStatic ? 0.0f : bodyA->invMass;
-    float invMassB = objB->isStatic ? 0.0f : bodyB->invMass;
-    float invMassSum = invMassA + invMassB;
+    // Calculate inverse masses and inertias (0 for static objects)
+    Scalar invMassA = objA->isStatic ? 0.0f : bodyA->invMass;
+    Scalar invMassB = objB->isStatic ? 0.0f : bodyB->invMass;
+    Scalar invMassSum = invMassA + invMassB;
+    Scalar invInertiaA = objA->isStatic ? 0.0f : bodyA->invInertia;
+    Scalar invInertiaB = objB->isStatic ? 0.0f : bodyB->invInertia;
+
+    // Lever arms from each center to the contact point
+    Vec2 rA = info.contact - bodyA->position;
+    Vec2 rB = info.contact - bodyB->position;
 
     // Positional correction to avoid sinking
-    const float percent = 0.8f; // Penetration percentage to correct
-    const float slop = 0.01f;   // Penetration allowance
-    Vec2 correction = info.normal * (std::max(info.penetration - slop, 0.0f) / invMassSum) * percent * -1;
-    if (!objA->isStatic)
-        bodyA->position -= correction * invMassA;
-    if (!objB->isStatic)
-        bodyB->position += correction * invMassB;
-
-    // Calculate and apply impulse
-    Vec2 relativeVelocity = bodyB->velocity - bodyA->velocity;
-    float restitution = std::min(bodyA->restitution, bodyB->restitution);
-
-    float vNormalMag = dot(relativeVelocity, info.normal);
+    if (correctPosition)
+    {
+        Vec2 correction = info.normal * (std::max<Scalar>(info.penetration - CONTACT_SLOP, 0.0f) / invMassSum) * CONTACT_CORRECTION * -1;
+        if (!objA->isStatic)
+            bodyA->position -= correction * invMassA;
+        if (!objB->isStatic)
+            bodyB->position += correction * invMassB;
+    }
+
+    // Calculate and apply impulse at the contact point
+    Vec2 relativeVelocity = (bodyB->velocity + cross(bodyB->angularVelocity, rB)) - (bodyA->velocity + cross(bodyA->angularVelocity, rA));
+    Scalar restitution = std::min(bodyA->restitution, bodyB->restitution);
+
+    Scalar vNormalMag = dot(relativeVelocity, info.normal);
     if (vNormalMag < 0)
         return; // Objects are separating
-    if (std::abs(vNormalMag) < 0.01f)
+    if (std::abs(vNormalMag) < CONTACT_MIN_SPEED)
         return; // Negligible collision
 
-    float impulseMagnitude = -(1.0f + restitution) * vNormalMag / invMassSum;
+    Scalar rAxN = cross(rA, info.normal);
+    Scalar rBxN = cross(rB, info.normal);
+    Scalar effectiveMass = invMassSum + rAxN * rAxN * invInertiaA + rBxN * rBxN * invInertiaB;
+
+    Scalar impulseMagnitude = -(1.0f + restitution) * vNormalMag / effectiveMass;
     Vec2 impulse = info.normal * impulseMagnitude;
 
     bodyA->velocity -= impulse * invMassA;
     bodyB->velocity += impulse * invMassB;
+    bodyA->angularVelocity -= cross(rA, impulse) * invInertiaA;
+    bodyB->angularVelocity += cross(rB, impulse) * invInertiaB;
 
     // Apply normal force
     // TODO: convert to variable force sources
+    if (!correctPosition)
+        return;
     Vec2 fNormal = info.normal * dot(bodyA->netForce - bodyB->netForce, info.normal) * -1;
     objA->applyForce(ForceSource(fmt::format("normal%d", objB->getID()), Force(Vec2(0, 0), fNormal)));
     objB->applyForce(ForceSource(fmt::format("normal%d", objA->getID()), Force(Vec2(0, 0), fNormal * -1)));
@@ -0,0 +1,458 @@
+#include "Fluid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "engine/Collision.hpp"
+#include "engine/ThreadPool.hpp"
+
+// Poly6 density sum over one contiguous run of neighbors, without the kernel's constant factor.
+// Out-of-range neighbors contribute zero through the max, so the loop has no branches and vectorizes;
+// the file is built with reassociation allowed so the sum can be split across vector lanes.
+static Scalar densitySum(Scalar x, Scalar y, const Scalar *__restrict px, const Scalar *__restrict py, size_t count, Scalar h2)
+{
+    Scalar sum = 0.0f;
+    for (size_t j = 0; j < count; j++)
+    {
+        Scalar dx = x - px[j];
+        Scalar dy = y - py[j];
+        Scalar q = std::max(h2 - dx * dx - dy * dy, Scalar(0));
+        sum += q * q * q;
+    }
+    return sum;
+}
+
+// Sums of the spiky pressure gradient and the viscosity Laplacian, without their constant factors
+struct ForceSums
+{
+    Scalar pressureX = 0.0f;
+    Scalar pressureY = 0.0f;
+    Scalar viscosityX = 0.0f;
+    Scalar viscosityY = 0.0f;
+};
+
+// Same layout as densitySum. The particle itself needs no masking: its offset and relative velocity are zero.
+static void forceSums(Scalar x, Scalar y, Scalar vx, Scalar vy, Scalar pressure,
+                      const Scalar *__restrict px, const Scalar *__restrict py, const Scalar *__restrict pvx, const Scalar *__restrict pvy,
+                      const Scalar *__restrict pp, const Scalar *__restrict rho, size_t count, Scalar h, ForceSums &sums)
+{
+    const Scalar tiny = FLUID_SPACING * 1e-3f;
+    Scalar pressureX = 0.0f, pressureY = 0.0f, viscosityX = 0.0f, viscosityY = 0.0f;
+    for (size_t j = 0; j < count; j++)
+    {
+        Scalar dx = x - px[j];
+        Scalar dy = y - py[j];
+        Scalar r = std::sqrt(dx * dx + dy * dy);
+        Scalar q = std::max(h - r, Scalar(0));
+        Scalar s = (pressure + pp[j]) * q * q / std::max(r, tiny);
+        pressureX += s * dx;
+        pressureY += s * dy;
+        Scalar t = q / rho[j];
+        viscosityX += t * (pvx[j] - vx);
+        viscosityY += t * (pvy[j] - vy);
+    }
+    sums.pressureX += pressureX;
+    sums.pressureY += pressureY;
+    sums.viscosityX += viscosityX;
+    sums.viscosityY += viscosityY;
+}
+
+// Penalty acceleration along a surface's normal on a particle at a distance from it, moving away at a speed
+static Scalar boundaryPush(Scalar distance, Scalar separation)
+{
+    const Scalar radius = FLUID_SPACING / 2;
+    if (distance >= radius)
+        return 0.0f;
+    return std::max(FLUID_BOUNDARY_STIFFNESS * (radius - distance) - FLUID_BOUNDARY_DAMPING * separation, Scalar(0));
+}
+
+FluidSystem::FluidSystem(const Vec2 &min, const Vec2 &max) : origin(min), bound(max)
+{
+    columns = std::max(1, static_cast<int>(std::ceil((max.x - min.x) / FLUID_SMOOTHING_RADIUS)));
+    rows = std::max(1, static_cast<int>(std::ceil((max.y - min.y) / FLUID_SMOOTHING_RADIUS)));
+    particleMass = FLUID_REST_DENSITY * FLUID_SPACING * FLUID_SPACING;
+
+    // Calibrate the density so a particle at rest spacing has exactly the rest density
+    Scalar h2 = FLUID_SMOOTHING_RADIUS * FLUID_SMOOTHING_RADIUS;
+    int reach = static_cast<int>(std::ceil(FLUID_SMOOTHING_RADIUS / FLUID_SPACING));
+    for (int y = -reach; y <= reach; y++)
+    {
+        for (int x = -reach; x <= reach; x++)
+        {
+            Scalar q = std::max(h2 - (x * x + y * y) * FLUID_SPACING * FLUID_SPACING, Scalar(0));
+            restSum += q * q * q;
+        }
+    }
+}
+
+int FluidSystem::cellX(Scalar x) const
+{
+    return std::clamp(static_cast<int>(std::floor((x - origin.x) / FLUID_SMOOTHING_RADIUS)), 0, columns - 1);
+}
+
+int FluidSystem::cellY(Scalar y) const
+{
+    return std::clamp(static_cast<int>(std::floor((y - origin.y) / FLUID_SMOOTHING_RADIUS)), 0, rows - 1);
+}
+
+bool FluidSystem::addParticle(const Vec2 &position, const Vec2 &velocity)
+{
+    if (positionX.size() >= FLUID_MAX_PARTICLES)
+        return false;
+
+    positionX.push_back(std::clamp(position.x, origin.x, bound.x));
+    positionY.push_back(std::clamp(position.y, origin.y, bound.y));
+    velocityX.push_back(velocity.x);
+    velocityY.push_back(velocity.y);
+    return true;
+}
+
+void FluidSystem::addBlock(const Vec2 &min, const Vec2 &max)
+{
+    for (Scalar y = min.y + FLUID_SPACING / 2; y < max.y; y += FLUID_SPACING)
+    {
+        for (Scalar x = min.x + FLUID_SPACING / 2; x < max.x; x += FLUID_SPACING)
+        {
+            if (!addParticle(Vec2(x, y), Vec2(0.0f, 0.0f)))
+                return;
+        }
+    }
+}
+
+void FluidSystem::clear()
+{
+    positionX.clear();
+    positionY.clear();
+    velocityX.clear();
+    velocityY.clear();
+}
+
+void FluidSystem::setEmitter(const Vec2 &center, Scalar radius, Scalar rate)
+{
+    emitting = true;
+    emitterCenter = center;
+    emitterRadius = radius;
+    emitterRate = rate;
+}
+
+void FluidSystem::stopEmitter()
+{
+    emitting = false;
+    emitterBacklog = 0.0f;
+}
+
+bool FluidSystem::isActive() const
+{
+    return emitting || !positionX.empty();
+}
+
+size_t FluidSystem::size() const
+{
+    return positionX.size();
+}
+
+void FluidSystem::emit(Scalar dt)
+{
+    if (!emitting)
+        return;
+
+    // Uniform over the disc, the pressure pass spreads out particles that land too close
+    std::uniform_real_distribution<Scalar> unit(0.0f, 1.0f);
+    emitterBacklog += emitterRate * dt;
+    while (emitterBacklog >= 1.0f)
+    {
+        emitterBacklog -= 1.0f;
+        Scalar angle = static_cast<Scalar>(2.0 * M_PI) * unit(random);
+        Scalar distance = emitterRadius * std::sqrt(unit(random));
+        Vec2 offset(distance * std::cos(angle), distance * std::sin(angle));
+        if (!addParticle(emitterCenter + offset, Vec2(0.0f, 0.0f)))
+        {
+            emitterBacklog = 0.0f;
+            break;
+        }
+    }
+}
+
+void FluidSystem::step(Scalar dt, const Vec2 &gravity, const std::vector<Object *> &objects, std::vector<Vec2> &forces, std::vector<Scalar> &torques)
+{
+    forces.assign(objects.size(), Vec2(0.0f, 0.0f));
+    torques.assign(objects.size(), 0.0f);
+
+    emit(dt);
+    if (positionX.empty())
+        return;
+
+    int substeps = std::max(1, static_cast<int>(std::ceil(dt / FLUID_MAX_SUBSTEP)));
+    Scalar h = dt / substeps;
+    for (int s = 0; s < substeps; s++)
+    {
+        rebuild();
+        computeDensity();
+        computeForces(gravity);
+        couple(objects, 1.0f / substeps, forces, torques);
+        integrate(h);
+    }
+}
+
+void FluidSystem::rebuild()
+{
+    size_t count = positionX.size();
+    size_t cells = static_cast<size_t>(columns) * rows;
+    cellOf.resize(count);
+    cellStart.assign(cells + 1, 0);
+
+    // Counting sort by cell, stable so a nearly sorted order from the last step stays cheap to permute
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t cell = static_cast<uint32_t>(cellY(positionY[i]) * columns + cellX(positionX[i]));
+        cellOf[i] = cell;
+        cellStart[cell + 1]++;
+    }
+    for (size_t c = 1; c <= cells; c++)
+    {
+        cellStart[c] += cellStart[c - 1];
+    }
+
+    sortScratch.assign(cellStart.begin(), cellStart.end() - 1);
+    std::vector<uint32_t> &order = cellOf; // Reused in place: the sorted position of each particle
+    for (size_t i = 0; i < count; i++)
+    {
+        order[i] = sortScratch[cellOf[i]]++;
+    }
+
+    permuteScratch.resize(count);
+    for (std::vector<Scalar> *lane : {&positionX, &positionY, &velocityX, &velocityY})
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            permuteScratch[order[i]] = (*lane)[i];
+        }
+        lane->swap(permuteScratch);
+    }
+
+    density.resize(count);
+    pressureTerm.resize(count);
+    accelerationX.resize(count);
+    accelerationY.resize(count);
+}
+
+void FluidSystem::computeDensity()
+{
+    const Scalar *px = positionX.data();
+    const Scalar *py = positionY.data();
+    Scalar h2 = FLUID_SMOOTHING_RADIUS * FLUID_SMOOTHING_RADIUS;
+    Scalar scale = FLUID_REST_DENSITY / restSum;
+
+    ThreadPool::shared().parallelFor(positionX.size(), [this, px, py, h2, scale](size_t begin, size_t end)
+                                     {
+        for (size_t i = begin; i < end; i++)
+        {
+            // The three cells of a row are consecutive, so their particles are one run
+            int cx = cellX(px[i]), cy = cellY(py[i]);
+            int x0 = std::max(cx - 1, 0), x1 = std::min(cx + 1, columns - 1);
+            Scalar sum = 0.0f;
+            for (int row = std::max(cy - 1, 0); row <= std::min(cy + 1, rows - 1); row++)
+            {
+                uint32_t first = cellStart[row * columns + x0];
+                uint32_t last = cellStart[row * columns + x1 + 1];
+                sum += densitySum(px[i], py[i], px + first, py + first, last - first, h2);
+            }
+
+            Scalar rho = sum * scale;
+            Scalar pressure = FLUID_STIFFNESS * std::max<Scalar>(rho / FLUID_REST_DENSITY - 1.0f, 0.0f);
+            density[i] = rho;
+            pressureTerm[i] = pressure / (rho * rho);
+        } }, PARALLEL_MIN_CHUNK);
+}
+
+void FluidSystem::computeForces(const Vec2 &gravity)
+{
+    const Scalar h = FLUID_SMOOTHING_RADIUS;
+    const Scalar h5 = h * h * h * h * h;
+    // Spiky gradient -30/(πh⁵)·(h-r)²·r̂ and viscosity Laplacian 40/(πh⁵)·(h-r), in 2D
+    Scalar pressureScale = particleMass * 30.0f / (static_cast<Scalar>(M_PI) * h5);
+    Scalar viscosityScale = FLUID_VISCOSITY * particleMass * 40.0f / (static_cast<Scalar>(M_PI) * h5);
+
+    ThreadPool::shared().parallelFor(positionX.size(), [this, h, pressureScale, viscosityScale, gravity](size_t begin, size_t end)
+                                     {
+        const Scalar *px = positionX.data(), *py = positionY.data();
+        const Scalar *vx = velocityX.data(), *vy = velocityY.data();
+        const Scalar *pp = pressureTerm.data(), *rho = density.data();
+        for (size_t i = begin; i < end; i++)
+        {
+            int cx = cellX(px[i]), cy = cellY(py[i]);
+            int x0 = std::max(cx - 1, 0), x1 = std::min(cx + 1, columns - 1);
+            ForceSums sums;
+            for (int row = std::max(cy - 1, 0); row <= std::min(cy + 1, rows - 1); row++)
+            {
+                uint32_t first = cellStart[row * columns + x0];
+                uint32_t last = cellStart[row * columns + x1 + 1];
+                forceSums(px[i], py[i], vx[i], vy[i], pp[i], px + first, py + first, vx + first, vy + first, pp + first, rho + first, last - first, h, sums);
+            }
+
+            // The world bounds push like object surfaces, so particles never pile up where they are clamped
+            Scalar boundsX = boundaryPush(px[i] - origin.x, vx[i]) - boundaryPush(bound.x - px[i], -vx[i]);
+            Scalar boundsY = boundaryPush(py[i] - origin.y, vy[i]) - boundaryPush(bound.y - py[i], -vy[i]);
+
+            accelerationX[i] = pressureScale * sums.pressureX + viscosityScale * sums.viscosityX / rho[i] + gravity.x + boundsX;
+            accelerationY[i] = pressureScale * sums.pressureY + viscosityScale * sums.viscosityY / rho[i] + gravity.y + boundsY;
+        } }, PARALLEL_MIN_CHUNK);
+}
+
+void FluidSystem::couple(const std::vector<Object *> &objects, Scalar weight, std::vector<Vec2> &forces, std::vector<Scalar> &torques)
+{
+    const Scalar radius = FLUID_SPACING / 2;
+    for (size_t o = 0; o < objects.size(); o++)
+    {
+        Object *object = objects[o];
+        const Body *body = object->body;
+        bool reacts = !object->isStatic && !object->isGrabbed;
+        bool isCircle = object->shapeType == CIRCLE;
+        OrientedBox box = makeBox(object);
+
+        Vec2 min, max;
+        object->getBounds(min, max);
+        int x0 = cellX(min.x - radius), x1 = cellX(max.x + radius);
+        int y0 = cellY(min.y - radius), y1 = cellY(max.y + radius);
+
+        Vec2 force;
+        Scalar torque = 0.0f;
+        for (int row = y0; row <= y1; row++)
+        {
+            for (uint32_t k = cellStart[row * columns + x0]; k < cellStart[row * columns + x1 + 1]; k++)
+            {
+                Scalar dx = positionX[k] - body->position.x;
+                Scalar dy = positionY[k] - body->position.y;
+
+                // Signed distance from the object's surface and the outward normal there
+                Scalar distance, nx, ny;
+                if (isCircle)
+                {
+                    Scalar r = std::sqrt(dx * dx + dy * dy);
+                    distance = r - object->dimensions.x;
+                    if (distance >= radius)
+                        continue;
+                    nx = r > 0.0f ? dx / r : 0.0f;
+                    ny = r > 0.0f ? dy / r : -1.0f;
+                }
+                else
+                {
+                    Scalar lx = dx * box.cos + dy * box.sin;
+                    Scalar ly = -dx * box.sin + dy * box.cos;
+                    Scalar ex = std::abs(lx) - box.halfSize.x;
+                    Scalar ey = std::abs(ly) - box.halfSize.y;
+                    Scalar localX, localY;
+                    if (ex > 0.0f || ey > 0.0f)
+                    {
+                        Scalar ox = std::max(ex, Scalar(0)), oy = std::max(ey, Scalar(0));
+                        distance = std::sqrt(ox * ox + oy * oy);
+                        if (distance >= radius)
+                            continue;
+                        localX = std::copysign(ox / distance, lx);
+                        localY = std::copysign(oy / distance, ly);
+                    }
+                    else
+                    {
+                        // Inside, leave through the nearest face
+                        distance = std::max(ex, ey);
+                        localX = ex > ey ? std::copysign(Scalar(1), lx) : 0.0f;
+                        localY = ex > ey ? 0.0f : std::copysign(Scalar(1), ly);
+                    }
+                    nx = localX * box.cos - localY * box.sin;
+                    ny = localX * box.sin + localY * box.cos;
+                }
+
+                // Damped on the speed relative to the moving surface
+                Scalar surfaceVX = body->velocity.x - body->angularVelocity * dy;
+                Scalar surfaceVY = body->velocity.y + body->angularVelocity * dx;
+                Scalar separation = (velocityX[k] - surfaceVX) * nx + (velocityY[k] - surfaceVY) * ny;
+                Scalar push = boundaryPush(distance, separation);
+                accelerationX[k] += push * nx;
+                accelerationY[k] += push * ny;
+
+                if (reacts)
+                {
+                    Vec2 reaction(-push * nx * particleMass, -push * ny * particleMass);
+                    force += reaction;
+                    torque += cross(Vec2(dx, dy), reaction);
+                }
+            }
+        }
+
+        if (reacts)
+        {
+            forces[o] += force * weight;
+            torques[o] += torque * weight;
+        }
+    }
+}
+
+void FluidSystem::integrate(Scalar dt)
+{
+    ThreadPool::shared().parallelFor(positionX.size(), [this, dt](size_t begin, size_t end)
+                                     {
+        Scalar *__restrict px = positionX.data();
+        Scalar *__restrict py = positionY.data();
+        Scalar *__restrict vx = velocityX.data();
+        Scalar *__restrict vy = velocityY.data();
+        const Scalar *__restrict ax = accelerationX.data();
+        const Scalar *__restrict ay = accelerationY.data();
+        for (size_t i = begin; i < end; i++)
+        {
+            // Semi-implicit Euler
+            vx[i] += ax[i] * dt;
+            vy[i] += ay[i] * dt;
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+        }
+
+        // Keep particles inside the world like Object::finishStep does for bodies
+        for (size_t i = begin; i < end; i++)
+        {
+            if (px[i] < origin.x || px[i] > bound.x)
+            {
+                px[i] = std::clamp(px[i], origin.x, bound.x);
+                vx[i] = 0.0f;
+            }
+            if (py[i] < origin.y || py[i] > bound.y)
+            {
+                py[i] = std::clamp(py[i], origin.y, bound.y);
+                vy[i] = 0.0f;
+            }
+        } }, PARALLEL_MIN_CHUNK);
+}
+
+void FluidSystem::getPixelPositions(std::vector<sf::Vector2f> &result) const
+{
+    result.resize(positionX.size());
+    for (size_t i = 0; i < positionX.size(); i++)
+    {
+        result[i] = sf::Vector2f(static_cast<float>(positionX[i] * pixelsPerMeter), static_cast<float>(positionY[i] * pixelsPerMeter));
+    }
+}
+
+void FluidSystem::drawParticles(sf::RenderTarget *target, const std::vector<sf::Vector2f> &pixels, sf::VertexArray &vertices)
+{
+    if (pixels.empty())
+        return;
+
+    // Two triangles per particle
+    const float r = FLUID_DRAW_RADIUS;
+    vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+    vertices.resize(pixels.size() * 6);
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        sf::Vector2f p = pixels[i];
+        sf::Vertex *quad = &vertices[i * 6];
+        quad[0].position = p + sf::Vector2f(-r, -r);
+        quad[1].position = p + sf::Vector2f(r, -r);
+        quad[2].position = p + sf::Vector2f(r, r);
+        quad[3].position = p + sf::Vector2f(-r, -r);
+        quad[4].position = p + sf::Vector2f(r, r);
+        quad[5].position = p + sf::Vector2f(-r, r);
+        for (int k = 0; k < 6; k++)
+        {
+            quad[k].color = FLUID_COLOR;
+        }
+    }
+    target->draw(vertices);
+}
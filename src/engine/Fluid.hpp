@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Config.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "math/Vec2.hpp"
+#include "objects/Object.hpp"
+
+// Smoothed-particle hydrodynamics liquid. Particles are plain SoA arrays rather than objects, and are
+// sorted by neighbor grid cell at every substep so each particle's neighbors lie in three contiguous
+// runs, one per row of cells, which the density and force kernels sweep without indirection.
+// Particles and objects push each other through penalty forces at the object surfaces.
+class FluidSystem
+{
+private:
+    // Per particle, reordered by cell at every rebuild
+    std::vector<Scalar> positionX, positionY;
+    std::vector<Scalar> velocityX, velocityY;
+    std::vector<Scalar> density;      // kg/m²
+    std::vector<Scalar> pressureTerm; // p / ρ²
+    std::vector<Scalar> accelerationX, accelerationY;
+
+    // Neighbor grid over the world bounds, cells are one smoothing radius wide
+    Vec2 origin;
+    Vec2 bound; // Opposite corner, particles are kept inside
+    int columns = 0;
+    int rows = 0;
+    std::vector<uint32_t> cellStart;   // Offset of each cell's particles, one extra entry at the end
+    std::vector<uint32_t> cellOf;      // Cell of each particle, then its sorted position
+    std::vector<uint32_t> sortScratch; // Counting sort cursors
+    std::vector<Scalar> permuteScratch;
+
+    Scalar particleMass = 0.0f;
+    Scalar restSum = 0.0f; // Unnormalized kernel sum of a particle at rest in a square lattice
+
+    // Emitter following the pour tool
+    bool emitting = false;
+    Vec2 emitterCenter;
+    Scalar emitterRadius = 0.0f;
+    Scalar emitterRate = 0.0f;
+    Scalar emitterBacklog = 0.0f; // Fraction of a particle carried to the next step
+    std::minstd_rand random;
+
+    int cellX(Scalar x) const;
+    int cellY(Scalar y) const;
+
+    void emit(Scalar dt);                    // Add the particles the emitter produced over dt
+    void rebuild();                          // Sort the particles by cell and rebuild the cell offsets
+    void computeDensity();                   // Density and pressure of every particle
+    void computeForces(const Vec2 &gravity); // Pressure, viscosity and gravity accelerations
+    // Push particles out of objects and accumulate the reactions, weighted for averaging over substeps
+    void couple(const std::vector<Object *> &objects, Scalar weight, std::vector<Vec2> &forces, std::vector<Scalar> &torques);
+    void integrate(Scalar dt);
+
+public:
+    // Constructors
+    FluidSystem(const Vec2 &min, const Vec2 &max);
+
+    // Methods
+    bool addParticle(const Vec2 &position, const Vec2 &velocity); // False once FLUID_MAX_PARTICLES is reached
+    void addBlock(const Vec2 &min, const Vec2 &max);              // Fill a region at rest spacing
+    void clear();
+
+    void setEmitter(const Vec2 &center, Scalar radius, Scalar rate); // Start or move the emitter, rate in particles/s
+    void stopEmitter();
+    bool isActive() const; // Whether there are particles or an emitter
+
+    // Advance the fluid by dt in substeps. forces and torques receive, per object, the average reaction
+    // of the fluid on it over the step; static objects get none.
+    void step(Scalar dt, const Vec2 &gravity, const std::vector<Object *> &objects, std::vector<Vec2> &forces, std::vector<Scalar> &torques);
+
+    size_t size() const;
+    void getPixelPositions(std::vector<sf::Vector2f> &result) const; // Particle centers for drawing
+
+    // Draw particle centers as small quads in one draw call
+    static void drawParticles(sf::RenderTarget *target, const std::vector<sf::Vector2f> &pixels, sf::VertexArray &vertices);
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Config.h"
+
+#include <algorithm>
+#include <string>
+#include "math/Vec2.hpp"
+
+// Radial force field with a cutoff radius, positive strength pushes bodies away from the center
+struct ForceField
+{
+    std::string name;
+    Vec2 center;
+    float strength = 0.0f;
+    float radius = DEFAULT_FIELD_RADIUS; // Bodies beyond this distance are not affected
+
+    ForceField(const std::string &name, const Vec2 &center, float strength, float radius) : name(name), center(center), strength(strength), radius(radius) {}
+
+    // Force on a body at the given position, zero outside the cutoff
+    Vec2 sample(const Vec2 &position) const
+    {
+        Vec2 diff = position - center;
+        Scalar distanceSquared = diff.lengthSquared();
+        if (distanceSquared > radius * radius || distanceSquared == 0.0f)
+            return Vec2(0.0f, 0.0f);
+
+        Scalar attenuation = std::max<Scalar>(1.0f / distanceSquared, MAX_ATTENUATION);
+        return diff.normalized() * attenuation * strength * FORCE_SCALE;
+    }
+
+    void getBounds(Vec2 &min, Vec2 &max) const
+    {
+        min = center - Vec2(radius, radius);
+        max = center + Vec2(radius, radius);
+    }
+};
@@ -0,0 +1,700 @@
+#include "ForceProgram.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <unordered_map>
+#include <fmt/format.h>
+
+// Scalar semantics of every arithmetic op, shared by constant folding and the interpreter
+static inline Scalar applyOp(ProgramOp op, Scalar x, Scalar y)
+{
+    switch (op)
+    {
+    case OP_ADD:
+        return x + y;
+    case OP_SUB:
+        return x - y;
+    case OP_MUL:
+        return x * y;
+    case OP_DIV:
+        return y != 0.0f ? x / y : 0.0f;
+    case OP_POW:
+        return std::pow(x, y);
+    case OP_MIN:
+        return std::min(x, y);
+    case OP_MAX:
+        return std::max(x, y);
+    case OP_NEG:
+        return -x;
+    case OP_SQRT:
+        return std::sqrt(std::abs(x));
+    case OP_SIN:
+        return std::sin(x);
+    case OP_COS:
+        return std::cos(x);
+    case OP_EXP:
+        return std::exp(x);
+    case OP_ABS:
+        return std::abs(x);
+    default:
+        return 0.0f;
+    }
+}
+
+// One scalar of a value: either known at compile time or held in a register
+struct Component
+{
+    bool isConstant = true;
+    Scalar value = 0.0f;
+    uint16_t reg = 0;
+};
+
+// Compile-time value, vectors are two components
+struct Value
+{
+    bool isVector = false;
+    Component c[2];
+};
+
+static Value scalarConstant(Scalar value)
+{
+    Value result;
+    result.c[0].value = value;
+    return result;
+}
+
+// Single-pass recursive descent compiler, code is emitted while parsing
+class ProgramCompiler
+{
+private:
+    const std::string &source;
+    ForceProgram &program;
+    std::string &error;
+    size_t pos = 0;
+    bool failed = false;
+
+    std::unordered_map<std::string, Value> locals;
+    Value inputs[PROGRAM_LANE_INPUTS];
+    bool inputLoaded[PROGRAM_LANE_INPUTS] = {};
+    Value uniforms[PROGRAM_UNIFORMS];
+    bool uniformLoaded[PROGRAM_UNIFORMS] = {};
+
+    Value fail(const std::string &message)
+    {
+        if (!failed)
+        {
+            // Report the line and column of the current position
+            size_t line = 1 + std::count(source.begin(), source.begin() + std::min(pos, source.size()), '\n');
+            size_t lineStart = source.rfind('\n', pos == 0 ? 0 : pos - 1);
+            size_t column = lineStart == std::string::npos || pos == 0 ? pos + 1 : pos - lineStart;
+            error = fmt::format("line {}, column {}: {}", line, column, message);
+            failed = true;
+        }
+        return Value();
+    }
+
+    // Lexing
+    bool atEnd() const { return pos >= source.size(); }
+    char peek() const { return atEnd() ? '\0' : source[pos]; }
+
+    void skipSpace()
+    {
+        while (!atEnd() && (source[pos] == ' ' || source[pos] == '\t' || source[pos] == '\r'))
+            pos++;
+    }
+
+    bool accept(char c)
+    {
+        skipSpace();
+        if (peek() != c)
+            return false;
+        pos++;
+        return true;
+    }
+
+    bool identifier(std::string &name)
+    {
+        skipSpace();
+        if (!std::isalpha(static_cast<unsigned char>(peek())) && peek() != '_')
+            return false;
+        size_t start = pos;
+        while (!atEnd() && (std::isalnum(static_cast<unsigned char>(source[pos])) || source[pos] == '_'))
+            pos++;
+        name = source.substr(start, pos - start);
+        return true;
+    }
+
+    bool number(Scalar &value)
+    {
+        skipSpace();
+        if (!std::isdigit(static_cast<unsigned char>(peek())) && peek() != '.')
+            return false;
+        const char *start = source.c_str() + pos;
+        char *end = nullptr;
+        value = static_cast<Scalar>(std::strtod(start, &end));
+        if (end == start)
+            return false;
+        pos += end - start;
+        return true;
+    }
+
+    // Code generation
+    uint16_t allocate()
+    {
+        if (program.registerCount >= PROGRAM_MAX_REGISTERS)
+        {
+            fail("expression is too complex");
+            return 0;
+        }
+        return program.registerCount++;
+    }
+
+    uint16_t reg(Component &component) // Materialize a constant into a register on first use
+    {
+        if (component.isConstant)
+        {
+            uint16_t dst = allocate();
+            program.code.push_back({OP_CONST, dst, static_cast<uint16_t>(program.constants.size()), 0});
+            program.constants.push_back(component.value);
+            component.isConstant = false;
+            component.reg = dst;
+        }
+        return component.reg;
+    }
+
+    Component emit(ProgramOp op, Component a, Component b = Component())
+    {
+        Component result;
+        if (a.isConstant && b.isConstant)
+        {
+            result.value = applyOp(op, a.value, b.value);
+            return result;
+        }
+        uint16_t ra = reg(a);
+        uint16_t rb = op <= OP_MAX ? reg(b) : 0;
+        result.isConstant = false;
+        result.reg = allocate();
+        program.code.push_back({op, result.reg, ra, rb});
+        return result;
+    }
+
+    Value load(ProgramOp op, uint16_t index)
+    {
+        Value value;
+        value.c[0].isConstant = false;
+        value.c[0].reg = allocate();
+        program.code.push_back({op, value.c[0].reg, index, 0});
+        return value;
+    }
+
+    Value input(ProgramInput x, ProgramInput y = PROGRAM_LANE_INPUTS)
+    {
+        Value result;
+        result.isVector = y != PROGRAM_LANE_INPUTS;
+        ProgramInput lanes[2] = {x, y};
+        for (int i = 0; i < (result.isVector ? 2 : 1); i++)
+        {
+            if (!inputLoaded[lanes[i]])
+            {
+                inputs[lanes[i]] = load(OP_INPUT, lanes[i]);
+                inputLoaded[lanes[i]] = true;
+            }
+            result.c[i] = inputs[lanes[i]].c[0];
+        }
+        return result;
+    }
+
+    Value uniform(ProgramUniform x, ProgramUniform y = PROGRAM_UNIFORMS)
+    {
+        Value result;
+        result.isVector = y != PROGRAM_UNIFORMS;
+        ProgramUniform names[2] = {x, y};
+        for (int i = 0; i < (result.isVector ? 2 : 1); i++)
+        {
+            if (!uniformLoaded[names[i]])
+            {
+                uniforms[names[i]] = load(OP_UNIFORM, names[i]);
+                uniformLoaded[names[i]] = true;
+            }
+            result.c[i] = uniforms[names[i]].c[0];
+        }
+        return result;
+    }
+
+    // Component-wise op with scalars broadcast over vectors
+    Value binary(ProgramOp op, Value a, Value b)
+    {
+        Value result;
+        result.isVector = a.isVector || b.isVector;
+        for (int i = 0; i < (result.isVector ? 2 : 1); i++)
+        {
+            result.c[i] = emit(op, a.c[a.isVector ? i : 0], b.c[b.isVector ? i : 0]);
+        }
+        return result;
+    }
+
+    Value unary(ProgramOp op, Value a)
+    {
+        Value result;
+        result.isVector = a.isVector;
+        for (int i = 0; i < (a.isVector ? 2 : 1); i++)
+        {
+            result.c[i] = emit(op, a.c[i]);
+        }
+        return result;
+    }
+
+    Value dot(Value a, Value b)
+    {
+        Value result;
+        result.c[0] = emit(OP_ADD, emit(OP_MUL, a.c[0], b.c[0]), emit(OP_MUL, a.c[1], b.c[1]));
+        return result;
+    }
+
+    // Grammar
+    Value variable(const std::string &name)
+    {
+        if (name == "p")
+            return input(INPUT_PX, INPUT_PY);
+        if (name == "v")
+            return input(INPUT_VX, INPUT_VY);
+        if (name == "m")
+            return input(INPUT_MASS);
+        if (name == "q")
+            return input(INPUT_CHARGE);
+        if (name == "theta")
+            return input(INPUT_ANGLE);
+        if (name == "w")
+            return input(INPUT_SPIN);
+        if (name == "t")
+            return uniform(UNIFORM_TIME);
+        if (name == "g")
+            return uniform(UNIFORM_GX, UNIFORM_GY);
+
+        auto local = locals.find(name);
+        if (local == locals.end())
+            return fail(fmt::format("unknown name '{}'", name));
+        return local->second;
+    }
+
+    Value call(const std::string &name)
+    {
+        std::vector<Value> args;
+        if (!accept(')'))
+        {
+            do
+            {
+                args.push_back(expression());
+                if (failed)
+                    return Value();
+            } while (accept(','));
+            if (!accept(')'))
+                return fail("expected ')' after arguments");
+        }
+
+        auto expect = [&](size_t count, bool vectors) -> bool
+        {
+            if (args.size() != count)
+            {
+                fail(fmt::format("{}() takes {} argument{}", name, count, count == 1 ? "" : "s"));
+                return false;
+            }
+            for (const Value &arg : args)
+            {
+                if (arg.isVector != vectors)
+                {
+                    fail(fmt::format("{}() takes {}", name, vectors ? "vectors" : "scalars"));
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        if (name == "vec")
+        {
+            if (!expect(2, false))
+                return Value();
+            Value result;
+            result.isVector = true;
+            result.c[0] = args[0].c[0];
+            result.c[1] = args[1].c[0];
+            return result;
+        }
+        if (name == "dot")
+            return expect(2, true) ? dot(args[0], args[1]) : Value();
+        if (name == "length")
+            return expect(1, true) ? unary(OP_SQRT, dot(args[0], args[0])) : Value();
+        if (name == "normalize")
+            return expect(1, true) ? binary(OP_DIV, args[0], unary(OP_SQRT, dot(args[0], args[0]))) : Value();
+        if (name == "perp")
+        {
+            if (!expect(1, true))
+                return Value();
+            Value result;
+            result.isVector = true;
+            result.c[0] = emit(OP_NEG, args[0].c[1]);
+            result.c[1] = args[0].c[0];
+            return result;
+        }
+
+        static const std::pair<const char *, ProgramOp> unaryFunctions[] = {{"sqrt", OP_SQRT}, {"sin", OP_SIN}, {"cos", OP_COS}, {"exp", OP_EXP}, {"abs", OP_ABS}};
+        for (const auto &function : unaryFunctions)
+        {
+            if (name == function.first)
+                return expect(1, false) ? unary(function.second, args[0]) : Value();
+        }
+        if (name == "min" || name == "max")
+            return expect(2, false) ? binary(name == "min" ? OP_MIN : OP_MAX, args[0], args[1]) : Value();
+
+        return fail(fmt::format("unknown function '{}'", name));
+    }
+
+    Value primary()
+    {
+        Scalar literal;
+        std::string name;
+        if (number(literal))
+            return scalarConstant(literal);
+        if (accept('('))
+        {
+            Value inner = expression();
+            if (!accept(')'))
+                return fail("expected ')'");
+            return inner;
+        }
+        if (identifier(name))
+        {
+            if (accept('('))
+                return call(name);
+            return variable(name);
+        }
+        return fail(atEnd() ? "unexpected end of expression" : fmt::format("unexpected '{}'", peek()));
+    }
+
+    Value postfix()
+    {
+        Value value = primary();
+        while (!failed && accept('.'))
+        {
+            std::string field;
+            if (!identifier(field) || (field != "x" && field != "y"))
+                return fail("expected .x or .y");
+            if (!value.isVector)
+                return fail(fmt::format(".{} of a scalar", field));
+            value.isVector = false;
+            value.c[0] = value.c[field == "x" ? 0 : 1];
+        }
+        return value;
+    }
+
+    Value power()
+    {
+        Value base = postfix();
+        if (failed || !accept('^'))
+            return base;
+        Value exponent = unaryExpression(); // Right associative
+        if (base.isVector || exponent.isVector)
+            return fail("'^' needs scalars");
+        return binary(OP_POW, base, exponent);
+    }
+
+    Value unaryExpression()
+    {
+        if (accept('-'))
+            return unary(OP_NEG, unaryExpression());
+        if (accept('+'))
+            return unaryExpression();
+        return power();
+    }
+
+    Value term()
+    {
+        Value value = unaryExpression();
+        while (!failed)
+        {
+            bool multiply = accept('*');
+            if (!multiply && !accept('/'))
+                break;
+            Value rhs = unaryExpression();
+            if (multiply && value.isVector && rhs.isVector)
+                return fail("'*' of two vectors, use dot()");
+            if (!multiply && rhs.isVector)
+                return fail("division by a vector");
+            value = binary(multiply ? OP_MUL : OP_DIV, value, rhs);
+        }
+        return value;
+    }
+
+    Value expression()
+    {
+        Value value = term();
+        while (!failed)
+        {
+            bool add = accept('+');
+            if (!add && !accept('-'))
+                break;
+            Value rhs = term();
+            if (value.isVector != rhs.isVector)
+                return fail(fmt::format("'{}' of a vector and a scalar", add ? '+' : '-'));
+            value = binary(add ? OP_ADD : OP_SUB, value, rhs);
+        }
+        return value;
+    }
+
+    // Degree of every register in p and v: 0 independent of them, 1 affine, 2 anything else
+    bool outputIsAffine() const
+    {
+        std::vector<uint8_t> degree(program.registerCount, 0);
+        for (const ProgramInstruction &instruction : program.code)
+        {
+            uint8_t &dst = degree[instruction.dst];
+            switch (instruction.op)
+            {
+            case OP_CONST:
+            case OP_UNIFORM:
+                dst = 0;
+                break;
+            case OP_INPUT:
+                dst = instruction.a <= INPUT_VY ? 1 : 0;
+                break;
+            case OP_ADD:
+            case OP_SUB:
+                dst = std::max(degree[instruction.a], degree[instruction.b]);
+                break;
+            case OP_NEG:
+                dst = degree[instruction.a];
+                break;
+            case OP_MUL:
+                dst = std::min(degree[instruction.a] + degree[instruction.b], 2);
+                break;
+            case OP_DIV:
+                dst = degree[instruction.b] == 0 ? degree[instruction.a] : 2;
+                break;
+            default:
+                // Anything else is only affine of values that do not depend on p and v
+                bool binary = instruction.op <= OP_MAX;
+                dst = degree[instruction.a] == 0 && (!binary || degree[instruction.b] == 0) ? 0 : 2;
+                break;
+            }
+        }
+        return degree[program.outputX] <= 1 && degree[program.outputY] <= 1;
+    }
+
+    void skipSeparators()
+    {
+        while (!atEnd() && (std::isspace(static_cast<unsigned char>(source[pos])) || source[pos] == ';'))
+            pos++;
+    }
+
+public:
+    ProgramCompiler(const std::string &source, ForceProgram &program, std::string &error) : source(source), program(program), error(error) {}
+
+    bool compile()
+    {
+        static const char *inputNames[] = {"p", "v", "m", "q", "theta", "w", "t", "g"};
+
+        while (true)
+        {
+            skipSeparators();
+            if (atEnd())
+                break;
+
+            std::string name;
+            if (!identifier(name))
+                return fail("expected 'name = expression'"), false;
+            for (const char *input : inputNames)
+            {
+                if (name == input)
+                    return fail(fmt::format("'{}' is an input and cannot be assigned", name)), false;
+            }
+            if (!accept('='))
+                return fail(fmt::format("expected '=' after '{}'", name)), false;
+
+            Value value = expression();
+            if (failed)
+                return false;
+            locals[name] = value;
+
+            skipSpace();
+            if (!atEnd() && peek() != ';' && peek() != '\n')
+                return fail(fmt::format("unexpected '{}'", peek())), false;
+        }
+
+        auto force = locals.find("F");
+        if (force == locals.end() || !force->second.isVector)
+            return fail("the program must assign a vector to F"), false;
+
+        program.outputX = reg(force->second.c[0]);
+        program.outputY = reg(force->second.c[1]);
+        if (failed)
+            return false;
+        program.affine = outputIsAffine();
+        return true;
+    }
+};
+
+bool ForceProgram::compile(const std::string &source, ForceProgram &program, std::string &error)
+{
+    ForceProgram compiled;
+    compiled.name = program.name;
+    compiled.source = source;
+    ProgramCompiler compiler(source, compiled, error);
+    if (!compiler.compile())
+        return false;
+    program = compiled;
+    return true;
+}
+
+// Kernels get their own restrict-qualified parameters so the lane loops vectorize
+template <ProgramOp Op>
+static void binaryLanes(Scalar *__restrict dst, const Scalar *__restrict a, const Scalar *__restrict b, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = applyOp(Op, a[i], b[i]);
+    }
+}
+
+template <ProgramOp Op>
+static void unaryLanes(Scalar *__restrict dst, const Scalar *__restrict a, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = applyOp(Op, a[i], 0.0f);
+    }
+}
+
+void ForceProgram::run(const ProgramInputs &inputs, size_t count, Scalar *forceX, Scalar *forceY, std::vector<Scalar> &scratch) const
+{
+    scratch.resize(static_cast<size_t>(registerCount) * PROGRAM_BATCH_SIZE);
+
+    // Each instruction runs over a whole batch, so dispatch is paid once per batch instead of once per body
+    for (size_t begin = 0; begin < count; begin += PROGRAM_BATCH_SIZE)
+    {
+        size_t n = std::min<size_t>(PROGRAM_BATCH_SIZE, count - begin);
+        for (const ProgramInstruction &instruction : code)
+        {
+            Scalar *dst = scratch.data() + instruction.dst * PROGRAM_BATCH_SIZE;
+            const Scalar *a = scratch.data() + instruction.a * PROGRAM_BATCH_SIZE;
+            const Scalar *b = scratch.data() + instruction.b * PROGRAM_BATCH_SIZE;
+            switch (instruction.op)
+            {
+            case OP_CONST:
+                std::fill(dst, dst + n, constants[instruction.a]);
+                break;
+            case OP_INPUT:
+                std::copy(inputs.lanes[instruction.a] + begin, inputs.lanes[instruction.a] + begin + n, dst);
+                break;
+            case OP_UNIFORM:
+                std::fill(dst, dst + n, inputs.uniforms[instruction.a]);
+                break;
+            case OP_ADD:
+                binaryLanes<OP_ADD>(dst, a, b, n);
+                break;
+            case OP_SUB:
+                binaryLanes<OP_SUB>(dst, a, b, n);
+                break;
+            case OP_MUL:
+                binaryLanes<OP_MUL>(dst, a, b, n);
+                break;
+            case OP_DIV:
+                binaryLanes<OP_DIV>(dst, a, b, n);
+                break;
+            case OP_POW:
+                binaryLanes<OP_POW>(dst, a, b, n);
+                break;
+            case OP_MIN:
+                binaryLanes<OP_MIN>(dst, a, b, n);
+                break;
+            case OP_MAX:
+                binaryLanes<OP_MAX>(dst, a, b, n);
+                break;
+            case OP_NEG:
+                unaryLanes<OP_NEG>(dst, a, n);
+                break;
+            case OP_SQRT:
+                unaryLanes<OP_SQRT>(dst, a, n);
+                break;
+            case OP_SIN:
+                unaryLanes<OP_SIN>(dst, a, n);
+                break;
+            case OP_COS:
+                unaryLanes<OP_COS>(dst, a, n);
+                break;
+            case OP_EXP:
+                unaryLanes<OP_EXP>(dst, a, n);
+                break;
+            case OP_ABS:
+                unaryLanes<OP_ABS>(dst, a, n);
+                break;
+            }
+        }
+
+        const Scalar *x = scratch.data() + outputX * PROGRAM_BATCH_SIZE;
+        const Scalar *y = scratch.data() + outputY * PROGRAM_BATCH_SIZE;
+        std::copy(x, x + n, forceX + begin);
+        std::copy(y, y + n, forceY + begin);
+    }
+}
+
+size_t ForceProgram::getInstructionCount() const
+{
+    return code.size();
+}
+
+bool ForceProgram::isAffine() const
+{
+    return affine;
+}
+
+Force ProgramEvaluator::evaluate(const Body &state, int index) const
+{
+    const Body *states[1] = {&state};
+    Force force;
+    evaluateAll(states, &index, 1, &force);
+    return force;
+}
+
+void ProgramEvaluator::evaluateAll(const Body *const *states, const int *, size_t count, Force *forces) const
+{
+    thread_local std::vector<Scalar> lanes[PROGRAM_LANE_INPUTS];
+    thread_local std::vector<Scalar> forceX, forceY, scratch;
+    for (int lane = 0; lane < PROGRAM_LANE_INPUTS; lane++)
+    {
+        lanes[lane].resize(count);
+    }
+    forceX.resize(count);
+    forceY.resize(count);
+
+    for (size_t k = 0; k < count; k++)
+    {
+        const Body &state = *states[k];
+        lanes[INPUT_PX][k] = state.position.x;
+        lanes[INPUT_PY][k] = ground - state.position.y;
+        lanes[INPUT_VX][k] = state.velocity.x;
+        lanes[INPUT_VY][k] = -state.velocity.y;
+        lanes[INPUT_MASS][k] = state.mass;
+        lanes[INPUT_CHARGE][k] = state.charge;
+        lanes[INPUT_ANGLE][k] = -state.angle;
+        lanes[INPUT_SPIN][k] = -state.angularVelocity;
+        forces[k] = Force();
+    }
+
+    ProgramInputs inputs;
+    for (int lane = 0; lane < PROGRAM_LANE_INPUTS; lane++)
+    {
+        inputs.lanes[lane] = lanes[lane].data();
+    }
+    std::copy(uniforms, uniforms + PROGRAM_UNIFORMS, inputs.uniforms);
+
+    for (const ForceProgram &program : *programs)
+    {
+        program.run(inputs, count, forceX.data(), forceY.data(), scratch);
+        for (size_t k = 0; k < count; k++)
+        {
+            forces[k].force += Vec2(forceX[k], -forceY[k]);
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Config.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "math/Vec2.hpp"
+#include "objects/Force.hpp"
+
+// Per-body inputs of a force program
+enum ProgramInput : uint16_t
+{
+    INPUT_PX,     // Position (m), user space: x from the center, y up from the ground
+    INPUT_PY,
+    INPUT_VX,     // Velocity (m/s), y up
+    INPUT_VY,
+    INPUT_MASS,   // kg
+    INPUT_CHARGE, // C
+    INPUT_ANGLE,  // rad
+    INPUT_SPIN,   // rad/s
+    PROGRAM_LANE_INPUTS
+};
+
+// World-wide inputs, the same for every body
+enum ProgramUniform : uint16_t
+{
+    UNIFORM_TIME, // s
+    UNIFORM_GX,   // Gravity (m/s²), y up
+    UNIFORM_GY,
+    PROGRAM_UNIFORMS
+};
+
+// Inputs of one batch of bodies, one array per lane input
+struct ProgramInputs
+{
+    const Scalar *lanes[PROGRAM_LANE_INPUTS] = {};
+    Scalar uniforms[PROGRAM_UNIFORMS] = {};
+};
+
+enum ProgramOp : uint8_t
+{
+    OP_CONST,   // dst = constants[a]
+    OP_INPUT,   // dst = lanes[a]
+    OP_UNIFORM, // dst = uniforms[a]
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV, // Division by zero gives zero so a bad expression cannot poison the world with NaNs
+    OP_POW,
+    OP_MIN,
+    OP_MAX,
+    OP_NEG,
+    OP_SQRT, // Of the magnitude
+    OP_SIN,
+    OP_COS,
+    OP_EXP,
+    OP_ABS
+};
+
+// Three-address instruction over scalar registers
+struct ProgramInstruction
+{
+    ProgramOp op;
+    uint16_t dst;
+    uint16_t a;
+    uint16_t b;
+};
+
+// User force expression compiled to register bytecode, for example
+//
+//   k = 5; c = vec(0, 3); b = 0.5
+//   F = -k*(p - c) - b*v
+//
+// Statements are separated by ';' or new lines and the program must assign the vector F.
+// Inputs: p, v, g (vectors), m, q, theta, w, t (scalars). Operators: + - * / ^, .x and .y.
+// Functions: vec, dot, length, normalize, perp, sqrt, sin, cos, exp, abs, min, max.
+// Vector math is lowered to scalar instructions and constant subexpressions are folded,
+// so the interpreter only ever runs flat scalar loops over a batch of bodies.
+// Lowering also tells whether F is affine in p and v, which lets the world hand it to the solvers as a linear force.
+class ForceProgram
+{
+private:
+    std::vector<ProgramInstruction> code;
+    std::vector<Scalar> constants;
+    uint16_t registerCount = 0;
+    uint16_t outputX = 0; // Registers holding F
+    uint16_t outputY = 0;
+    bool affine = false; // F = a + A·p + B·v, where a, A and B depend on anything but p and v
+
+    friend class ProgramCompiler;
+
+public:
+    std::string name;
+    std::string source;
+
+    // Methods
+    // Parse and compile source, error explains the first problem found
+    static bool compile(const std::string &source, ForceProgram &program, std::string &error);
+
+    // Evaluate F for count bodies into forceX and forceY, in user space
+    void run(const ProgramInputs &inputs, size_t count, Scalar *forceX, Scalar *forceY, std::vector<Scalar> &scratch) const;
+
+    size_t getInstructionCount() const;
+    bool isAffine() const;
+};
+
+// Summed force of a world's programs on bodies in any state, for programs the solvers evaluate at every stage.
+// A stage's bodies are gathered into lanes and each program runs once over all of them. Converts the bodies
+// to the user's frame and the forces back, the uniforms are held over the step.
+class ProgramEvaluator : public ForceEvaluator
+{
+public:
+    const std::vector<ForceProgram> *programs = nullptr;
+    Scalar ground = 0.0f; // World y of the user's ground (m)
+    Scalar uniforms[PROGRAM_UNIFORMS] = {};
+
+    Force evaluate(const Body &state, int index) const override;
+    void evaluateAll(const Body *const *states, const int *indices, size_t count, Force *forces) const override;
+};
@@ -0,0 +1,253 @@
+#include "Granular.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "engine/ThreadPool.hpp"
+
+// Squared reach of one circle into a contiguous run of others: (r + r_k)² - d², positive where they overlap.
+// Branch-free so the loop vectorizes; with equal radii the sum of radii is the constant diameter.
+template <bool UniformRadius>
+static void reachRun(Scalar x, Scalar y, Scalar r, const Scalar *__restrict px, const Scalar *__restrict py, const Scalar *__restrict pr,
+                     size_t count, Scalar diameter, Scalar *__restrict reach)
+{
+    for (size_t k = 0; k < count; k++)
+    {
+        Scalar dx = x - px[k];
+        Scalar dy = y - py[k];
+        Scalar sum = UniformRadius ? diameter : r + pr[k];
+        reach[k] = sum * sum - dx * dx - dy * dy;
+    }
+}
+
+GranularSolver::GranularSolver(const Vec2 &min, const Vec2 &max) : origin(min), extent(max - min)
+{
+}
+
+void GranularSolver::select(const std::vector<Object *> &objects, std::vector<char> &mask)
+{
+    mask.assign(objects.size(), 0);
+    circles.clear();
+
+    std::vector<Scalar> radii;
+    for (Object *object : objects)
+    {
+        if (object->shapeType == CIRCLE && !object->isGrabbed)
+            radii.push_back(object->dimensions.x);
+    }
+    if (radii.size() < 2)
+        return;
+
+    // A few large circles would inflate the grid cells for everyone, they stay generic
+    std::nth_element(radii.begin(), radii.begin() + radii.size() / 2, radii.end());
+    Scalar limit = radii[radii.size() / 2] * GRANULAR_RADIUS_SPREAD;
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        Object *object = objects[i];
+        if (object->shapeType == CIRCLE && !object->isGrabbed && object->dimensions.x <= limit)
+        {
+            mask[i] = 1;
+            circles.push_back(object);
+        }
+    }
+}
+
+void GranularSolver::pack()
+{
+    size_t count = circles.size();
+    Scalar largest = 0.0f;
+    for (Object *circle : circles)
+    {
+        largest = std::max(largest, circle->dimensions.x);
+    }
+
+    // Cells at least one diameter wide, so touching circles are in neighboring cells, and no more cells than needed
+    Scalar coarsest = std::sqrt(extent.x * extent.y / static_cast<Scalar>(4 * count + 1024));
+    cellSize = std::max(largest * 2.0f, coarsest);
+    columns = std::max(1, static_cast<int>(std::ceil(extent.x / cellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil(extent.y / cellSize)));
+
+    // Count the circles per cell, streaming through the bodies in object order
+    rank.resize(count);
+    cellStart.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        const Vec2 &position = circles[i]->body->position;
+        int x = std::clamp(static_cast<int>(std::floor((position.x - origin.x) / cellSize)), 0, columns - 1);
+        int y = std::clamp(static_cast<int>(std::floor((position.y - origin.y) / cellSize)), 0, rows - 1);
+        rank[i] = static_cast<uint32_t>(y * columns + x);
+        cellStart[rank[i] + 1]++;
+    }
+    for (size_t c = 1; c < cellStart.size(); c++)
+    {
+        cellStart[c] += cellStart[c - 1];
+    }
+
+    // Stable counting sort: slots are handed out in object order, then every circle copies its state into
+    // its own slot, which splits across threads without conflicts
+    cellOf.resize(count);
+    positionX.resize(count);
+    positionY.resize(count);
+    velocityX.resize(count);
+    velocityY.resize(count);
+    radius.resize(count);
+    invMass.resize(count);
+    restitution.resize(count);
+    std::vector<uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t cell = rank[i];
+        uint32_t k = cursor[cell]++;
+        rank[i] = k;
+        cellOf[k] = cell;
+    }
+    ThreadPool::shared().parallelFor(count, [this](size_t begin, size_t end)
+                                     {
+        for (size_t i = begin; i < end; i++)
+        {
+            uint32_t k = rank[i];
+            const Object *circle = circles[i];
+            const Body *body = circle->body;
+            positionX[k] = body->position.x;
+            positionY[k] = body->position.y;
+            velocityX[k] = body->velocity.x;
+            velocityY[k] = body->velocity.y;
+            radius[k] = circle->dimensions.x;
+            invMass[k] = circle->isStatic ? 0.0f : body->invMass;
+            restitution[k] = body->restitution;
+        } }, PARALLEL_MIN_CHUNK);
+}
+
+template <bool UniformRadius>
+void GranularSolver::detect(size_t begin, size_t end, std::vector<GranularContact> &contacts) const
+{
+    thread_local std::vector<Scalar> reach;
+    const Scalar diameter = radius[0] * 2.0f;
+    for (size_t i = begin; i < end; i++)
+    {
+        uint32_t cell = cellOf[i];
+        int cx = static_cast<int>(cell % columns), cy = static_cast<int>(cell / columns);
+        int x0 = std::max(cx - 1, 0), x1 = std::min(cx + 1, columns - 1);
+
+        // Later circles in this cell and the next, then the three cells of the row below
+        uint32_t runs[2][2] = {{static_cast<uint32_t>(i + 1), cellStart[cy * columns + x1 + 1]}, {0, 0}};
+        if (cy + 1 < rows)
+        {
+            runs[1][0] = cellStart[(cy + 1) * columns + x0];
+            runs[1][1] = cellStart[(cy + 1) * columns + x1 + 1];
+        }
+
+        for (const uint32_t *run : runs)
+        {
+            size_t first = run[0], count = run[1] > run[0] ? run[1] - run[0] : 0;
+            if (count == 0)
+                continue;
+            if (reach.size() < count)
+                reach.resize(count);
+            reachRun<UniformRadius>(positionX[i], positionY[i], radius[i], positionX.data() + first, positionY.data() + first, radius.data() + first, count, diameter, reach.data());
+
+            for (size_t k = 0; k < count; k++)
+            {
+                if (reach[k] <= 0.0f)
+                    continue;
+
+                size_t j = first + k;
+                if (invMass[i] == 0.0f && invMass[j] == 0.0f)
+                    continue;
+                Scalar dx = positionX[i] - positionX[j];
+                Scalar dy = positionY[i] - positionY[j];
+                Scalar distance = std::sqrt(dx * dx + dy * dy);
+                GranularContact contact;
+                contact.a = static_cast<uint32_t>(i);
+                contact.b = static_cast<uint32_t>(j);
+                contact.nx = distance > 0.0f ? dx / distance : 1.0f;
+                contact.ny = distance > 0.0f ? dy / distance : 0.0f;
+                contact.penetration = (UniformRadius ? diameter : radius[i] + radius[j]) - distance;
+                contacts.push_back(contact);
+            }
+        }
+    }
+}
+
+void GranularSolver::resolveBlock(const std::vector<GranularContact> &contacts, bool correctPosition)
+{
+    for (const GranularContact &contact : contacts)
+    {
+        uint32_t a = contact.a, b = contact.b;
+        Scalar invMassA = invMass[a], invMassB = invMass[b];
+        Scalar invMassSum = invMassA + invMassB;
+
+        // Positional correction along the normal, A moves away from B
+        if (correctPosition)
+        {
+            Scalar correction = std::max<Scalar>(contact.penetration - CONTACT_SLOP, 0.0f) / invMassSum * CONTACT_CORRECTION;
+            positionX[a] += contact.nx * correction * invMassA;
+            positionY[a] += contact.ny * correction * invMassA;
+            positionX[b] -= contact.nx * correction * invMassB;
+            positionY[b] -= contact.ny * correction * invMassB;
+        }
+
+        Scalar approach = (velocityX[b] - velocityX[a]) * contact.nx + (velocityY[b] - velocityY[a]) * contact.ny;
+        if (approach < CONTACT_MIN_SPEED)
+            continue; // Separating or negligible
+
+        Scalar impulse = -(1.0f + std::min(restitution[a], restitution[b])) * approach / invMassSum;
+        velocityX[a] -= contact.nx * impulse * invMassA;
+        velocityY[a] -= contact.ny * impulse * invMassA;
+        velocityX[b] += contact.nx * impulse * invMassB;
+        velocityY[b] += contact.ny * impulse * invMassB;
+    }
+}
+
+int GranularSolver::resolve(int iterations)
+{
+    size_t count = circles.size();
+    if (count < 2)
+        return 0;
+    pack();
+
+    bool uniform = std::all_of(radius.begin(), radius.end(), [this](Scalar r)
+                               { return r == radius[0]; });
+
+    // Detection in fixed blocks, so the contacts come out in the same order whatever the thread count
+    size_t blockCount = (count + GRANULAR_BLOCK_SIZE - 1) / GRANULAR_BLOCK_SIZE;
+    blockContacts.resize(blockCount);
+    ThreadPool::shared().parallelFor(blockCount, [this, count, uniform](size_t first, size_t last)
+                                     {
+        for (size_t block = first; block < last; block++)
+        {
+            std::vector<GranularContact> &contacts = blockContacts[block];
+            contacts.clear();
+            size_t begin = block * GRANULAR_BLOCK_SIZE;
+            size_t end = std::min(begin + GRANULAR_BLOCK_SIZE, count);
+            if (uniform)
+                detect<true>(begin, end, contacts);
+            else
+                detect<false>(begin, end, contacts);
+        } }, 1);
+
+    int contactCount = 0;
+    for (const std::vector<GranularContact> &contacts : blockContacts)
+    {
+        contactCount += static_cast<int>(contacts.size());
+    }
+    for (int iteration = 0; iteration < std::max(iterations, 1); iteration++)
+    {
+        for (const std::vector<GranularContact> &contacts : blockContacts)
+        {
+            resolveBlock(contacts, iteration == 0);
+        }
+    }
+
+    ThreadPool::shared().parallelFor(count, [this](size_t begin, size_t end)
+                                     {
+        for (size_t i = begin; i < end; i++)
+        {
+            uint32_t k = rank[i];
+            if (invMass[k] == 0.0f)
+                continue;
+            Body *body = circles[i]->body;
+            body->position = Vec2(positionX[k], positionY[k]);
+            body->velocity = Vec2(velocityX[k], velocityY[k]);
+        } }, PARALLEL_MIN_CHUNK);
+    return contactCount;
+}
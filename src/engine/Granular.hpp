@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Config.h"
+
+#include <cstdint>
+#include <vector>
+#include "math/Vec2.hpp"
+#include "objects/Object.hpp"
+
+// Overlapping pair of packed circles, the normal points from b to a
+struct GranularContact
+{
+    uint32_t a;
+    uint32_t b;
+    Scalar nx;
+    Scalar ny;
+    Scalar penetration;
+};
+
+// Circle–circle contacts handled on packed arrays instead of through the per-pair shape dispatch.
+// The circles are copied into SoA arrays sorted by grid cell, so each circle's candidates are two
+// contiguous runs tested by a branch-free kernel; populations of equal radii get a specialization with the
+// radius folded into a constant. Contacts get resolveCollision's positional correction and restitution
+// impulse, with no angular impulse since a circle's contact normal passes through both centers. Unlike
+// resolveCollision they add no "normal" support force sources, resting circles are held up by the
+// correction and the impulses alone.
+class GranularSolver
+{
+private:
+    std::vector<Object *> circles; // Circles taken over this step
+
+    // Packed state, in cell order
+    std::vector<uint32_t> rank;   // Packed index of each circle in circles
+    std::vector<uint32_t> cellOf; // Cell of each packed circle
+    std::vector<Scalar> positionX, positionY;
+    std::vector<Scalar> velocityX, velocityY;
+    std::vector<Scalar> radius, invMass, restitution;
+
+    // Grid over the world bounds, cells are one largest diameter wide
+    Vec2 origin;
+    Vec2 extent;
+    Scalar cellSize = 1.0f;
+    int columns = 0;
+    int rows = 0;
+    std::vector<uint32_t> cellStart; // Offset of each cell's circles, one extra entry at the end
+
+    std::vector<std::vector<GranularContact>> blockContacts; // Contacts found by each detection task
+
+    void pack(); // Sort the circles by cell and copy their state
+
+    // Contacts of the packed circles [begin, end) with the circles after them
+    template <bool UniformRadius>
+    void detect(size_t begin, size_t end, std::vector<GranularContact> &contacts) const;
+
+    // Sequential impulses over one block's contacts, each sees the velocities left by the ones before it.
+    // Only positions and velocities change, no force sources are added.
+    void resolveBlock(const std::vector<GranularContact> &contacts, bool correctPosition);
+
+public:
+    // Constructors
+    GranularSolver(const Vec2 &min, const Vec2 &max);
+
+    // Methods
+    // Take over the ungrabbed circles up to GRANULAR_RADIUS_SPREAD median radii, flagging them in mask (indexed like objects).
+    // Pairs with at least one unflagged object stay with the generic narrowphase.
+    void select(const std::vector<Object *> &objects, std::vector<char> &mask);
+
+    // Detect and resolve the contacts among the selected circles, then write their bodies back. Returns the contact count.
+    // Iterations after the first only refine the impulses.
+    int resolve(int iterations = 1);
+};
@@ -0,0 +1,287 @@
+#include "Log.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "core/RingBuffer.hpp"
+
+namespace
+{
+    struct LogRecord
+    {
+        int64_t time = 0;    // microseconds since the log started
+        uint32_t thread = 0; // Order in which the thread first logged
+        LogLevel level = LOG_LEVEL_INFO;
+        LogCategory category = LOG_GENERAL;
+        uint16_t length = 0;
+        char text[LOG_MESSAGE_CAPACITY];
+    };
+
+    // Records of one thread, it is the only producer and the writer the only consumer
+    struct ThreadBuffer
+    {
+        RingBuffer<LogRecord, LOG_BUFFER_CAPACITY> records;
+        std::atomic<size_t> dropped{0};
+        std::atomic<bool> retired{false}; // Set once the thread has exited and will push nothing more
+        uint32_t thread = 0;
+    };
+
+    // Held by each logging thread, retires its buffer when the thread exits so the writer can free it
+    struct ThreadBufferOwner
+    {
+        ThreadBuffer *buffer;
+
+        ~ThreadBufferOwner()
+        {
+            buffer->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    class Logger
+    {
+    private:
+        std::mutex registryMutex;
+        std::vector<ThreadBuffer *> buffers; // Every thread that logged and has not been drained since it exited
+        uint32_t nextThread = 0;
+
+        std::mutex outputMutex;
+        FILE *output = stderr;
+
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+        std::condition_variable drained;
+        bool running = true;
+        uint64_t requestedPasses = 0; // Flush requests, each wants a full pass that started after it
+        uint64_t completedPasses = 0;
+        std::thread writer;
+
+        std::vector<LogRecord> batch;        // Writer scratch
+        std::vector<ThreadBuffer *> retired; // Buffers freed by the current drain
+
+        void run(); // Writer loop
+
+        void drain()
+        {
+            std::vector<ThreadBuffer *> snapshot;
+            {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                snapshot = buffers;
+            }
+
+            batch.clear();
+            retired.clear();
+            LogRecord record;
+            for (ThreadBuffer *buffer : snapshot)
+            {
+                // Checked before popping, so a retired buffer is empty once the loop is done
+                if (buffer->retired.load(std::memory_order_acquire))
+                    retired.push_back(buffer);
+                while (buffer->records.pop(record))
+                {
+                    batch.push_back(record);
+                }
+                size_t dropped = buffer->dropped.exchange(0, std::memory_order_relaxed);
+                if (dropped > 0)
+                {
+                    LogRecord note;
+                    note.time = batch.empty() ? 0 : batch.back().time;
+                    note.thread = buffer->thread;
+                    note.level = LOG_LEVEL_WARNING;
+                    auto result = fmt::format_to_n(note.text, sizeof(note.text), "{} records dropped, the thread's buffer was full", dropped);
+                    note.length = static_cast<uint16_t>(std::min(result.size, sizeof(note.text)));
+                    batch.push_back(note);
+                }
+            }
+
+            // Buffers of exited threads are done after their final drain
+            if (!retired.empty())
+            {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                for (ThreadBuffer *buffer : retired)
+                {
+                    buffers.erase(std::find(buffers.begin(), buffers.end(), buffer));
+                    delete buffer;
+                }
+            }
+            if (batch.empty())
+                return;
+
+            // Threads are drained one after another, put their records back in time order
+            std::stable_sort(batch.begin(), batch.end(), [](const LogRecord &a, const LogRecord &b)
+                             { return a.time < b.time; });
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            for (const LogRecord &entry : batch)
+            {
+                fmt::print(output, "[{:10.6f} t{}] {:<7} {}: {}\n", entry.time * 1e-6, entry.thread, Log::levelName(entry.level),
+                           Log::categoryName(entry.category), fmt::string_view(entry.text, entry.length));
+            }
+            std::fflush(output);
+        }
+
+    public:
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::atomic<unsigned char> levels[LOG_CATEGORY_COUNT];
+
+        Logger()
+        {
+            for (std::atomic<unsigned char> &level : levels)
+            {
+                level.store(NEWTON_LOG_LEVEL, std::memory_order_relaxed);
+            }
+            writer = std::thread(&Logger::run, this);
+        }
+
+        ~Logger()
+        {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                running = false;
+            }
+            wake.notify_all();
+            writer.join();
+            drain();
+            if (output != stderr)
+                std::fclose(output);
+            // Threads still running keep their buffers, their owners retire them on exit
+        }
+
+        ThreadBuffer *registerThread()
+        {
+            ThreadBuffer *buffer = new ThreadBuffer();
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffer->thread = nextThread++;
+            buffers.push_back(buffer);
+            return buffer;
+        }
+
+        void flush()
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            uint64_t pass = ++requestedPasses;
+            wake.notify_all();
+            drained.wait(lock, [this, pass]
+                         { return completedPasses >= pass || !running; });
+        }
+
+        bool open(const std::string &path)
+        {
+            FILE *file = stderr;
+            if (!path.empty())
+            {
+                file = std::fopen(path.c_str(), "w");
+                if (file == nullptr)
+                    return false;
+            }
+
+            // Earlier records still go to the previous target
+            flush();
+            std::lock_guard<std::mutex> lock(outputMutex);
+            if (output != stderr)
+                std::fclose(output);
+            output = file;
+            return true;
+        }
+    };
+
+    void Logger::run()
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        while (running)
+        {
+            wake.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL), [this]
+                          { return requestedPasses > completedPasses || !running; });
+            uint64_t pass = requestedPasses;
+            lock.unlock();
+            drain();
+            lock.lock();
+            completedPasses = pass;
+            drained.notify_all();
+        }
+    }
+
+    Logger &logger()
+    {
+        static Logger instance;
+        return instance;
+    }
+}
+
+namespace Log
+{
+    bool enabled(LogLevel level, LogCategory category)
+    {
+        return level >= logger().levels[category].load(std::memory_order_relaxed);
+    }
+
+    void setLevel(LogLevel level)
+    {
+        for (int category = 0; category < LOG_CATEGORY_COUNT; category++)
+        {
+            setLevel(static_cast<LogCategory>(category), level);
+        }
+    }
+
+    void setLevel(LogCategory category, LogLevel level)
+    {
+        logger().levels[category].store(level, std::memory_order_relaxed);
+    }
+
+    bool open(const std::string &path)
+    {
+        return logger().open(path);
+    }
+
+    void flush()
+    {
+        logger().flush();
+    }
+
+    void submit(LogLevel level, LogCategory category, const char *text, size_t length)
+    {
+        Logger &log = logger();
+        thread_local ThreadBufferOwner owner{log.registerThread()};
+        ThreadBuffer *buffer = owner.buffer;
+
+        LogRecord record;
+        record.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - log.start).count();
+        record.thread = buffer->thread;
+        record.level = level;
+        record.category = category;
+        record.length = static_cast<uint16_t>(length);
+        std::memcpy(record.text, text, length);
+        if (!buffer->records.push(record))
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const char *levelName(LogLevel level)
+    {
+        static const char *names[] = {"trace", "debug", "info", "warning", "error", "off"};
+        return names[level];
+    }
+
+    const char *categoryName(LogCategory category)
+    {
+        static const char *names[] = {"general", "collision", "solver", "fluid", "spring", "scene", "export"};
+        static_assert(sizeof(names) / sizeof(names[0]) == LOG_CATEGORY_COUNT, "Every log category needs a name");
+        return names[category];
+    }
+
+    bool parseLevel(const std::string &name, LogLevel &level)
+    {
+        for (int candidate = LOG_LEVEL_TRACE; candidate <= LOG_LEVEL_OFF; candidate++)
+        {
+            if (name == levelName(static_cast<LogLevel>(candidate)))
+            {
+                level = static_cast<LogLevel>(candidate);
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Config.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <fmt/format.h>
+
+enum LogLevel : unsigned char
+{
+    LOG_LEVEL_TRACE,
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARNING,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_OFF
+};
+
+enum LogCategory : unsigned char
+{
+    LOG_GENERAL,
+    LOG_COLLISION,
+    LOG_SOLVER,
+    LOG_FLUID,
+    LOG_SPRING,
+    LOG_SCENE,
+    LOG_EXPORT,
+    LOG_CATEGORY_COUNT // Number of categories, keep last
+};
+
+// Lowest level compiled in, statements below it disappear from the build. Set with -DNEWTON_LOG_LEVEL=<0-5>.
+#ifndef NEWTON_LOG_LEVEL
+#ifdef NDEBUG
+#define NEWTON_LOG_LEVEL LOG_LEVEL_INFO
+#else
+#define NEWTON_LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
+// Asynchronous log. Each thread formats its records into its own lock-free buffer and a background writer
+// drains them to the console or a file, so logging from the engine never waits on I/O or other threads.
+// Records that find their thread's buffer full are dropped and counted.
+namespace Log
+{
+    bool enabled(LogLevel level, LogCategory category); // Whether records would pass the runtime filter
+    void setLevel(LogLevel level);                      // Runtime minimum level of every category
+    void setLevel(LogCategory category, LogLevel level);
+    bool open(const std::string &path); // Write to a file from now on, empty goes back to the console
+    void flush();                       // Block until everything logged so far is written
+
+    // Queue one preformatted message on the calling thread's buffer
+    void submit(LogLevel level, LogCategory category, const char *text, size_t length);
+
+    template <typename... Args>
+    void write(LogLevel level, LogCategory category, fmt::format_string<Args...> format, Args &&...args)
+    {
+        char text[LOG_MESSAGE_CAPACITY];
+        auto result = fmt::format_to_n(text, sizeof(text), format, std::forward<Args>(args)...);
+        submit(level, category, text, std::min(result.size, sizeof(text)));
+    }
+
+    const char *levelName(LogLevel level);
+    const char *categoryName(LogCategory category);
+    bool parseLevel(const std::string &name, LogLevel &level);
+}
+
+// Formatting happens on the calling thread only when the record passes both filters
+#define NEWTON_LOG(level, category, ...)                  \
+    do                                                    \
+    {                                                     \
+        if constexpr ((level) >= NEWTON_LOG_LEVEL)        \
+        {                                                 \
+            if (Log::enabled(level, category))            \
+                Log::write(level, category, __VA_ARGS__); \
+        }                                                 \
+    } while (0)
+
+#define LOG_TRACE(category, ...) NEWTON_LOG(LOG_LEVEL_TRACE, category, __VA_ARGS__)
+#define LOG_DEBUG(category, ...) NEWTON_LOG(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#define LOG_INFO(category, ...) NEWTON_LOG(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#define LOG_WARNING(category, ...) NEWTON_LOG(LOG_LEVEL_WARNING, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) NEWTON_LOG(LOG_LEVEL_ERROR, category, __VA_ARGS__)
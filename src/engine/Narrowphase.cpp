@@ -0,0 +1,135 @@
+#include "Narrowphase.hpp"
+
+#include <algorithm>
+#include "engine/ThreadPool.hpp"
+
+void PairBucket::clear()
+{
+    a.clear();
+    b.clear();
+}
+
+size_t PairBucket::size() const
+{
+    return a.size();
+}
+
+// Built-in kernels, the pairs are independent so the circle tests split across threads
+static void circleCircleKernel(PairBucket &bucket)
+{
+    ThreadPool::shared().parallelFor(bucket.size(), [&bucket](size_t begin, size_t end)
+                                     {
+        for (size_t k = begin; k < end; k++)
+        {
+            bucket.results[k] = checkCircleCircleCollision(bucket.a[k], bucket.b[k]);
+        } }, PARALLEL_MIN_CHUNK);
+}
+
+static void circleRectKernel(PairBucket &bucket)
+{
+    ThreadPool::shared().parallelFor(bucket.size(), [&bucket](size_t begin, size_t end)
+                                     {
+        for (size_t k = begin; k < end; k++)
+        {
+            bucket.results[k] = checkCircleRectCollision(bucket.a[k], bucket.b[k]);
+        } }, PARALLEL_MIN_CHUNK);
+}
+
+// Rectangle pairs go through the batched SAT pass, contact points only for the overlapping ones.
+// Each box is built once, the contact pass reads it back from the batch.
+static void rectRectKernel(PairBucket &bucket)
+{
+    thread_local BoxPairBatch batch;
+    batch.clear();
+    for (size_t k = 0; k < bucket.size(); k++)
+    {
+        batch.push(makeBox(bucket.a[k]), makeBox(bucket.b[k]));
+    }
+    batch.run();
+
+    for (size_t k = 0; k < bucket.size(); k++)
+    {
+        CollisionInfo &info = bucket.results[k];
+        info.isColliding = batch.overlap[k] > 0;
+        if (!info.isColliding)
+            continue;
+        info.penetration = batch.overlap[k];
+        info.normal = Vec2(batch.nx[k], batch.ny[k]);
+        info.contact = boxContactPoint(batch.boxA(k), batch.boxB(k), info.normal, batch.axis[k]);
+    }
+}
+
+Narrowphase::Narrowphase()
+{
+    setKernel(CIRCLE, CIRCLE, circleCircleKernel);
+    setKernel(CIRCLE, RECTANGLE, circleRectKernel);
+    setKernel(RECTANGLE, RECTANGLE, rectRectKernel);
+}
+
+void Narrowphase::setKernel(ShapeType first, ShapeType second, PairKernel kernel)
+{
+    kernels[std::min(first, second)][std::max(first, second)] = kernel;
+}
+
+void Narrowphase::clear()
+{
+    for (auto &row : buckets)
+    {
+        for (PairBucket &bucket : row)
+        {
+            bucket.clear();
+        }
+    }
+}
+
+void Narrowphase::add(Object *objA, Object *objB)
+{
+    if (objA->isGrabbed || objB->isGrabbed)
+        return;
+    if (objA->shapeType > objB->shapeType)
+        std::swap(objA, objB);
+    PairBucket &bucket = buckets[objA->shapeType][objB->shapeType];
+    bucket.a.push_back(objA);
+    bucket.b.push_back(objB);
+}
+
+void Narrowphase::run()
+{
+    for (int first = 0; first < SHAPE_TYPE_COUNT; first++)
+    {
+        for (int second = first; second < SHAPE_TYPE_COUNT; second++)
+        {
+            PairBucket &bucket = buckets[first][second];
+            bucket.results.resize(bucket.size());
+            for (CollisionInfo &info : bucket.results)
+            {
+                info.isColliding = false;
+            }
+            if (kernels[first][second] != nullptr && bucket.size() > 0)
+                kernels[first][second](bucket);
+        }
+    }
+}
+
+int Narrowphase::resolve(Scalar dt, int iterations)
+{
+    int contacts = 0;
+    for (int iteration = 0; iteration < std::max(iterations, 1); iteration++)
+    {
+        for (int first = 0; first < SHAPE_TYPE_COUNT; first++)
+        {
+            for (int second = first; second < SHAPE_TYPE_COUNT; second++)
+            {
+                PairBucket &bucket = buckets[first][second];
+                for (size_t k = 0; k < bucket.size(); k++)
+                {
+                    if (!bucket.results[k].isColliding)
+                        continue;
+                    contacts += iteration == 0;
+                    resolveCollision(bucket.a[k], bucket.b[k], bucket.results[k], dt, iteration == 0);
+                }
+            }
+        }
+    }
+    return contacts;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Config.h"
+
+#include <vector>
+#include "engine/Collision.hpp"
+#include "objects/Object.hpp"
+
+// Candidate pairs of one shape combination, stored with the lower shape type first
+struct PairBucket
+{
+    std::vector<Object *> a;
+    std::vector<Object *> b;
+    std::vector<CollisionInfo> results; // Filled by the bucket's kernel, normals point from b to a
+
+    void clear();
+    size_t size() const;
+};
+
+// Tests every pair of a bucket, writing one result per pair
+using PairKernel = void (*)(PairBucket &bucket);
+
+// Narrowphase over the broadphase's candidate pairs. Pairs are normalized so the lower shape type comes
+// first and appended to the bucket of their shape combination, then each bucket is tested by its own kernel
+// over contiguous arrays, so the shape checks happen once per pair instead of inside every test and a
+// kernel only ever sees one combination. New shapes plug in with setKernel.
+class Narrowphase
+{
+private:
+    PairBucket buckets[SHAPE_TYPE_COUNT][SHAPE_TYPE_COUNT]; // Only entries with the first shape <= the second are used
+    PairKernel kernels[SHAPE_TYPE_COUNT][SHAPE_TYPE_COUNT] = {};
+
+public:
+    // Constructors
+    Narrowphase(); // Registers the built-in circle and rectangle kernels
+
+    // Methods
+    void setKernel(ShapeType first, ShapeType second, PairKernel kernel);
+
+    void clear();
+    void add(Object *objA, Object *objB); // Queue a candidate pair, grabbed objects never collide
+    void run();                           // Test the queued pairs
+
+    // Resolve the colliding pairs bucket by bucket, returns the contact count.
+    // Iterations after the first only refine the impulses, the positions are corrected once.
+    int resolve(Scalar dt, int iterations = 1);
+};
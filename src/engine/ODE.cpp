@@ -1,194 +1,504 @@
 #include "ODE.hpp"
 
-void EulerSolver::step(float dt)
+// Rates of change of a body's state
+struct Derivative
 {
-    Body *body = object->body;
-
-    body->netForce = object->getNetForce().force;
-    body->acceleration = body->netForce * body->invMass;
-    body->velocity += body->acceleration * dt;
-    body->position += body->velocity * dt;
+    Vec2 velocity;
+    Vec2 acceleration;
+    Scalar angularVelocity = 0.0f;
+    Scalar angularAcceleration = 0.0f;
+    Vec2 force;
+    Scalar torque = 0.0f;
+};
+
+// Add one force to a derivative, torque comes from the force's application point
+static inline void accumulate(Derivative &d, const Force &f)
+{
+    d.force += f.force;
+    d.torque += cross(f.position, f.force) + f.torque;
 }
-Body EulerSolver::simulate(float dt)
+
+// Rates from the summed force and torque
+static inline void finish(Derivative &d, const Body &state)
 {
-    Body tempBody = *object->body;
+    d.velocity = state.velocity;
+    d.acceleration = d.force * state.invMass;
+    d.angularVelocity = state.angularVelocity;
+    d.angularAcceleration = d.torque * state.invInertia;
+}
 
-    tempBody.netForce = object->getNetForce().force;
-    tempBody.acceleration = tempBody.netForce * tempBody.invMass;
-    tempBody.velocity += tempBody.acceleration * dt;
-    tempBody.position += tempBody.velocity * dt;
-    return tempBody;
+// Evaluate every force source at the given state
+static inline Derivative evaluate(const Object &object, const Body &state)
+{
+    Derivative d;
+    for (const ForceSource &source : object.getForces())
+    {
+        accumulate(d, source.calculateForce(state));
+    }
+    finish(d, state);
+    return d;
 }
 
-void RK2Solver::step(float dt)
+// Pending evaluator call of one source of one body in a stage
+struct StageCall
+{
+    const ForceEvaluator *evaluator;
+    int index;
+    size_t body;
+};
+
+// Evaluate a stage of count objects at the given states. The evaluator sources of all of them are gathered
+// and each evaluator is called once, so a batched one runs over the whole stage. The forces are then summed
+// in source order, the derivatives equal evaluate()'s.
+static void evaluateStage(Object *const *objects, const Body *states, size_t count, Derivative *d)
 {
-    Body *body = object->body;
+    thread_local std::vector<StageCall> calls;
+    thread_local std::vector<Force> results;
+    thread_local std::vector<const Body *> callStates;
+    thread_local std::vector<int> callIndices;
+    thread_local std::vector<size_t> callSlots;
+    thread_local std::vector<Force> callForces;
+    thread_local std::vector<char> done;
+
+    calls.clear();
+    for (size_t k = 0; k < count; k++)
+    {
+        for (const ForceSource &source : objects[k]->getForces())
+        {
+            if (source.getEvaluator() != nullptr)
+                calls.push_back({source.getEvaluator(), source.getEvaluatorIndex(), k});
+        }
+    }
+    results.resize(calls.size());
+    done.assign(calls.size(), 0);
 
-    // K1: Evaluate at the current state
-    body->netForce = object->getNetForce().force;
-    Vec2 k1_acceleration = body->netForce * body->invMass;
-    Vec2 k1_velocity = body->velocity;
+    // One call per distinct evaluator, there are only a few per world
+    for (size_t first = 0; first < calls.size(); first++)
+    {
+        if (done[first])
+            continue;
+        const ForceEvaluator *evaluator = calls[first].evaluator;
+        callStates.clear();
+        callIndices.clear();
+        callSlots.clear();
+        for (size_t c = first; c < calls.size(); c++)
+        {
+            if (calls[c].evaluator != evaluator)
+                continue;
+            done[c] = 1;
+            callStates.push_back(&states[calls[c].body]);
+            callIndices.push_back(calls[c].index);
+            callSlots.push_back(c);
+        }
+        callForces.resize(callSlots.size());
+        evaluator->evaluateAll(callStates.data(), callIndices.data(), callSlots.size(), callForces.data());
+        for (size_t c = 0; c < callSlots.size(); c++)
+        {
+            results[callSlots[c]] = callForces[c];
+        }
+    }
 
-    // K2: Evaluate at the midpoint using K1
-    Body midBody = *body;
-    midBody.position = body->position + k1_velocity * (dt * 0.5f);
-    midBody.velocity = body->velocity + k1_acceleration * (dt * 0.5f);
-    midBody.netForce = Vec2(0.0f, 0.0f);
+    size_t next = 0;
+    for (size_t k = 0; k < count; k++)
+    {
+        d[k] = Derivative();
+        for (const ForceSource &source : objects[k]->getForces())
+        {
+            accumulate(d[k], source.getEvaluator() != nullptr ? results[next++] : source.calculateForce(states[k]));
+        }
+        finish(d[k], states[k]);
+    }
+}
 
-    Vec2 k2_velocity = midBody.velocity;
-    Vec2 k2_acceleration = Vec2(0.0f, 0.0f);
+// Per-thread state of a batch stepped together
+struct StageBuffers
+{
+    std::vector<Body> start, stage;
+    std::vector<Derivative> k1, k2, k3, k4;
 
-    for (auto forceSource : object->getForces())
+    void gather(Object *const *objects, size_t count)
     {
-        k2_acceleration += forceSource->calculateForce(midBody).force * body->invMass;
+        start.clear();
+        for (size_t k = 0; k < count; k++)
+        {
+            start.push_back(*objects[k]->body);
+        }
+        stage.resize(count, start[0]); // Overwritten by every stage
+        k1.resize(count);
+        k2.resize(count);
+        k3.resize(count);
+        k4.resize(count);
     }
+};
 
-    // Update using K2 (the midpoint slope)
-    body->velocity += k2_acceleration * dt;
-    body->position += k2_velocity * dt;
-    body->acceleration = k2_acceleration;
+static thread_local StageBuffers stageBuffers;
+
+// State advanced along a derivative, used for the intermediate stages
+static inline Body advance(const Body &state, const Derivative &d, Scalar dt)
+{
+    Body next = state;
+    next.position = state.position + d.velocity * dt;
+    next.velocity = state.velocity + d.acceleration * dt;
+    next.angle = state.angle + d.angularVelocity * dt;
+    next.angularVelocity = state.angularVelocity + d.angularAcceleration * dt;
+    next.netForce = Vec2(0.0f, 0.0f);
+    return next;
 }
-Body RK2Solver::simulate(float dt)
+
+// A force set with only constant and linear sources, summed: F(p, v) = constant + positionGain·p + velocityGain·v
+struct LinearForces
 {
-    Body tempBody = *object->body;
+    Vec2 constant;
+    Scalar positionGain = 0.0f;
+    Scalar velocityGain = 0.0f;
+    Scalar torque = 0.0f; // Linear forces act at the center, so only constant ones add torque
 
-    // K1: Evaluate at the current state
-    tempBody.netForce = object->getNetForce().force;
-    Vec2 k1_acceleration = tempBody.netForce * tempBody.invMass;
-    Vec2 k1_velocity = tempBody.velocity;
+    Vec2 at(const Vec2 &position, const Vec2 &velocity) const
+    {
+        return constant + position * positionGain + velocity * velocityGain;
+    }
+};
 
-    // K2: Evaluate at the midpoint using K1
-    Body midBody = tempBody;
-    midBody.position = tempBody.position + k1_velocity * (dt * 0.5f);
-    midBody.velocity = tempBody.velocity + k1_acceleration * (dt * 0.5f);
-    midBody.netForce = Vec2(0.0f, 0.0f);
+static inline LinearForces collectLinear(const Object &object)
+{
+    LinearForces sum;
+    for (const ForceSource &source : object.getForces())
+    {
+        if (source.getKind() == LINEAR_FORCE)
+        {
+            sum.constant += source.getOffset();
+            sum.positionGain += source.getPositionGain();
+            sum.velocityGain += source.getVelocityGain();
+        }
+        else
+        {
+            Force f = source.calculateForce(*object.body);
+            sum.constant += f.force;
+            sum.torque += cross(f.position, f.force) + f.torque;
+        }
+    }
+    return sum;
+}
+
+// Exact step under a constant force and torque, p + v·dt + ½a·dt². RK2 and RK4 reproduce it with 2 or 4 evaluations.
+static inline Body simulateConstant(const Object &object, Scalar dt)
+{
+    Body next = *object.body;
+    LinearForces forces = collectLinear(object);
+    Vec2 acceleration = forces.constant * next.invMass;
+    Scalar angularAcceleration = forces.torque * next.invInertia;
+
+    next.netForce = forces.constant;
+    next.netTorque = forces.torque;
+    next.acceleration = acceleration;
+    next.angularAcceleration = angularAcceleration;
+    next.position += (next.velocity + acceleration * (dt * 0.5f)) * dt;
+    next.velocity += acceleration * dt;
+    next.angle += (next.angularVelocity + angularAcceleration * (dt * 0.5f)) * dt;
+    next.angularVelocity += angularAcceleration * dt;
+    return next;
+}
 
-    Vec2 k2_velocity = midBody.velocity;
-    Vec2 k2_acceleration = Vec2(0.0f, 0.0f);
+// Constant angular acceleration part of a linear step, exact like the constant case
+static inline void rotateConstant(Body &next, const LinearForces &forces, Scalar dt)
+{
+    Scalar angularAcceleration = forces.torque * next.invInertia;
+    next.netTorque = forces.torque;
+    next.angularAcceleration = angularAcceleration;
+    next.angle += (next.angularVelocity + angularAcceleration * (dt * 0.5f)) * dt;
+    next.angularVelocity += angularAcceleration * dt;
+}
+
+// Euler step from a state and its slope
+static inline Body combineEuler(const Body &start, const Derivative &k1, Scalar dt)
+{
+    Body tempBody = start;
+    tempBody.netForce = k1.force;
+    tempBody.netTorque = k1.torque;
+    tempBody.acceleration = k1.acceleration;
+    tempBody.angularAcceleration = k1.angularAcceleration;
+
+    // Semi-implicit: the position uses the updated velocity
+    tempBody.velocity += k1.acceleration * dt;
+    tempBody.position += tempBody.velocity * dt;
+    tempBody.angularVelocity += k1.angularAcceleration * dt;
+    tempBody.angle += tempBody.angularVelocity * dt;
+    return tempBody;
+}
 
-    for (auto forceSource : object->getForces())
+Body EulerSolver::simulate(const Object &object, Scalar dt)
+{
+    return combineEuler(*object.body, evaluate(object, *object.body), dt);
+}
+void EulerSolver::step(Object &object, Scalar dt)
+{
+    *object.body = simulate(object, dt);
+}
+void EulerSolver::stepAll(Object *const *objects, size_t count, Scalar dt)
+{
+    StageBuffers &b = stageBuffers;
+    b.gather(objects, count);
+    evaluateStage(objects, b.start.data(), count, b.k1.data());
+    for (size_t k = 0; k < count; k++)
     {
-        k2_acceleration += forceSource->calculateForce(midBody).force * tempBody.invMass;
+        *objects[k]->body = combineEuler(b.start[k], b.k1[k], dt);
     }
+}
 
-    // Update using K2 (the midpoint slope)
-    tempBody.velocity += k2_acceleration * dt;
-    tempBody.position += k2_velocity * dt;
-    tempBody.acceleration = k2_acceleration;
+// RK2 stages for a linear force set, evaluated without calling the force sources or copying bodies
+static inline Body simulateLinearRK2(const Object &object, Scalar dt)
+{
+    Body next = *object.body;
+    LinearForces forces = collectLinear(object);
+    Scalar invMass = next.invMass;
+
+    Vec2 p1 = next.position, v1 = next.velocity;
+    Vec2 f1 = forces.at(p1, v1);
+    Vec2 a1 = f1 * invMass;
+    Vec2 p2 = p1 + v1 * (dt * 0.5f), v2 = v1 + a1 * (dt * 0.5f);
+    Vec2 a2 = forces.at(p2, v2) * invMass;
+
+    next.netForce = f1;
+    next.velocity += a2 * dt;
+    next.position += v2 * dt;
+    next.acceleration = a2;
+    rotateConstant(next, forces, dt);
+    return next;
+}
+
+// Update using K2 (the midpoint slope)
+static inline Body combineRK2(const Body &start, const Derivative &k1, const Derivative &k2, Scalar dt)
+{
+    Body tempBody = start;
+    tempBody.netForce = k1.force;
+    tempBody.netTorque = k1.torque;
+    tempBody.velocity += k2.acceleration * dt;
+    tempBody.position += k2.velocity * dt;
+    tempBody.acceleration = k2.acceleration;
+    tempBody.angularVelocity += k2.angularAcceleration * dt;
+    tempBody.angle += k2.angularVelocity * dt;
+    tempBody.angularAcceleration = k2.angularAcceleration;
 
     return tempBody;
 }
 
-void RK4Solver::step(float dt)
+Body RK2Solver::simulate(const Object &object, Scalar dt)
 {
-    Body *body = object->body;
+    // Constant forces have a closed form, linear ones need no force calls
+    switch (object.getForceKind())
+    {
+    case CONSTANT_FORCE:
+        return simulateConstant(object, dt);
+    case LINEAR_FORCE:
+        return simulateLinearRK2(object, dt);
+    default:
+        break;
+    }
+
+    const Body &start = *object.body;
 
     // K1: Evaluate at the current state
-    body->netForce = object->getNetForce().force;
-    Vec2 k1_acceleration = body->netForce * body->invMass;
-    Vec2 k1_velocity = body->velocity;
+    Derivative k1 = evaluate(object, start);
 
     // K2: Evaluate at the midpoint using K1
-    Body k2Body = *body;
-    k2Body.position = body->position + k1_velocity * (dt * 0.5f);
-    k2Body.velocity = body->velocity + k1_acceleration * (dt * 0.5f);
-    k2Body.netForce = Vec2(0.0f, 0.0f);
+    Derivative k2 = evaluate(object, advance(start, k1, dt * 0.5f));
+
+    return combineRK2(start, k1, k2, dt);
+}
+void RK2Solver::step(Object &object, Scalar dt)
+{
+    *object.body = simulate(object, dt);
+}
+void RK2Solver::stepAll(Object *const *objects, size_t count, Scalar dt)
+{
+    // Every body goes through each stage before the next, so a stage's shared forces are one call
+    StageBuffers &b = stageBuffers;
+    b.gather(objects, count);
+    evaluateStage(objects, b.start.data(), count, b.k1.data());
+    for (size_t k = 0; k < count; k++)
+    {
+        b.stage[k] = advance(b.start[k], b.k1[k], dt * 0.5f);
+    }
+    evaluateStage(objects, b.stage.data(), count, b.k2.data());
+    for (size_t k = 0; k < count; k++)
+    {
+        *objects[k]->body = combineRK2(b.start[k], b.k1[k], b.k2[k], dt);
+    }
+}
+
+// RK4 stages for a linear force set, evaluated without calling the force sources or copying bodies
+static inline Body simulateLinearRK4(const Object &object, Scalar dt)
+{
+    Body next = *object.body;
+    LinearForces forces = collectLinear(object);
+    Scalar invMass = next.invMass;
+
+    Vec2 p1 = next.position, v1 = next.velocity;
+    Vec2 f1 = forces.at(p1, v1);
+    Vec2 a1 = f1 * invMass;
+    Vec2 p2 = p1 + v1 * (dt * 0.5f), v2 = v1 + a1 * (dt * 0.5f);
+    Vec2 a2 = forces.at(p2, v2) * invMass;
+    Vec2 p3 = p1 + v2 * (dt * 0.5f), v3 = v1 + a2 * (dt * 0.5f);
+    Vec2 a3 = forces.at(p3, v3) * invMass;
+    Vec2 p4 = p1 + v3 * dt, v4 = v1 + a3 * dt;
+    Vec2 a4 = forces.at(p4, v4) * invMass;
+
+    next.netForce = f1;
+    next.acceleration = (a1 + a2 * 2.0f + a3 * 2.0f + a4) / 6.0f;
+    next.velocity += next.acceleration * dt;
+    next.position += (v1 + v2 * 2.0f + v3 * 2.0f + v4) * (dt / 6.0f);
+    rotateConstant(next, forces, dt);
+    return next;
+}
+
+// Weighted average: (k1 + 2*k2 + 2*k3 + k4) / 6
+static inline Body combineRK4(const Body &start, const Derivative &k1, const Derivative &k2, const Derivative &k3, const Derivative &k4, Scalar dt)
+{
+    Body tempBody = start;
+    tempBody.netForce = k1.force;
+    tempBody.netTorque = k1.torque;
+    tempBody.acceleration = (k1.acceleration + k2.acceleration * 2.0f + k3.acceleration * 2.0f + k4.acceleration) / 6.0f;
+    tempBody.velocity += tempBody.acceleration * dt;
+    tempBody.position += (k1.velocity + k2.velocity * 2.0f + k3.velocity * 2.0f + k4.velocity) * (dt / 6.0f);
+    tempBody.angularAcceleration = (k1.angularAcceleration + k2.angularAcceleration * 2.0f + k3.angularAcceleration * 2.0f + k4.angularAcceleration) / 6.0f;
+    tempBody.angularVelocity += tempBody.angularAcceleration * dt;
+    tempBody.angle += (k1.angularVelocity + k2.angularVelocity * 2.0f + k3.angularVelocity * 2.0f + k4.angularVelocity) * (dt / 6.0f);
 
-    Vec2 k2_velocity = k2Body.velocity;
-    Vec2 k2_acceleration = Vec2(0.0f, 0.0f);
+    return tempBody;
+}
 
-    for (auto forceSource : object->getForces())
+Body RK4Solver::simulate(const Object &object, Scalar dt)
+{
+    // Constant forces have a closed form, linear ones need no force calls
+    switch (object.getForceKind())
     {
-        k2_acceleration += forceSource->calculateForce(k2Body).force * body->invMass;
+    case CONSTANT_FORCE:
+        return simulateConstant(object, dt);
+    case LINEAR_FORCE:
+        return simulateLinearRK4(object, dt);
+    default:
+        break;
     }
 
+    const Body &start = *object.body;
+
+    // K1: Evaluate at the current state
+    Derivative k1 = evaluate(object, start);
+
+    // K2: Evaluate at the midpoint using K1
+    Derivative k2 = evaluate(object, advance(start, k1, dt * 0.5f));
+
     // K3: Evaluate at the midpoint using K2
-    Body k3Body = *body;
-    k3Body.position = body->position + k2_velocity * (dt * 0.5f);
-    k3Body.velocity = body->velocity + k2_acceleration * (dt * 0.5f);
-    k3Body.netForce = Vec2(0.0f, 0.0f);
+    Derivative k3 = evaluate(object, advance(start, k2, dt * 0.5f));
 
-    Vec2 k3_velocity = k3Body.velocity;
-    Vec2 k3_acceleration = Vec2(0.0f, 0.0f);
+    // K4: Evaluate at the endpoint using K3
+    Derivative k4 = evaluate(object, advance(start, k3, dt));
+
+    return combineRK4(start, k1, k2, k3, k4, dt);
+}
+void RK4Solver::step(Object &object, Scalar dt)
+{
+    *object.body = simulate(object, dt);
+}
+void RK4Solver::stepAll(Object *const *objects, size_t count, Scalar dt)
+{
+    // Every body goes through each stage before the next, so a stage's shared forces are one call
+    StageBuffers &b = stageBuffers;
+    b.gather(objects, count);
+    evaluateStage(objects, b.start.data(), count, b.k1.data());
+    for (size_t k = 0; k < count; k++)
+    {
+        b.stage[k] = advance(b.start[k], b.k1[k], dt * 0.5f);
+    }
+    evaluateStage(objects, b.stage.data(), count, b.k2.data());
+    for (size_t k = 0; k < count; k++)
+    {
+        b.stage[k] = advance(b.start[k], b.k2[k], dt * 0.5f);
+    }
+    evaluateStage(objects, b.stage.data(), count, b.k3.data());
+    for (size_t k = 0; k < count; k++)
+    {
+        b.stage[k] = advance(b.start[k], b.k3[k], dt);
+    }
+    evaluateStage(objects, b.stage.data(), count, b.k4.data());
+    for (size_t k = 0; k < count; k++)
+    {
+        *objects[k]->body = combineRK4(b.start[k], b.k1[k], b.k2[k], b.k3[k], b.k4[k], dt);
+    }
+}
 
-    for (auto forceSource : object->getForces())
+template <typename Solver>
+static void stepBatch(Object *const *objects, size_t count, Scalar dt)
+{
+    Solver::stepAll(objects, count, dt);
+    for (size_t k = 0; k < count; k++)
     {
-        k3_acceleration += forceSource->calculateForce(k3Body).force * body->invMass;
+        objects[k]->finishStep();
     }
+}
 
-    // K4: Evaluate at the endpoint using K3
-    Body k4Body = *body;
-    k4Body.position = body->position + k3_velocity * dt;
-    k4Body.velocity = body->velocity + k3_acceleration * dt;
-    k4Body.netForce = Vec2(0.0f, 0.0f);
-
-    Vec2 k4_velocity = k4Body.velocity;
-    Vec2 k4_acceleration = Vec2(0.0f, 0.0f);
-
-    for (auto forceSource : object->getForces())
-    {
-        k4_acceleration += forceSource->calculateForce(k4Body).force * body->invMass;
-    }
-
-    // Weighted average: (k1 + 2*k2 + 2*k3 + k4) / 6
-    body->velocity += (k1_acceleration + k2_acceleration * 2.0f + k3_acceleration * 2.0f + k4_acceleration) * (dt / 6.0f);
-    body->position += (k1_velocity + k2_velocity * 2.0f + k3_velocity * 2.0f + k4_velocity) * (dt / 6.0f);
-    body->acceleration = (k1_acceleration + k2_acceleration * 2.0f + k3_acceleration * 2.0f + k4_acceleration) / 6.0f;
-}
-Body RK4Solver::simulate(float dt) {
-     Body tempBody = *object->body;
-
-        // K1: Evaluate at the current state
-        tempBody.netForce = object->getNetForce().force;
-        Vec2 k1_acceleration = tempBody.netForce * tempBody.invMass;
-        Vec2 k1_velocity = tempBody.velocity;
-
-        // K2: Evaluate at the midpoint using K1
-        Body k2Body = tempBody;
-        k2Body.position = tempBody.position + k1_velocity * (dt * 0.5f);
-        k2Body.velocity = tempBody.velocity + k1_acceleration * (dt * 0.5f);
-        k2Body.netForce = Vec2(0.0f, 0.0f);
-        
-        Vec2 k2_velocity = k2Body.velocity;
-        Vec2 k2_acceleration = Vec2(0.0f, 0.0f);
-        
-        for (auto forceSource : object->getForces())
+bool isSolverImplemented(SolverType type)
+{
+    return type == EULER || type == RK2 || type == RK4;
+}
+
+template <typename Solver>
+static void integrateRange(Object *const *objects, size_t count, Scalar dt)
+{
+    // Bodies with general forces are stepped in batches, the rest one by one
+    Object *batch[SOLVER_BATCH_SIZE];
+    size_t batched = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        Object *object = objects[i];
+        if (object->isStatic)
         {
-            k2_acceleration += forceSource->calculateForce(k2Body).force * tempBody.invMass;
+            object->finishStep();
         }
-
-        // K3: Evaluate at the midpoint using K2
-        Body k3Body = tempBody;
-        k3Body.position = tempBody.position + k2_velocity * (dt * 0.5f);
-        k3Body.velocity = tempBody.velocity + k2_acceleration * (dt * 0.5f);
-        k3Body.netForce = Vec2(0.0f, 0.0f);
-        
-        Vec2 k3_velocity = k3Body.velocity;
-        Vec2 k3_acceleration = Vec2(0.0f, 0.0f);
-        
-        for (auto forceSource : object->getForces())
+        else if (object->getForceKind() == GENERAL_FORCE)
         {
-            k3_acceleration += forceSource->calculateForce(k3Body).force * tempBody.invMass;
+            batch[batched++] = object;
+            if (batched == SOLVER_BATCH_SIZE)
+            {
+                stepBatch<Solver>(batch, batched, dt);
+                batched = 0;
+            }
         }
-
-        // K4: Evaluate at the endpoint using K3
-        Body k4Body = tempBody;
-        k4Body.position = tempBody.position + k3_velocity * dt;
-        k4Body.velocity = tempBody.velocity + k3_acceleration * dt;
-        k4Body.netForce = Vec2(0.0f, 0.0f);
-        
-        Vec2 k4_velocity = k4Body.velocity;
-        Vec2 k4_acceleration = Vec2(0.0f, 0.0f);
-        
-        for (auto forceSource : object->getForces())
+        else
         {
-            k4_acceleration += forceSource->calculateForce(k4Body).force * tempBody.invMass;
+            Solver::step(*object, dt);
+            object->finishStep();
         }
+    }
+    if (batched > 0)
+        stepBatch<Solver>(batch, batched, dt);
+}
+
+void integrateObjects(SolverType type, Object *const *objects, size_t count, Scalar dt)
+{
+    switch (type)
+    {
+    case EULER:
+        integrateRange<EulerSolver>(objects, count, dt);
+        break;
+    case RK2:
+        integrateRange<RK2Solver>(objects, count, dt);
+        break;
+    default:
+        integrateRange<RK4Solver>(objects, count, dt);
+        break;
+    }
+}
 
-        // Weighted average: (k1 + 2*k2 + 2*k3 + k4) / 6
-        tempBody.velocity += (k1_acceleration + k2_acceleration * 2.0f + k3_acceleration * 2.0f + k4_acceleration) * (dt / 6.0f);
-        tempBody.position += (k1_velocity + k2_velocity * 2.0f + k3_velocity * 2.0f + k4_velocity) * (dt / 6.0f);
-        tempBody.acceleration = (k1_acceleration + k2_acceleration * 2.0f + k3_acceleration * 2.0f + k4_acceleration) / 6.0f;
-        
-        return tempBody;
-}
\ No newline at end of file
+Body simulateObject(SolverType type, const Object &object, Scalar dt)
+{
+    switch (type)
+    {
+    case EULER:
+        return EulerSolver::simulate(object, dt);
+    case RK2:
+        return RK2Solver::simulate(object, dt);
+    default:
+        return RK4Solver::simulate(object, dt);
+    }
+}
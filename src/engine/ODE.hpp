@@ -39,81 +39,33 @@ inline std::string solverTypeToString(SolverType type)
     }
 }
 
-class ODESolver
+// Solver kernels are stateless, the world picks one per step and runs it over every body in a single monomorphic loop.
+// Bodies with general forces are stepped in batches that go through each stage together.
+struct EulerSolver
 {
-protected:
-    Object *object;
-
-public:
-    ODESolver(Object *initialState) : object(initialState) {}
-    virtual void step(float dt) = 0;
-    virtual Body simulate(float dt) = 0;
-    virtual ~ODESolver() = default;
-};
-
-class EulerSolver : public ODESolver
-{
-public:
-    EulerSolver(Object *initialState) : ODESolver(initialState) {}
-    void step(float dt) override;
-    Body simulate(float dt) override;
-};
-
-class RK2Solver : public ODESolver
-{
-public:
-    RK2Solver(Object *initialState) : ODESolver(initialState) {}
-    void step(float dt) override;
-    Body simulate(float dt) override;
+    static void step(Object &object, Scalar dt);
+    static void stepAll(Object *const *objects, size_t count, Scalar dt); // Bodies with general forces, stage by stage
+    static Body simulate(const Object &object, Scalar dt);
 };
 
-class RK4Solver : public ODESolver
+struct RK2Solver
 {
-public:
-    RK4Solver(Object *initialState) : ODESolver(initialState) {}
-    void step(float dt) override;
-    Body simulate(float dt) override;
+    static void step(Object &object, Scalar dt);
+    static void stepAll(Object *const *objects, size_t count, Scalar dt); // Bodies with general forces, stage by stage
+    static Body simulate(const Object &object, Scalar dt);
 };
 
-class VerletSolver : public ODESolver
+struct RK4Solver
 {
-private:
-    Vec2 previousPosition;
-    bool isFirstStep = true;
-public:
-    VerletSolver(Object *initialState) : ODESolver(initialState) {}
-    void step(float dt) override;
-    Body simulate(float dt) override;
+    static void step(Object &object, Scalar dt);
+    static void stepAll(Object *const *objects, size_t count, Scalar dt); // Bodies with general forces, stage by stage
+    static Body simulate(const Object &object, Scalar dt);
 };
 
-class DOPRI5Solver : public ODESolver
-{
-public:
-    DOPRI5Solver(Object *initialState) : ODESolver(initialState) {}
-    void step(float dt) override;
-    Body simulate(float dt) override;
-};
+bool isSolverImplemented(SolverType type); // Verlet, DOPRI5, AB and AM are not available yet
 
-class ABSolver : public ODESolver
-{
-private:
-    std::vector<Body> previousStates;
-public:
-    ABSolver(Object *initialState) : ODESolver(initialState) {
-        previousStates.reserve(5);
-    }
-    void step(float dt) override;
-    Body simulate(float dt) override;
-};
+// Step count objects with the given solver and finish their step, static objects are not integrated
+void integrateObjects(SolverType type, Object *const *objects, size_t count, Scalar dt);
 
-class AMSolver : public ODESolver
-{
-private:
-    std::vector<Body> previousStates;
-public:
-    AMSolver(Object *initialState) : ODESolver(initialState) {
-        previousStates.reserve(5);
-    }
-    void step(float dt) override;
-    Body simulate(float dt) override;
-};
\ No newline at end of file
+// Project one object a step ahead without mutating it
+Body simulateObject(SolverType type, const Object &object, Scalar dt);
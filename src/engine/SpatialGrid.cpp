@@ -0,0 +1,100 @@
+#include "SpatialGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(const Vec2 &min, const Vec2 &max, Scalar cellSize) : origin(min), cellSize(cellSize)
+{
+    columns = std::max(1, static_cast<int>(std::ceil((max.x - min.x) / cellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil((max.y - min.y) / cellSize)));
+}
+
+int SpatialGrid::cellX(Scalar x) const
+{
+    return std::clamp(static_cast<int>(std::floor((x - origin.x) / cellSize)), 0, columns - 1);
+}
+
+int SpatialGrid::cellY(Scalar y) const
+{
+    return std::clamp(static_cast<int>(std::floor((y - origin.y) / cellSize)), 0, rows - 1);
+}
+
+void SpatialGrid::build(const std::vector<Vec2> &mins, const std::vector<Vec2> &maxs)
+{
+    size_t count = mins.size();
+    itemMins = mins;
+    itemMaxs = maxs;
+    itemMinCell.resize(count * 2);
+    itemMaxCell.resize(count * 2);
+    stamps.assign(count, 0);
+    queryStamp = 0;
+    cellStart.assign(static_cast<size_t>(columns) * rows + 1, 0);
+
+    // Count items per cell
+    for (size_t i = 0; i < count; i++)
+    {
+        int x0 = cellX(mins[i].x), y0 = cellY(mins[i].y);
+        int x1 = cellX(maxs[i].x), y1 = cellY(maxs[i].y);
+        itemMinCell[i * 2] = x0;
+        itemMinCell[i * 2 + 1] = y0;
+        itemMaxCell[i * 2] = x1;
+        itemMaxCell[i * 2 + 1] = y1;
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                cellStart[y * columns + x + 1]++;
+            }
+        }
+    }
+
+    // Prefix sum into offsets, then scatter
+    for (size_t c = 1; c < cellStart.size(); c++)
+    {
+        cellStart[c] += cellStart[c - 1];
+    }
+    items.resize(cellStart.back());
+    std::vector<int> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int y = itemMinCell[i * 2 + 1]; y <= itemMaxCell[i * 2 + 1]; y++)
+        {
+            for (int x = itemMinCell[i * 2]; x <= itemMaxCell[i * 2]; x++)
+            {
+                items[cursor[y * columns + x]++] = static_cast<int>(i);
+            }
+        }
+    }
+}
+
+void SpatialGrid::query(const Vec2 &min, const Vec2 &max, std::vector<int> &result) const
+{
+    if (cellStart.empty())
+        return;
+
+    if (++queryStamp == 0)
+    {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        queryStamp = 1;
+    }
+
+    int x0 = cellX(min.x), y0 = cellY(min.y);
+    int x1 = cellX(max.x), y1 = cellY(max.y);
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            int cell = y * columns + x;
+            for (int k = cellStart[cell]; k < cellStart[cell + 1]; k++)
+            {
+                int item = items[k];
+                if (stamps[item] == queryStamp)
+                    continue;
+                stamps[item] = queryStamp;
+
+                if (itemMins[item].x <= max.x && itemMaxs[item].x >= min.x && itemMins[item].y <= max.y && itemMaxs[item].y >= min.y)
+                    result.push_back(item);
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include "math/Vec2.hpp"
+
+// Uniform grid over the world bounds, items are stored per cell in one contiguous array
+class SpatialGrid
+{
+private:
+    Vec2 origin; // World-space corner of cell (0, 0)
+    Scalar cellSize = 1.0f;
+    int columns = 0;
+    int rows = 0;
+
+    std::vector<int> cellStart; // Offset of each cell's items, one extra entry at the end
+    std::vector<int> items;     // Item indices sorted by cell
+
+    std::vector<Vec2> itemMins;               // Bounds of each item
+    std::vector<Vec2> itemMaxs;
+    std::vector<int> itemMinCell;             // Cell range covered by each item
+    std::vector<int> itemMaxCell;
+    mutable std::vector<unsigned int> stamps; // Per-item query stamps to report items spanning several cells once
+    mutable unsigned int queryStamp = 0;
+
+    int cellX(Scalar x) const;
+    int cellY(Scalar y) const;
+
+public:
+    // Constructors
+    SpatialGrid() = default;
+    SpatialGrid(const Vec2 &min, const Vec2 &max, Scalar cellSize);
+
+    // Methods
+    void build(const std::vector<Vec2> &mins, const std::vector<Vec2> &maxs); // Rebuild from item bounds
+
+    // Append every item whose bounds overlap [min, max] to result
+    void query(const Vec2 &min, const Vec2 &max, std::vector<int> &result) const;
+};
@@ -0,0 +1,221 @@
+#include "SpringNetwork.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include "engine/Log.hpp"
+#include "engine/ThreadPool.hpp"
+
+void SpringNetwork::add(const Spring &spring)
+{
+    if (spring.a == spring.b || spring.a.isNull() || spring.b.isNull())
+        return;
+    springs.push_back(spring);
+    dirty = true;
+}
+
+void SpringNetwork::removeBody(ObjectHandle handle)
+{
+    size_t count = springs.size();
+    springs.erase(std::remove_if(springs.begin(), springs.end(), [handle](const Spring &spring)
+                                 { return spring.a == handle || spring.b == handle; }),
+                  springs.end());
+    dirty |= springs.size() != count;
+}
+
+void SpringNetwork::clear()
+{
+    springs.clear();
+    dirty = true;
+}
+
+void SpringNetwork::replace(const std::vector<uint32_t> &firstBodies, const std::vector<Spring> &added)
+{
+    size_t count = springs.size();
+    springs.erase(std::remove_if(springs.begin(), springs.end(), [&firstBodies](const Spring &spring)
+                                 { return std::binary_search(firstBodies.begin(), firstBodies.end(), spring.a.value); }),
+                  springs.end());
+    dirty |= springs.size() != count;
+    for (const Spring &spring : added)
+    {
+        add(spring);
+    }
+}
+
+bool SpringNetwork::isAttached(ObjectHandle handle) const
+{
+    return std::any_of(springs.begin(), springs.end(), [handle](const Spring &spring)
+                       { return spring.a == handle || spring.b == handle; });
+}
+
+size_t SpringNetwork::size() const
+{
+    return springs.size();
+}
+
+const std::vector<Spring> &SpringNetwork::getSprings() const
+{
+    return springs;
+}
+
+const std::vector<ObjectHandle> &SpringNetwork::getNodes()
+{
+    if (dirty)
+        build();
+    return nodes;
+}
+
+void SpringNetwork::build()
+{
+    dirty = false;
+
+    // Number the bodies in order of first appearance
+    std::unordered_map<uint32_t, uint32_t> nodeOf;
+    std::vector<uint32_t> ends(springs.size() * 2);
+    nodes.clear();
+    for (size_t s = 0; s < springs.size(); s++)
+    {
+        ObjectHandle handles[2] = {springs[s].a, springs[s].b};
+        for (int k = 0; k < 2; k++)
+        {
+            auto found = nodeOf.emplace(handles[k].value, static_cast<uint32_t>(nodes.size()));
+            if (found.second)
+                nodes.push_back(handles[k]);
+            ends[s * 2 + k] = found.first->second;
+        }
+    }
+
+    // Count the springs of each node, then place each spring in both of its rows
+    size_t nodeCount = nodes.size();
+    rowStart.assign(nodeCount + 1, 0);
+    for (uint32_t end : ends)
+    {
+        rowStart[end + 1]++;
+    }
+    for (size_t n = 0; n < nodeCount; n++)
+    {
+        rowStart[n + 1] += rowStart[n];
+    }
+
+    size_t entries = springs.size() * 2;
+    neighbor.resize(entries);
+    entrySpring.resize(entries);
+    entryRest.resize(entries);
+    entryStiffness.resize(entries);
+    entryDamping.resize(entries);
+    entryBreak.resize(entries);
+    entryBroken.assign(entries, 0);
+    std::vector<uint32_t> cursor(rowStart.begin(), rowStart.end() - 1);
+    for (size_t s = 0; s < springs.size(); s++)
+    {
+        const Spring &spring = springs[s];
+        Scalar breakLength = spring.breakStrain > 0.0f ? spring.restLength * (1.0f + spring.breakStrain) : std::numeric_limits<Scalar>::infinity();
+        for (int k = 0; k < 2; k++)
+        {
+            uint32_t e = cursor[ends[s * 2 + k]]++;
+            neighbor[e] = ends[s * 2 + 1 - k];
+            entrySpring[e] = static_cast<uint32_t>(s);
+            entryRest[e] = spring.restLength;
+            entryStiffness[e] = spring.stiffness;
+            entryDamping[e] = spring.damping;
+            entryBreak[e] = breakLength;
+        }
+    }
+
+    positionX.resize(nodeCount);
+    positionY.resize(nodeCount);
+    velocityX.resize(nodeCount);
+    velocityY.resize(nodeCount);
+    forceX.resize(nodeCount);
+    forceY.resize(nodeCount);
+    positionGain.resize(nodeCount);
+    velocityGain.resize(nodeCount);
+}
+
+void SpringNetwork::computeForces(const std::vector<const Body *> &bodies)
+{
+    if (dirty)
+        build();
+
+    size_t nodeCount = nodes.size();
+    for (size_t n = 0; n < nodeCount; n++)
+    {
+        positionX[n] = bodies[n]->position.x;
+        positionY[n] = bodies[n]->position.y;
+        velocityX[n] = bodies[n]->velocity.x;
+        velocityY[n] = bodies[n]->velocity.y;
+    }
+
+    // Each node streams through its own row. The gains are the isotropic part of the force's derivative,
+    // which lets the solvers integrate the node's own response exactly and keeps stiff lattices stable.
+    std::atomic<bool> anyBroken{false};
+    ThreadPool::shared().parallelFor(nodeCount, [this, &anyBroken](size_t begin, size_t end)
+                                     {
+        const Scalar tiny = std::numeric_limits<Scalar>::epsilon();
+        bool broken = false;
+        for (size_t n = begin; n < end; n++)
+        {
+            Scalar x = positionX[n], y = positionY[n];
+            Scalar vx = velocityX[n], vy = velocityY[n];
+            Scalar fx = 0.0f, fy = 0.0f, k = 0.0f, c = 0.0f;
+            for (uint32_t e = rowStart[n]; e < rowStart[n + 1]; e++)
+            {
+                uint32_t m = neighbor[e];
+                Scalar dx = positionX[m] - x;
+                Scalar dy = positionY[m] - y;
+                Scalar length = std::sqrt(dx * dx + dy * dy);
+                Scalar inverse = 1.0f / std::max(length, tiny);
+                Scalar nx = dx * inverse, ny = dy * inverse;
+                Scalar closing = (velocityX[m] - vx) * nx + (velocityY[m] - vy) * ny;
+                Scalar magnitude = entryStiffness[e] * (length - entryRest[e]) + entryDamping[e] * closing;
+                fx += magnitude * nx;
+                fy += magnitude * ny;
+                k += entryStiffness[e];
+                c += entryDamping[e];
+                entryBroken[e] = length > entryBreak[e];
+                broken |= length > entryBreak[e];
+            }
+            positionGain[n] = -k;
+            velocityGain[n] = -c;
+            forceX[n] = fx + k * x + c * vx;
+            forceY[n] = fy + k * y + c * vy;
+        }
+        if (broken)
+            anyBroken.store(true, std::memory_order_relaxed); }, PARALLEL_MIN_CHUNK);
+
+    // Both ends of a spring see the same stretch, so either entry decides
+    if (anyBroken)
+    {
+        std::vector<char> snapped(springs.size(), 0);
+        for (size_t e = 0; e < entryBroken.size(); e++)
+        {
+            snapped[entrySpring[e]] |= entryBroken[e];
+        }
+        size_t kept = 0;
+        for (size_t s = 0; s < springs.size(); s++)
+        {
+            if (!snapped[s])
+                springs[kept++] = springs[s];
+        }
+        LOG_DEBUG(LOG_SPRING, "{} springs snapped, {} left", springs.size() - kept, kept);
+        springs.resize(kept);
+        dirty = true;
+    }
+}
+
+Vec2 SpringNetwork::getOffset(size_t node) const
+{
+    return Vec2(forceX[node], forceY[node]);
+}
+
+Scalar SpringNetwork::getPositionGain(size_t node) const
+{
+    return positionGain[node];
+}
+
+Scalar SpringNetwork::getVelocityGain(size_t node) const
+{
+    return velocityGain[node];
+}
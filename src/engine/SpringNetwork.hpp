@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Config.h"
+
+#include <cstdint>
+#include <vector>
+#include "objects/Body.hpp"
+#include "objects/ObjectHandle.hpp"
+
+// Damped spring between the centers of two bodies
+struct Spring
+{
+    ObjectHandle a;
+    ObjectHandle b;
+    Scalar restLength = DEFAULT_LENGTH;         // m
+    Scalar stiffness = DEFAULT_SPRING_CONSTANT; // N/m
+    Scalar damping = DEFAULT_SPRING_DAMPING;    // N·s/m, on the speed along the spring
+    Scalar breakStrain = DEFAULT_BREAK_STRAIN;  // Stretch relative to the rest length that snaps the spring, 0 never breaks
+};
+
+// Springs between bodies. The edge list is compiled to compressed-sparse-row adjacency with one row
+// per body, each entry carrying everything its spring's force needs, so the forces are accumulated in
+// a single streaming pass over the rows. Every body only writes its own row's sum, so the rows are
+// split across threads without atomics.
+class SpringNetwork
+{
+private:
+    std::vector<Spring> springs;
+    bool dirty = false; // Springs changed since the rows were built
+
+    // Rows, one per body with springs
+    std::vector<ObjectHandle> nodes;
+    std::vector<uint32_t> rowStart;    // Offset of each node's entries, one extra entry at the end
+    std::vector<uint32_t> neighbor;    // Node at the other end of each entry
+    std::vector<uint32_t> entrySpring; // Spring of each entry
+    std::vector<Scalar> entryRest, entryStiffness, entryDamping;
+    std::vector<Scalar> entryBreak; // Length that snaps the spring, infinite when it never breaks
+    std::vector<char> entryBroken;
+
+    // Node state gathered at the start of the step, and the summed spring response of each node
+    std::vector<Scalar> positionX, positionY, velocityX, velocityY;
+    std::vector<Scalar> forceX, forceY;
+    std::vector<Scalar> positionGain, velocityGain;
+
+    void build(); // Rebuild the rows from the edge list
+
+public:
+    // Methods
+    void add(const Spring &spring);
+    void removeBody(ObjectHandle handle); // Drop the springs attached to a body
+    void clear();
+    // Drop the springs whose first body has one of the sorted handle values and add others, in one pass
+    void replace(const std::vector<uint32_t> &firstBodies, const std::vector<Spring> &added);
+
+    bool isAttached(ObjectHandle handle) const; // Whether a spring has the body at either end
+
+    size_t size() const;
+    const std::vector<Spring> &getSprings() const;
+    const std::vector<ObjectHandle> &getNodes(); // Bodies with springs, rebuilding the rows if the springs changed
+
+    // Accumulate the spring forces on the nodes, given their bodies in getNodes() order. Each node sees its
+    // neighbors frozen at the start of the step, so its force is linear in its own state:
+    // F(p, v) = offset + positionGain·p + velocityGain·v. Springs stretched past their break length are removed.
+    void computeForces(const std::vector<const Body *> &bodies);
+    Vec2 getOffset(size_t node) const;
+    Scalar getPositionGain(size_t node) const;
+    Scalar getVelocityGain(size_t node) const;
+};
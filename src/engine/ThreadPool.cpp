@@ -0,0 +1,107 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+static thread_local bool isPoolWorker = false;
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(&ThreadPool::run, this);
+    }
+}
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    condition.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::run()
+{
+    isPoolWorker = true;
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]
+                           { return !tasks.empty() || !running; });
+            if (!running && tasks.empty())
+                return;
+
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+    }
+    condition.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t begin, size_t end)> &body, size_t minChunk)
+{
+    if (count == 0)
+        return;
+
+    size_t chunkCount = std::min(workers.size() + 1, (count + minChunk - 1) / std::max<size_t>(minChunk, 1));
+    if (isPoolWorker || chunkCount <= 1)
+    {
+        body(0, count);
+        return;
+    }
+
+    size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+    size_t remaining = chunkCount - 1;
+    std::mutex doneMutex;
+    std::condition_variable done;
+
+    for (size_t chunk = 1; chunk < chunkCount; chunk++)
+    {
+        size_t begin = chunk * chunkSize;
+        size_t end = std::min(begin + chunkSize, count);
+        submit([&, begin, end]
+               {
+            if (begin < end)
+                body(begin, end);
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0)
+                done.notify_one(); });
+    }
+
+    // The calling thread takes the first chunk, passes nested in it run inline as they do on the workers
+    bool wasWorker = isPoolWorker;
+    isPoolWorker = true;
+    body(0, std::min(chunkSize, count));
+    isPoolWorker = wasWorker;
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    done.wait(lock, [&]
+              { return remaining == 0; });
+}
+
+size_t ThreadPool::size() const
+{
+    return workers.size();
+}
+
+ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    return pool;
+}
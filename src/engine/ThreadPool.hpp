@@ -0,0 +1,38 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads shared by the engine's parallel passes
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool running = true;
+
+    void run(); // Worker loop
+
+public:
+    // Constructors & Destructor
+    ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    // Methods
+    void submit(std::function<void()> task); // Queue a task for any worker
+
+    // Split [0, count) into chunks and run them across the workers and the calling thread, blocking until all are done.
+    // Runs inline when called from a worker or from the calling thread's own chunk, so nested passes cannot
+    // deadlock the pool or wait behind it.
+    void parallelFor(size_t count, const std::function<void(size_t begin, size_t end)> &body, size_t minChunk = 1);
+
+    size_t size() const; // Number of worker threads
+
+    static ThreadPool &shared(); // Process-wide pool
+};
@@ -1,13 +1,105 @@
 #include "Config.h"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 #include <fmt/format.h>
 #include <SFML/Graphics.hpp>
 #include <imgui-SFML.h>
 #include "core/World.hpp"
 #include "core/Tools.hpp"
+#include "core/Exporter.hpp"
+#include "core/Governor.hpp"
+#include "core/Notepad.hpp"
 #include "core/UI.hpp"
 
+// Force pulling a grabbed object towards the mouse within one calculation step:
+// m·((target - p) / h - v) / h, which is linear in the state
+static ForceSource grabForce(const Vec2 &target, Scalar mass)
+{
+    Scalar h = 1.0f / DEFAULT_CALC_FREQ;
+    return ForceSource::linear("grab", target * (mass / (h * h)), -mass / (h * h), -mass / h);
+}
+
+// Move a grabbed object to the mouse, static objects follow it directly
+static void dragGrabbed(World &world, ObjectHandle handle, const Vec2 &target)
+{
+    Object *object = world.getObject(handle);
+    if (object == nullptr)
+        return;
+
+    if (object->isStatic)
+    {
+        object->body->position = target;
+        object->body->velocity = Vec2(0.0f, 0.0f);
+    }
+    else
+    {
+        object->applyForce(grabForce(target, object->body->mass));
+    }
+}
+
+// Hand the governor's step rate and contact iterations to one notepad's simulation
+static void applyLevels(Notepad *pad, const QualityLevels &levels)
+{
+    pad->simulation.setStepRate(levels.stepRate);
+    int iterations = levels.contactIterations;
+    pad->simulation.post([iterations](World &world)
+                         { world.contactIterations = iterations; });
+}
+
+// Undo or redo the last edit of a notepad
+static void stepHistory(Notepad *pad, bool redo)
+{
+    pad->simulation.post([history = &pad->history, redo](World &world)
+                         {
+                             if (redo)
+                                 history->redo(world);
+                             else
+                                 history->undo(world); });
+    pad->predictionDirty = true;
+}
+
+// Notepads on screen: the active one, or in split view its page of up to MAX_SPLIT_NOTEPADS
+static void shownRange(size_t count, size_t active, bool split, size_t &first, size_t &last)
+{
+    if (!split)
+    {
+        first = active;
+        last = active + 1;
+        return;
+    }
+    first = active / MAX_SPLIT_NOTEPADS * MAX_SPLIT_NOTEPADS;
+    last = std::min(first + MAX_SPLIT_NOTEPADS, count);
+}
+
+// Give each shown notepad its column of the window, keeping its zoom
+static void layoutViews(std::vector<Notepad *> &notepads, size_t first, size_t last, const sf::Vector2u &windowSize)
+{
+    float columns = static_cast<float>(last - first);
+    for (size_t i = first; i < last; i++)
+    {
+        sf::View &view = notepads[i]->view;
+        sf::FloatRect viewport(sf::Vector2f(static_cast<float>(i - first) / columns, 0.0f), sf::Vector2f(1.0f / columns, 1.0f));
+        if (view.getViewport() == viewport)
+            continue;
+        float scale = view.getSize().y / static_cast<float>(windowSize.y);
+        view.setViewport(viewport);
+        view.setSize(sf::Vector2f(viewport.size.x * static_cast<float>(windowSize.x) * scale, view.getSize().y));
+    }
+}
+
+// Shown notepad under a pixel, current if none
+static size_t notepadAt(const std::vector<Notepad *> &notepads, size_t first, size_t last, size_t current, const sf::RenderWindow &window, const sf::Vector2i &pixel)
+{
+    for (size_t i = first; i < last; i++)
+    {
+        if (window.getViewport(notepads[i]->view).contains(pixel))
+            return i;
+    }
+    return current;
+}
+
 // Entry point
 int main()
 {
@@ -17,13 +109,7 @@ int main()
     const int toolSettingsFlags = ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize;
 
     bool settingsOpen = false;
-
-    Object *selectedObject = nullptr;
-    Object *grabbedObject = nullptr;
-
-    bool isPanning = false;
-    float toolForceMag = 0.0f;
-    float accumulatedZoom = 1.0f;
+    bool exportOpen = false;
     sf::Vector2f lastMousePos;
 
     // Create the main window and ui
@@ -32,53 +118,59 @@ int main()
         return -1;
     window.setFramerateLimit(60);
 
-    sf::View view(sf::FloatRect(sf::Vector2f(-DEF_HEIGHT / 2, -DEF_WIDTH / 2), sf::Vector2f(DEF_WIDTH, DEF_HEIGHT)));
-    view.setCenter(sf::Vector2f(0, DEF_HEIGHT / 2));
-    window.setView(view);
-
     // UI Styling
     ImGui::PushStyleVarY(ImGuiStyleVar_ItemSpacing, Y_ITEM_SPACING);
 
     // Clock for calculating delta time
     sf::Clock clock;
 
-    // Initialize world and objects
-    World world;
-    Tools tools;
-
-    // Create ground and walls
-    Object *ground = new Object(*pixelsToMeters(new Vec2(0, DEF_HEIGHT - HALF_WALL_THICKNESS)), *pixelsToMeters(new Vec2(WORLD_WIDTH, WALL_THICKNESS)), 1.0f, RECTANGLE);
-    Object *leftWall = new Object(*pixelsToMeters(new Vec2(-(WORLD_WIDTH / 2 - HALF_WALL_THICKNESS), (DEF_HEIGHT - HALF_WALL_THICKNESS) - (WORLD_HEIGHT / 2))), *pixelsToMeters(new Vec2(WALL_THICKNESS, WORLD_HEIGHT)), 1.0f, RECTANGLE);
-    Object *rightWall = new Object(*pixelsToMeters(new Vec2(WORLD_WIDTH / 2 - HALF_WALL_THICKNESS, (DEF_HEIGHT - HALF_WALL_THICKNESS) - (WORLD_HEIGHT / 2))), *pixelsToMeters(new Vec2(WALL_THICKNESS, WORLD_HEIGHT)), 1.0f, RECTANGLE);
-    Object *ceiling = new Object(*pixelsToMeters(new Vec2(0, (DEF_HEIGHT + HALF_WALL_THICKNESS) - WORLD_HEIGHT)), *pixelsToMeters(new Vec2(WORLD_WIDTH, WALL_THICKNESS)), 1.0f, RECTANGLE);
-    ground->setConstant();
-    leftWall->setConstant();
-    rightWall->setConstant();
-    ceiling->setConstant();
-    ground->shape->setFillColor(WALL_COLOR);
-    leftWall->shape->setFillColor(WALL_COLOR);
-    rightWall->shape->setFillColor(WALL_COLOR);
-    ceiling->shape->setFillColor(WALL_COLOR);
-    world.addObject(ground);
-    world.addObject(leftWall);
-    world.addObject(rightWall);
-    world.addObject(ceiling);
-
-    // Mouse pos pointer for tools & force calculations
+    AssetCache assets;
+    QualityGovernor governor;
+    QualityLevels appliedLevels; // Levels the simulations run with
+    float panelRefreshRate = DEFAULT_PANEL_REFRESH_RATE;
+
+    // Offscreen export of a copy of the world, the fields below are edited by the export window
+    Exporter exporter;
+    ExportSettings exportSettings;
+    int exportSize[2] = {DEFAULT_EXPORT_WIDTH, DEFAULT_EXPORT_HEIGHT};
+    char exportDirectory[EXPORT_PATH_CAPACITY] = "export";
+    char exportCommand[EXPORT_PATH_CAPACITY] = "ffmpeg -y -f rawvideo -pix_fmt rgba -s {width}x{height} -r {fps} -i - export.mp4";
+
+    // Open worlds, each stepped by its own simulation thread while shown and not paused. The UI edits the active one,
+    // split view shows a page of them side by side.
+    std::vector<Notepad *> notepads;
+    notepads.push_back(new Notepad("Notepad 1", assets));
+    int notepadCount = 1;
+    size_t active = 0;
+    bool splitView = false;
+    Notepad *selectedTab = nullptr; // Tab the tab bar last showed as selected
+    size_t firstShown = 0;
+    size_t lastShown = 1;
+    layoutViews(notepads, firstShown, lastShown, window.getSize());
+    window.setView(notepads[active]->view);
+
+    // Mouse position in meters for tools & force calculations
     sf::Vector2i mousePos = sf::Mouse::getPosition(window);
     sf::Vector2f worldPos = window.mapPixelToCoords(mousePos);
-    Vec2 pixelsPos = Vec2(worldPos.x, worldPos.y);
-    Vec2 *posPointer = pixelsToMeters(&pixelsPos);
+    Vec2 mouseMeters = Vec2(pixelsToMeters(worldPos.x), pixelsToMeters(worldPos.y));
 
     // Main loop
+    sf::Clock frameClock; // UI and render work of the frame, without the frame limiter's wait
     while (window.isOpen())
     {
+        frameClock.restart();
         // Process events
         while (const std::optional<sf::Event> event = window.pollEvent())
         {
             ImGui::SFML::ProcessEvent(window, *event);
 
-            sf::View newView(window.getView());
+            // Clicking into another notepad of the split view moves the focus there
+            if (const auto *mouseDown = event->getIf<sf::Event::MouseButtonPressed>(); mouseDown != nullptr && !ImGui::GetIO().WantCaptureMouse)
+                active = notepadAt(notepads, firstShown, lastShown, active, window, mouseDown->position);
+
+            Notepad *pad = notepads[active];
+            window.setView(pad->view);
+            sf::View newView(pad->view);
             // Close window : exit
             if (event->is<sf::Event::Closed>())
             {
@@ -86,7 +178,21 @@ int main()
             }
             else if (const sf::Event::Resized *resized = event->getIf<sf::Event::Resized>()) // Resize event: adjust the view to the new window size
             {
-                handleResize(&window, &newView, &view, resized);
+                for (Notepad *notepad : notepads)
+                {
+                    // Each view keeps the width of its column
+                    handleResize(&window, &notepad->view, &notepad->view, resized);
+                    notepad->view.setSize(sf::Vector2f(notepad->view.getSize().x * notepad->view.getViewport().size.x, notepad->view.getSize().y));
+                }
+                newView = pad->view;
+            }
+            else if (const auto *keyPressed = event->getIf<sf::Event::KeyPressed>(); keyPressed != nullptr && keyPressed->control && !ImGui::GetIO().WantCaptureKeyboard)
+            {
+                // Ctrl+Z undoes, Ctrl+Y and Ctrl+Shift+Z redo
+                if (keyPressed->code == sf::Keyboard::Key::Z)
+                    stepHistory(pad, keyPressed->shift);
+                else if (keyPressed->code == sf::Keyboard::Key::Y)
+                    stepHistory(pad, true);
             }
             else if (const auto *keyReleased = event->getIf<sf::Event::KeyReleased>())
             {
@@ -100,17 +206,37 @@ int main()
                 // Make sure UI is not using the mouse before processing mouse events
                 if (const auto *scroll = event->getIf<sf::Event::MouseWheelScrolled>()) // Zoom in/out with mouse wheel
                 {
-                    handleZoom(&window, &newView, &view, scroll->delta, &accumulatedZoom);
+                    handleZoom(&window, &newView, &pad->view, scroll->delta, &pad->accumulatedZoom);
                 }
                 else if (const auto *mouseMoved = event->getIf<sf::Event::MouseMoved>()) // Pan view when right mouse button is held
                 {
                     sf::Vector2i mousePos = sf::Mouse::getPosition(window);
                     sf::Vector2f worldPos = window.mapPixelToCoords(mousePos);
-                    Vec2 pixelsPos = Vec2(worldPos.x, worldPos.y);
-                    *posPointer = *pixelsToMeters(&pixelsPos);
-                    if (isPanning)
+                    mouseMeters = Vec2(pixelsToMeters(worldPos.x), pixelsToMeters(worldPos.y));
+                    Vec2 target = mouseMeters;
+                    if (pad->toolFieldActive)
+                    {
+                        pad->simulation.post([target](World &world)
+                                             {
+                                                 ForceField *field = world.getField("tool");
+                                                 if (field != nullptr)
+                                                     field->center = target; });
+                    }
+                    if (pad->fluidEmitterActive)
+                    {
+                        FluidSettings fluidSettings = *static_cast<FluidSettings *>(pad->tools.settings);
+                        pad->simulation.post([fluidSettings, target](World &world)
+                                             { world.getFluid().setEmitter(target, fluidSettings.radius, fluidSettings.rate); });
+                    }
+                    if (!pad->grabbedHandle.isNull())
                     {
-                        handlePanMouse(&window, &newView, &view, mouseMoved, lastMousePos, accumulatedZoom);
+                        ObjectHandle handle = pad->grabbedHandle;
+                        pad->simulation.post([handle, target](World &world)
+                                             { dragGrabbed(world, handle, target); });
+                    }
+                    if (pad->isPanning)
+                    {
+                        handlePanMouse(&window, &newView, &pad->view, mouseMoved, lastMousePos, pad->accumulatedZoom);
                     }
                 }
                 else if (const auto *mouseDown = event->getIf<sf::Event::MouseButtonPressed>())
@@ -118,136 +244,147 @@ int main()
                     if (mouseDown->button == sf::Mouse::Button::Middle)
                     {
                         // Reset view on middle mouse button
-                        newView.setSize(sf::Vector2f(DEF_WIDTH, DEF_HEIGHT));
+                        newView.setSize(sf::Vector2f(DEF_WIDTH * newView.getViewport().size.x, DEF_HEIGHT));
                         newView.setCenter(sf::Vector2f(0, DEF_HEIGHT / 2));
-                        accumulatedZoom = 1.0f;
+                        pad->accumulatedZoom = 1.0f;
                     }
                     else if (mouseDown->button == sf::Mouse::Button::Right)
                     {
                         // Start panning on right mouse button
-                        isPanning = true;
+                        pad->isPanning = true;
                         lastMousePos = sf::Vector2f(sf::Mouse::getPosition(window));
                     }
                     else if (mouseDown->button == sf::Mouse::Button::Left)
                     {
-                        // Handle tool actions
-                        ToolType type = tools.getCurrentTool()->type;
+                        // Handle tool actions, the world is changed through commands to the simulation
+                        ToolType type = pad->tools.getCurrentTool()->type;
                         sf::Vector2f mousePos = window.mapPixelToCoords(sf::Vector2i(mouseDown->position));
-                        Vec2 pixelsPos = Vec2(mousePos.x, mousePos.y);
-                        Vec2 metersPos = *pixelsToMeters(&pixelsPos);
+                        Vec2 metersPos = Vec2(pixelsToMeters(mousePos.x), pixelsToMeters(mousePos.y));
                         if (type == SELECT)
                         {
-                            bool found = false;
-                            for (Object *obj : world.getObjects())
-                            {
-                                if (obj->isSelectable && obj->shape->getGlobalBounds().contains(window.mapPixelToCoords(sf::Vector2i(mouseDown->position))))
-                                {
-                                    selectedObject = obj;
-                                    found = true;
-                                    break;
-                                }
-                            }
-                            if (!found)
-                            {
-                                selectedObject = nullptr;
-                            }
+                            pad->selectedHandle = pad->simulation.pick(mousePos);
                         }
                         else if (type == MOVE)
                         {
-                            for (Object *obj : world.getObjects())
+                            ObjectHandle handle = pad->simulation.pick(mousePos);
+                            if (!handle.isNull())
                             {
-                                if (obj->isSelectable && obj->shape->getGlobalBounds().contains(window.mapPixelToCoords(sf::Vector2i(mouseDown->position))))
-                                {
-                                    obj->isGrabbed = true;
-                                    grabbedObject = obj;
-                                    selectedObject = obj;
-
-                                    bool isStatic = obj->isStatic;
-
-                                    obj->applyForce(ForceSource("grab", [posPointer, isStatic](Body state)
-                                                                {
-                                                                    if (isStatic)
-                                                                        return Force();
-
-                                                                    Vec2 posDiff = *posPointer - state.position;
-                                                                    Vec2 desiredVel = posDiff / (1.0f / DEFAULT_CALC_FREQ);
-                                                                    Vec2 deltaV = desiredVel - state.velocity;
-                                                                    Vec2 approxForce = deltaV * state.mass / (1.0f / DEFAULT_CALC_FREQ);
-                                                                    return Force(Vec2(0.0f, 0.0f), approxForce); }));
-
-                                    break;
-                                }
+                                pad->grabbedHandle = handle;
+                                pad->selectedHandle = handle;
+                                pad->simulation.post([handle, metersPos, history = &pad->history](World &world)
+                                                     {
+                                                         Object *obj = world.getObject(handle);
+                                                         if (obj == nullptr)
+                                                             return;
+                                                         history->change(world, handle); // Committed on release
+                                                         obj->isGrabbed = true;
+                                                         dragGrabbed(world, handle, metersPos); });
                             }
                         }
                         else if (type == PULL || type == PUSH)
                         {
                             float forceMag;
+                            float radius;
                             if (type == PULL)
                             {
-                                forceMag = static_cast<PullSettings *>(tools.settings)->forceMagnitude * -1;
+                                forceMag = static_cast<PullSettings *>(pad->tools.settings)->forceMagnitude * -1;
+                                radius = static_cast<PullSettings *>(pad->tools.settings)->radius;
                             }
                             else
                             {
-                                forceMag = static_cast<PushSettings *>(tools.settings)->forceMagnitude;
+                                forceMag = static_cast<PushSettings *>(pad->tools.settings)->forceMagnitude;
+                                radius = static_cast<PushSettings *>(pad->tools.settings)->radius;
                             }
-                            toolForceMag = forceMag;
 
-                            for (Object *obj : world.getObjects())
-                            {
-                                obj->applyForce(ForceSource("tool", [posPointer, forceMag](Body state)
-                                                            {
-                                    Vec2 pos = state.position;
-                                    Vec2 diff = pos - *posPointer;
-                                    float distanceSquared = diff.lengthSquared();
-                                    float attenuation = std::max(1.0f / distanceSquared, MAX_ATTENUATION);
-                                    Vec2 force = diff.normalized() * attenuation * forceMag * FORCE_SCALE;
-                                    return Force(Vec2(0, 0), force); }));
-                            }
+                            ForceField *toolField = new ForceField("tool", metersPos, forceMag, radius);
+                            pad->simulation.post([toolField](World &world)
+                                                 { world.addField(toolField); });
+                            pad->toolFieldActive = true;
                         }
                         else if (type == DRAW_CIRCLE)
                         {
-                            CircleSettings *circleSettings = static_cast<CircleSettings *>(tools.settings);
-                            Object *newCircle = new Object(metersPos, Vec2(circleSettings->radius, circleSettings->radius), circleSettings->density, CIRCLE);
-                            newCircle->setStatic(circleSettings->isStatic);
-
-                            newCircle->body->dragCoefficient = circleSettings->dragCoefficient;
-                            newCircle->body->staticFriction = circleSettings->staticFriction;
-                            newCircle->body->kineticFriction = circleSettings->kineticFriction;
-                            newCircle->body->restitution = circleSettings->restitution;
-
-                            world.addObject(newCircle);
-
-                            selectedObject = newCircle;
+                            CircleSettings circleSettings = *static_cast<CircleSettings *>(pad->tools.settings);
+                            pad->simulation.post([circleSettings, metersPos, created = &pad->createdHandle, history = &pad->history](World &world)
+                                                 {
+                                                     Object *newCircle = world.createObject(metersPos, Vec2(circleSettings.radius, circleSettings.radius), circleSettings.density, CIRCLE);
+                                                     newCircle->setStatic(circleSettings.isStatic);
+
+                                                     newCircle->body->charge = circleSettings.charge;
+                                                     newCircle->body->dragCoefficient = circleSettings.dragCoefficient;
+                                                     newCircle->body->staticFriction = circleSettings.staticFriction;
+                                                     newCircle->body->kineticFriction = circleSettings.kineticFriction;
+                                                     newCircle->body->restitution = circleSettings.restitution;
+
+                                                     history->add(newCircle->handle);
+                                                     history->commit(world);
+                                                     *created = newCircle->handle.value; });
                         }
                         else if (type == DRAW_RECTANGLE)
                         {
-                            RectSettings *rectSettings = static_cast<RectSettings *>(tools.settings);
-                            Object *newRect = new Object(metersPos, Vec2(rectSettings->width, rectSettings->height), rectSettings->density, RECTANGLE);
-
-                            newRect->body->dragCoefficient = rectSettings->dragCoefficient;
-                            newRect->body->staticFriction = rectSettings->staticFriction;
-                            newRect->body->kineticFriction = rectSettings->kineticFriction;
-                            newRect->body->restitution = rectSettings->restitution;
-
-                            newRect->setStatic(rectSettings->isStatic);
-                            world.addObject(newRect);
-
-                            selectedObject = newRect;
+                            RectSettings rectSettings = *static_cast<RectSettings *>(pad->tools.settings);
+                            pad->simulation.post([rectSettings, metersPos, created = &pad->createdHandle, history = &pad->history](World &world)
+                                                 {
+                                                     Object *newRect = world.createObject(metersPos, Vec2(rectSettings.width, rectSettings.height), rectSettings.density, RECTANGLE);
+
+                                                     newRect->body->charge = rectSettings.charge;
+                                                     newRect->body->dragCoefficient = rectSettings.dragCoefficient;
+                                                     newRect->body->staticFriction = rectSettings.staticFriction;
+                                                     newRect->body->kineticFriction = rectSettings.kineticFriction;
+                                                     newRect->body->restitution = rectSettings.restitution;
+
+                                                     newRect->setStatic(rectSettings.isStatic);
+
+                                                     history->add(newRect->handle);
+                                                     history->commit(world);
+                                                     *created = newRect->handle.value; });
+                        }
+                        else if (type == DRAW_SPRING)
+                        {
+                            SpringSettings springSettings = *static_cast<SpringSettings *>(pad->tools.settings);
+                            Spring prototype;
+                            prototype.restLength = springSettings.restLength;
+                            prototype.stiffness = springSettings.springConstant;
+                            prototype.damping = springSettings.damping;
+                            prototype.breakStrain = springSettings.breakStrain;
+                            if (springSettings.mode == SPRING_CONNECT)
+                            {
+                                pad->springStart = pad->simulation.pick(mousePos);
+                            }
+                            else
+                            {
+                                bool round = springSettings.mode == SPRING_SOFT_BALL;
+                                pad->simulation.post([springSettings, prototype, metersPos, round, history = &pad->history](World &world)
+                                                     {
+                                                         // The pool appends the new nodes to the objects
+                                                         size_t first = world.getObjects().size();
+                                                         world.addSoftBody(metersPos, springSettings.columns, springSettings.rows, springSettings.density, prototype, round);
+                                                         for (size_t i = first; i < world.getObjects().size(); i++)
+                                                             history->add(world.getObjects()[i]->handle);
+                                                         history->commit(world); });
+                            }
+                        }
+                        else if (type == POUR_FLUID)
+                        {
+                            FluidSettings fluidSettings = *static_cast<FluidSettings *>(pad->tools.settings);
+                            pad->simulation.post([fluidSettings, metersPos](World &world)
+                                                 { world.getFluid().setEmitter(metersPos, fluidSettings.radius, fluidSettings.rate); });
+                            pad->fluidEmitterActive = true;
                         }
                         else if (type == ERASE)
                         {
-                            for (size_t i = 0; i < world.getObjects().size(); ++i)
+                            ObjectHandle handle = pad->simulation.pick(mousePos);
+                            if (!handle.isNull())
                             {
-                                Object *obj = world.getObjects()[i];
-                                if (obj->isSelectable && obj->shape->getGlobalBounds().contains(window.mapPixelToCoords(sf::Vector2i(mouseDown->position))))
-                                {
-                                    world.removeObject(i);
-                                    if (selectedObject == obj)
-                                        selectedObject = nullptr;
-                                    break;
-                                }
+                                pad->simulation.post([handle, history = &pad->history](World &world)
+                                                     {
+                                                         history->change(world, handle);
+                                                         if (world.getSprings().isAttached(handle))
+                                                             history->changeSprings(world, handle);
+                                                         world.removeObject(handle);
+                                                         history->commit(world); });
                             }
                         }
+                        pad->predictionDirty = true;
                     }
                 }
                 else if (const auto *mouseUp = event->getIf<sf::Event::MouseButtonReleased>())
@@ -255,53 +392,186 @@ int main()
                     if (mouseUp->button == sf::Mouse::Button::Left)
                     {
                         // Release grabbed object on left mouse button release
-                        if (grabbedObject != nullptr)
+                        if (!pad->grabbedHandle.isNull())
                         {
-                            grabbedObject->deleteForce("grab");
-                            grabbedObject->isGrabbed = false;
-                        };
-                        grabbedObject = nullptr;
+                            ObjectHandle handle = pad->grabbedHandle;
+                            pad->simulation.post([handle, history = &pad->history](World &world)
+                                                 {
+                                                     Object *grabbedObject = world.getObject(handle);
+                                                     if (grabbedObject != nullptr)
+                                                     {
+                                                         grabbedObject->deleteForce("grab");
+                                                         grabbedObject->isGrabbed = false;
+                                                     }
+                                                     history->commit(world); });
+                        }
+                        pad->grabbedHandle = ObjectHandle();
 
-                        if (toolForceMag != 0.0f)
+                        // Finish a spring on the body under the release point
+                        if (!pad->springStart.isNull())
                         {
-                            for (Object *obj : world.getObjects())
+                            ObjectHandle springEnd = pad->simulation.pick(window.mapPixelToCoords(sf::Vector2i(mouseUp->position)));
+                            if (!springEnd.isNull() && springEnd != pad->springStart)
                             {
-                                obj->deleteForce("tool");
+                                SpringSettings springSettings = *static_cast<SpringSettings *>(pad->tools.settings);
+                                Spring spring;
+                                spring.a = pad->springStart;
+                                spring.b = springEnd;
+                                spring.restLength = springSettings.restLength;
+                                spring.stiffness = springSettings.springConstant;
+                                spring.damping = springSettings.damping;
+                                spring.breakStrain = springSettings.breakStrain;
+                                pad->simulation.post([spring, history = &pad->history](World &world)
+                                                     {
+                                                         if (world.getObject(spring.a) == nullptr || world.getObject(spring.b) == nullptr)
+                                                             return;
+                                                         history->changeSprings(world, spring.a);
+                                                         world.getSprings().add(spring);
+                                                         history->commit(world); });
                             }
                         }
-                        toolForceMag = 0.0f;
+                        pad->springStart = ObjectHandle();
+
+                        if (pad->toolFieldActive)
+                        {
+                            pad->simulation.post([](World &world)
+                                                 { world.removeField("tool"); });
+                        }
+                        pad->toolFieldActive = false;
+
+                        if (pad->fluidEmitterActive)
+                        {
+                            pad->simulation.post([](World &world)
+                                                 { world.getFluid().stopEmitter(); });
+                        }
+                        pad->fluidEmitterActive = false;
+                        pad->predictionDirty = true;
                     }
                     else if (mouseUp->button == sf::Mouse::Button::Right)
                     {
                         // Stop panning on right mouse button release
-                        isPanning = false;
+                        pad->isPanning = false;
                     }
                 }
             }
             // Update view
             window.setView(newView);
-            view = newView;
+            pad->view = newView;
         }
 
-        // Calculate delta time independent of frame rate
+        // Frame time for the UI, the simulation keeps its own clock
         sf::Time dtTime = clock.restart();
-        float dt = dtTime.asSeconds();
-        if (dt > MAX_DT)
-            dt = MAX_DT;
 
         // Update UI and tools
         ImGui::SFML::Update(window, dtTime);
 
+        // Notepad tabs, closing the last one is not offered
+        ImGui::Begin("Notepads", nullptr, propFlags);
+        size_t closing = notepads.size();
+        if (ImGui::BeginTabBar("##Notepads"))
+        {
+            for (size_t i = 0; i < notepads.size(); i++)
+            {
+                Notepad *notepad = notepads[i];
+                bool open = true;
+                ImGuiTabItemFlags flags = i == active && selectedTab != notepad ? ImGuiTabItemFlags_SetSelected : 0;
+                ImGui::PushID(notepad);
+                if (ImGui::BeginTabItem(notepad->name.c_str(), notepads.size() > 1 ? &open : nullptr, flags))
+                {
+                    // A tab the user picked, focus changes from the split view arrive through SetSelected
+                    if (selectedTab != notepad)
+                    {
+                        selectedTab = notepad;
+                        active = i;
+                    }
+                    ImGui::EndTabItem();
+                }
+                ImGui::PopID();
+                if (!open)
+                    closing = i;
+            }
+            ImGui::EndTabBar();
+        }
+        ImGui::Checkbox("Pause", &notepads[active]->paused);
+        ImGui::SameLine();
+        ImGui::Checkbox("Split View", &splitView);
+        ImGui::BeginDisabled(notepads.size() >= MAX_NOTEPADS);
+        bool create = ImGui::Button("New");
+        ImGui::SameLine();
+        bool duplicate = ImGui::Button("Duplicate");
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::BeginDisabled(notepads[active]->history.getUndoSteps() == 0);
+        if (ImGui::Button("Undo"))
+            stepHistory(notepads[active], false);
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::BeginDisabled(notepads[active]->history.getRedoSteps() == 0);
+        if (ImGui::Button("Redo"))
+            stepHistory(notepads[active], true);
+        ImGui::EndDisabled();
+        ImGui::End();
+
+        if (closing < notepads.size())
+        {
+            // Its simulation is stopped and drained before the world goes away
+            delete notepads[closing];
+            notepads.erase(notepads.begin() + closing);
+            if (active > closing || active == notepads.size())
+                active--;
+            selectedTab = nullptr;
+        }
+        else if (create || duplicate)
+        {
+            // A copy is taken with the source stopped, the loop below restarts it if it is still shown
+            Notepad *source = nullptr;
+            if (duplicate)
+            {
+                source = notepads[active];
+                source->setRunning(false);
+            }
+            Notepad *notepad = new Notepad(fmt::format("Notepad {}", ++notepadCount), assets, source);
+            applyLevels(notepad, appliedLevels);
+            notepads.insert(notepads.begin() + active + 1, notepad);
+            active++;
+        }
+
+        // Only shown notepads step, hidden and paused ones have no simulation thread
+        shownRange(notepads.size(), active, splitView, firstShown, lastShown);
+        for (size_t i = 0; i < notepads.size(); i++)
+        {
+            notepads[i]->setRunning(i >= firstShown && i < lastShown && !notepads[i]->paused);
+        }
+        layoutViews(notepads, firstShown, lastShown, window.getSize());
+
+        for (size_t i = firstShown; i < lastShown; i++)
+        {
+            Notepad *shown = notepads[i];
+
+            // Select objects the simulation created for the drawing tools
+            uint32_t created = shown->createdHandle.exchange(0);
+            if (created != 0)
+                shown->selectedHandle = ObjectHandle::fromValue(created);
+
+            // Take the newest state published by the simulation
+            shown->simulation.inspect(shown->selectedHandle);
+            shown->simulation.poll();
+        }
+
+        // Panels below edit the active notepad
+        Notepad *pad = notepads[active];
+        window.setView(pad->view);
+
         ImGui::Begin("Tools", nullptr, toolFlags);
-        tools.draw();
+        pad->tools.draw();
         ImGui::End();
 
-        Tool *currentTool = tools.getCurrentTool();
+        Tool *currentTool = pad->tools.getCurrentTool();
         ToolType type = currentTool->type;
 
         // Tool settings window
         ImGui::Begin("Tool Settings", nullptr, toolSettingsFlags);
-        ImGui::Text(fmt::format("{} Tool", currentTool->getName()).c_str());
+        ImGui::Text("%s Tool", currentTool->getName());
         if (type == SELECT)
         {
             ImGui::Text("Left Click to select object");
@@ -316,11 +586,13 @@ int main()
             ImGui::Separator();
             if (type == PULL)
             {
-                ImGui::DragFloat("Strength", &static_cast<PullSettings *>(tools.settings)->forceMagnitude, FORCE_STEP, MIN_FORCE, MAX_FORCE);
+                ImGui::DragFloat("Strength", &static_cast<PullSettings *>(pad->tools.settings)->forceMagnitude, FORCE_STEP, MIN_FORCE, MAX_FORCE);
+                ImGui::DragFloat("Radius", &static_cast<PullSettings *>(pad->tools.settings)->radius, FIELD_RADIUS_STEP, MIN_FIELD_RADIUS, MAX_FIELD_RADIUS);
             }
             else if (type == PUSH)
             {
-                ImGui::DragFloat("Strength", &static_cast<PushSettings *>(tools.settings)->forceMagnitude, FORCE_STEP, MIN_FORCE, MAX_FORCE);
+                ImGui::DragFloat("Strength", &static_cast<PushSettings *>(pad->tools.settings)->forceMagnitude, FORCE_STEP, MIN_FORCE, MAX_FORCE);
+                ImGui::DragFloat("Radius", &static_cast<PushSettings *>(pad->tools.settings)->radius, FIELD_RADIUS_STEP, MIN_FIELD_RADIUS, MAX_FIELD_RADIUS);
             }
         }
         else if (type == DRAW_CIRCLE || type == DRAW_RECTANGLE)
@@ -329,10 +601,11 @@ int main()
             ImGui::Separator();
             if (type == DRAW_CIRCLE)
             {
-                CircleSettings *circleSettings = static_cast<CircleSettings *>(tools.settings);
+                CircleSettings *circleSettings = static_cast<CircleSettings *>(pad->tools.settings);
                 ImGui::Checkbox("Is Static", &circleSettings->isStatic);
                 ImGui::DragFloat("Radius", &circleSettings->radius, LENGTH_STEP, MIN_LENGTH, MAX_LENGTH);
                 ImGui::DragFloat("Density", &circleSettings->density, DENSITY_STEP, MIN_DENSITY, MAX_DENSITY);
+                ImGui::DragFloat("Charge", &circleSettings->charge, CHARGE_STEP, MIN_CHARGE, MAX_CHARGE);
                 ImGui::DragFloat("Drag Coefficient", &circleSettings->dragCoefficient, DRAG_STEP, MIN_DRAG, MAX_DRAG);
                 ImGui::DragFloat("Static Friction", &circleSettings->staticFriction, FRICTION_STEP, MIN_FRICTION, MAX_FRICTION);
                 ImGui::DragFloat("Kinetic Friction", &circleSettings->kineticFriction, FRICTION_STEP, MIN_FRICTION, MAX_FRICTION);
@@ -340,22 +613,49 @@ int main()
             }
             else if (type == DRAW_RECTANGLE)
             {
-                RectSettings *rectSettings = static_cast<RectSettings *>(tools.settings);
+                RectSettings *rectSettings = static_cast<RectSettings *>(pad->tools.settings);
                 ImGui::Checkbox("Is Static", &rectSettings->isStatic);
                 ImGui::DragFloat("Width", &rectSettings->width, LENGTH_STEP, MIN_LENGTH * 2, MAX_LENGTH * 2);
                 ImGui::DragFloat("Height", &rectSettings->height, LENGTH_STEP, MIN_LENGTH * 2, MAX_LENGTH * 2);
                 ImGui::DragFloat("Density", &rectSettings->density, DENSITY_STEP, MIN_DENSITY, MAX_DENSITY);
+                ImGui::DragFloat("Charge", &rectSettings->charge, CHARGE_STEP, MIN_CHARGE, MAX_CHARGE);
                 ImGui::DragFloat("Drag", &rectSettings->dragCoefficient, DRAG_STEP, MIN_DRAG, MAX_DRAG);
                 ImGui::DragFloat("Static Friction", &rectSettings->staticFriction, FRICTION_STEP, MIN_FRICTION, MAX_FRICTION);
                 ImGui::DragFloat("Kinetic Friction", &rectSettings->kineticFriction, FRICTION_STEP, MIN_FRICTION, MAX_FRICTION);
                 ImGui::DragFloat("Restitution", &rectSettings->restitution, RESTITUTION_STEP, MIN_RESTITUTION, MAX_RESTITUTION);
             }
         }
-        else if (type == DRAW_ROPE || type == DRAW_SPRING)
+        else if (type == DRAW_ROPE)
         {
             ImGui::Text("Left Click and drag to create connection");
             ImGui::Separator();
         }
+        else if (type == DRAW_SPRING)
+        {
+            SpringSettings *springSettings = static_cast<SpringSettings *>(pad->tools.settings);
+            static const char *modeItems[] = {"Connect", "Soft Box", "Soft Ball"};
+            ImGui::Text("%s", springSettings->mode == SPRING_CONNECT ? "Left Click and drag between objects to connect them" : "Left Click to place soft body");
+            ImGui::Separator();
+            ImGui::Combo("Mode", &springSettings->mode, modeItems, IM_ARRAYSIZE(modeItems));
+            ImGui::DragFloat("Spring Constant", &springSettings->springConstant, SPRING_CONSTANT_STEP, MIN_SPRING_CONSTANT, MAX_SPRING_CONSTANT);
+            ImGui::DragFloat(springSettings->mode == SPRING_CONNECT ? "Rest Length" : "Spacing", &springSettings->restLength, LENGTH_STEP, MIN_LENGTH, MAX_LENGTH);
+            ImGui::DragFloat("Damping", &springSettings->damping, SPRING_DAMPING_STEP, MIN_SPRING_DAMPING, MAX_SPRING_DAMPING);
+            ImGui::DragFloat("Break Strain", &springSettings->breakStrain, BREAK_STRAIN_STEP, MIN_BREAK_STRAIN, MAX_BREAK_STRAIN);
+            if (springSettings->mode != SPRING_CONNECT)
+            {
+                ImGui::DragInt("Columns", &springSettings->columns, 1.0f, MIN_LATTICE_SIZE, MAX_LATTICE_SIZE);
+                ImGui::DragInt("Rows", &springSettings->rows, 1.0f, MIN_LATTICE_SIZE, MAX_LATTICE_SIZE);
+                ImGui::DragFloat("Density", &springSettings->density, DENSITY_STEP, MIN_DENSITY, MAX_DENSITY);
+            }
+        }
+        else if (type == POUR_FLUID)
+        {
+            ImGui::Text("Left Click and hold to pour fluid");
+            ImGui::Separator();
+            FluidSettings *fluidSettings = static_cast<FluidSettings *>(pad->tools.settings);
+            ImGui::DragFloat("Rate", &fluidSettings->rate, FLUID_RATE_STEP, MIN_FLUID_RATE, MAX_FLUID_RATE);
+            ImGui::DragFloat("Radius", &fluidSettings->radius, EMITTER_RADIUS_STEP, MIN_EMITTER_RADIUS, MAX_EMITTER_RADIUS);
+        }
         else if (type == ERASE)
         {
             ImGui::Text("Left Click to erase object");
@@ -363,77 +663,226 @@ int main()
         ImGui::End();
 
         // Object properties window
-        if (selectedObject != nullptr)
+        pad->inspector.setTarget(pad->selectedHandle);
+        if (pad->inspector.draw(pad->simulation.latest().inspected, dtTime.asSeconds(), panelRefreshRate))
         {
-            ImGui::Begin("Object Properties", nullptr, propFlags);
-            if (selectedObject->shapeType == CIRCLE)
+            ObjectHandle handle = pad->selectedHandle;
+            BodyProperties properties = pad->inspector.getProperties();
+            pad->simulation.post([handle, properties, history = &pad->history](World &world)
+                                 {
+                                     Object *object = world.getObject(handle);
+                                     if (object == nullptr)
+                                         return;
+                                     history->change(world, handle); // Edits of the same object in a row are one step
+                                     object->body->charge = properties.charge;
+                                     object->body->dragCoefficient = properties.dragCoefficient;
+                                     object->body->staticFriction = properties.staticFriction;
+                                     object->body->kineticFriction = properties.kineticFriction;
+                                     object->body->restitution = properties.restitution;
+                                     history->commit(world, handle.value); });
+            pad->predictionDirty = true;
+        }
+
+        // Simulation settings window
+        if (settingsOpen)
+        {
+            ImGui::Begin("Simulation Settings", &settingsOpen, propFlags);
+            bool worldEdited = false;
+            worldEdited |= dragScalar("Gravity", &pad->settings.gravity.y, GRAVITY_STEP, MIN_GRAVITY, MAX_GRAVITY);
+            worldEdited |= dragScalar("Air Density", &pad->settings.airDensity, AIR_DENSITY_STEP, MIN_AIR_DENSITY, MAX_AIR_DENSITY);
+            static const char *solverItems[] = {"Euler", "RK2", "RK4", "Verlet", "DOPRI5", "AB", "AM"};
+            int currentSolver = static_cast<int>(pad->settings.solver);
+            if (ImGui::Combo("ODE Solver", &currentSolver, solverItems, IM_ARRAYSIZE(solverItems)))
             {
-                ImGui::Text("Circle [%d]", selectedObject->getID());
-                ImGui::Separator();
-                ImGui::Text("Radius: %.2f m", selectedObject->dimensions.x);
+                pad->settings.solver = static_cast<SolverType>(currentSolver);
+                worldEdited = true;
             }
-            else
+            worldEdited |= ImGui::DragFloat("Calculation Frequency", &pad->settings.calculationFrequency, CALC_FREQ_STEP, MIN_CALC_FREQ, MAX_CALC_FREQ);
+            ImGui::Separator();
+            worldEdited |= ImGui::Checkbox("Mutual Gravity", &pad->settings.nbody.doGravity);
+            worldEdited |= ImGui::DragFloat("Gravitational Constant", &pad->settings.nbody.gravitationalConstant, GRAVITATIONAL_CONSTANT_STEP, MIN_GRAVITATIONAL_CONSTANT, MAX_GRAVITATIONAL_CONSTANT);
+            worldEdited |= ImGui::Checkbox("Electrostatics", &pad->settings.nbody.doElectrostatics);
+            worldEdited |= ImGui::DragFloat("Coulomb Constant", &pad->settings.nbody.coulombConstant, COULOMB_CONSTANT_STEP, MIN_COULOMB_CONSTANT, MAX_COULOMB_CONSTANT);
+            worldEdited |= ImGui::DragFloat("Opening Angle", &pad->settings.nbody.openingAngle, OPENING_ANGLE_STEP, MIN_OPENING_ANGLE, MAX_OPENING_ANGLE);
+            worldEdited |= ImGui::DragFloat("Softening", &pad->settings.nbody.softening, SOFTENING_STEP, MIN_SOFTENING, MAX_SOFTENING);
+            bool edited = worldEdited;
+            ImGui::Separator();
+            ImGui::Text("Custom Force");
+            ImGui::InputTextMultiline("##Program", pad->programSource, PROGRAM_SOURCE_CAPACITY);
+            if (ImGui::Button("Apply"))
             {
-                ImGui::Text("Rectangle [%d]", selectedObject->getID());
-                ImGui::Separator();
-                ImGui::Text("Width: %.2f m", selectedObject->dimensions.x);
-                ImGui::Text("Height: %.2f m", selectedObject->dimensions.y);
+                ForceProgram program;
+                program.name = "custom";
+                if (ForceProgram::compile(pad->programSource, program, pad->programError))
+                {
+                    pad->programError.clear();
+                    pad->simulation.post([program](World &world)
+                                         { world.addProgram(program); });
+                    edited = true;
+                }
             }
-            ImGui::Text("Mass: %.2f kg", selectedObject->body->mass);
-            ImGui::Separator();
-            ImGui::Text("Net Force: %s N", (selectedObject->body->acceleration * selectedObject->body->mass).toString().c_str());
-            ImGui::Text("Acceleration: %s m/s²", selectedObject->body->acceleration.toString().c_str());
-            ImGui::Text("Velocity: %s m/s", selectedObject->body->velocity.toString().c_str());
-            ImGui::Text("Position: %s m", standardizePosition(selectedObject->body->position).toString().c_str());
+            ImGui::SameLine();
+            if (ImGui::Button("Clear"))
+            {
+                pad->programError.clear();
+                pad->simulation.post([](World &world)
+                                     { world.removeProgram("custom"); });
+                edited = true;
+            }
+            if (!pad->programError.empty())
+                ImGui::TextWrapped("%s", pad->programError.c_str());
             ImGui::Separator();
-            ImGui::Text("Kinetic Energy: %.2f J", selectedObject->body->kineticEnergy);
-            ImGui::Text("Gravitational Potential: %.2f J", selectedObject->body->gravitationalPotential);
-            ImGui::Text("Total Mechanical Energy: %.2f J", selectedObject->body->totalEnergy);
+            ImGui::Text("Fluid Particles: %zu", pad->simulation.latest().particles.size());
+            ImGui::SameLine();
+            if (ImGui::Button("Clear Fluid"))
+            {
+                pad->simulation.post([](World &world)
+                                     { world.getFluid().clear(); });
+                edited = true;
+            }
             ImGui::Separator();
-            ImGui::DragFloat("Drag Coefficient", &selectedObject->body->dragCoefficient, DRAG_STEP, MIN_DRAG, MAX_DRAG);
-            ImGui::DragFloat("Static Friction", &selectedObject->body->staticFriction, FRICTION_STEP, MIN_FRICTION, MAX_FRICTION);
-            ImGui::DragFloat("Kinetic Friction", &selectedObject->body->kineticFriction, FRICTION_STEP, MIN_FRICTION, MAX_FRICTION);
-            ImGui::DragFloat("Restitution", &selectedObject->body->restitution, RESTITUTION_STEP, MIN_RESTITUTION, MAX_RESTITUTION);
+            ImGui::Checkbox("Show Telemetry", &pad->telemetryPanel.isOpen);
+            ImGui::Checkbox("Show Export", &exportOpen);
+            ImGui::Checkbox("Show Quality", &governor.isOpen);
+            ImGui::DragFloat("Panel Refresh Rate", &panelRefreshRate, PANEL_REFRESH_RATE_STEP, MIN_PANEL_REFRESH_RATE, MAX_PANEL_REFRESH_RATE);
+            edited |= ImGui::Checkbox("Predict Paths", &pad->predictor.enabled);
+            edited |= ImGui::Checkbox("Predict All Objects", &pad->predictor.predictAll);
+            edited |= ImGui::DragFloat("Prediction Horizon", &pad->predictor.horizon, PREDICTION_HORIZON_STEP, MIN_PREDICTION_HORIZON, MAX_PREDICTION_HORIZON);
             ImGui::End();
+
+            if (worldEdited)
+            {
+                WorldSettings edit = pad->settings;
+                pad->simulation.post([edit](World &world)
+                                     { world.applySettings(edit); });
+            }
+            if (edited)
+                pad->predictionDirty = true;
         }
 
-        // Simulation settings window
-        if (settingsOpen)
+        // Telemetry plots
+        for (Notepad *notepad : notepads)
         {
-            ImGui::Begin("Simulation Settings", &settingsOpen, propFlags);
-            ImGui::DragFloat("Gravity", &world.gravity.y, GRAVITY_STEP, MIN_GRAVITY, MAX_GRAVITY);
-            ImGui::DragFloat("Air Density", &world.airDensity, AIR_DENSITY_STEP, MIN_AIR_DENSITY, MAX_AIR_DENSITY);
-            static const char *solverItems[] = {"Euler", "RK2", "RK4", "Verlet", "DOPRI5", "AB", "AM"};
-            static int currentSolver = static_cast<int>(world.getODESolver());
-            if (ImGui::Combo("ODE Solver", &currentSolver, solverItems, IM_ARRAYSIZE(solverItems)))
+            notepad->telemetryPanel.consume(*notepad->telemetry);
+        }
+        pad->telemetryPanel.draw();
+        governor.draw();
+
+        // Export window
+        if (exportOpen)
+        {
+            ImGui::Begin("Export", &exportOpen, propFlags);
+            static const char *formatItems[] = {"PNG Frames", "Pipe to Command"};
+            int format = static_cast<int>(exportSettings.format);
+            if (ImGui::Combo("Format", &format, formatItems, IM_ARRAYSIZE(formatItems)))
+                exportSettings.format = static_cast<ExportFormat>(format);
+            if (exportSettings.format == EXPORT_PNG)
+                ImGui::InputText("Directory", exportDirectory, EXPORT_PATH_CAPACITY);
+            else
+                ImGui::InputText("Command", exportCommand, EXPORT_PATH_CAPACITY);
+            ImGui::DragInt2("Resolution", exportSize, 1.0f, MIN_EXPORT_SIZE, MAX_EXPORT_SIZE);
+            ImGui::DragFloat("Frame Rate", &exportSettings.frameRate, EXPORT_FRAME_RATE_STEP, MIN_EXPORT_FRAME_RATE, MAX_EXPORT_FRAME_RATE);
+            ImGui::DragFloat("Duration", &exportSettings.duration, EXPORT_DURATION_STEP, MIN_EXPORT_DURATION, MAX_EXPORT_DURATION);
+
+            if (exporter.isActive())
+            {
+                ImGui::ProgressBar(exporter.getProgress());
+                if (ImGui::Button("Cancel"))
+                    exporter.cancel();
+            }
+            else if (ImGui::Button("Start Export"))
+            {
+                // Export what the window currently shows, from the world as it is now
+                exportSettings.output = exportSettings.format == EXPORT_PNG ? exportDirectory : exportCommand;
+                exportSettings.width = static_cast<unsigned int>(std::clamp(exportSize[0], MIN_EXPORT_SIZE, MAX_EXPORT_SIZE));
+                exportSettings.height = static_cast<unsigned int>(std::clamp(exportSize[1], MIN_EXPORT_SIZE, MAX_EXPORT_SIZE));
+                exportSettings.view = pad->view;
+                exportSettings.view.setViewport(sf::FloatRect(sf::Vector2f(0.0f, 0.0f), sf::Vector2f(1.0f, 1.0f)));
+                ExportSettings request = exportSettings;
+                pad->simulation.post([&exporter, request](World &world)
+                                     { exporter.start(world, request); });
+            }
+
+            if (!exporter.isActive())
             {
-                world.setODESolver(static_cast<SolverType>(currentSolver));
+                std::string exportError = exporter.getError();
+                if (!exportError.empty())
+                    ImGui::TextWrapped("%s", exportError.c_str());
             }
-            ImGui::DragFloat("Calculation Frequency", &world.calculationFrequency, CALC_FREQ_STEP, MIN_CALC_FREQ, MAX_CALC_FREQ);
             ImGui::End();
         }
 
-        // Handle grabbed object position update (if static)
-        if (grabbedObject != nullptr && grabbedObject->isStatic)
+        // Schedule a new path prediction when inputs changed, the snapshot is taken between steps
+        if (pad->predictionDirty)
         {
-            sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-            sf::Vector2f worldPos = window.mapPixelToCoords(mousePos);
-            Vec2 pixelsPos = Vec2(worldPos.x, worldPos.y);
-            Vec2 metersPos = *pixelsToMeters(&pixelsPos);
-            grabbedObject->body->position = metersPos;
-            grabbedObject->body->velocity = Vec2(0.0f, 0.0f);
+            if (pad->predictor.enabled)
+            {
+                ObjectHandle handle = pad->selectedHandle;
+                bool all = pad->predictor.predictAll;
+                float seconds = pad->predictor.horizon;
+                pad->simulation.post([predictor = &pad->predictor, handle, all, seconds](World &world)
+                                     { predictor->request(world, world.getObject(handle), all, seconds); });
+            }
+            else
+            {
+                pad->predictor.clear();
+            }
+            pad->predictionDirty = false;
         }
 
-        // Update world and bodies
-        world.update(dt);
-
-        // Clear screen and draw world & ui
+        // Clear screen and draw the shown worlds & ui
         window.clear(sf::Color::Black);
-        world.draw(&window);
+        float renderTime = 0.0f;
+        for (size_t i = firstShown; i < lastShown; i++)
+        {
+            Notepad *shown = notepads[i];
+            window.setView(shown->view);
+            sf::Clock renderClock;
+            shown->simulation.draw(&window, appliedLevels.renderLevel);
+            renderTime += renderClock.getElapsedTime().asSeconds();
+            shown->predictor.draw(&window);
+            if (!shown->springStart.isNull())
+            {
+                // Spring being dragged, from its first body to the mouse
+                for (const RenderBody &body : shown->simulation.latest().bodies)
+                {
+                    if (body.handle != shown->springStart)
+                        continue;
+                    sf::Vertex line[2] = {sf::Vertex{body.position, SPRING_COLOR}, sf::Vertex{window.mapPixelToCoords(sf::Mouse::getPosition(window)), SPRING_COLOR}};
+                    window.draw(line, 2, sf::PrimitiveType::Lines);
+                    break;
+                }
+            }
+        }
+        window.setView(pad->view);
         ImGui::SFML::Render(window);
+
+        // Adjust the quality for the next frames from what this one cost, the busiest simulation thread decides
+        float stepCost = 0.0f;
+        for (Notepad *notepad : notepads)
+        {
+            if (notepad->simulation.isRunning())
+                stepCost = std::max(stepCost, notepad->simulation.getStepCost());
+        }
+        governor.update(dtTime.asSeconds(), frameClock.getElapsedTime().asSeconds(), renderTime, stepCost);
+        const QualityLevels &levels = governor.getLevels();
+        if (levels.stepRate != appliedLevels.stepRate || levels.contactIterations != appliedLevels.contactIterations)
+        {
+            for (Notepad *notepad : notepads)
+            {
+                applyLevels(notepad, levels);
+            }
+        }
+        appliedLevels = levels;
+
         window.display();
     }
 
+    // Each notepad stops stepping before its world, predictor and telemetry channel go away
+    for (Notepad *notepad : notepads)
+    {
+        delete notepad;
+    }
     ImGui::SFML::Shutdown();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Scalar type of the physics state, chosen per build target
+#ifdef NEWTON_DOUBLE_PRECISION
+typedef double Scalar;
+#else
+typedef float Scalar;
+#endif
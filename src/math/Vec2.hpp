@@ -3,99 +3,111 @@
 #include <cmath>
 #include <string>
 #include <fmt/format.h>
+#include "math/Scalar.hpp"
 
-struct Vec2
+template <typename T>
+struct Vec2T
 {
     // 2D vector components
-    float x = 0.0f;
-    float y = 0.0f;
+    T x = 0;
+    T y = 0;
 
     // Constructors
-    Vec2() = default;
-    Vec2(float x, float y) : x(x), y(y) {}
+    Vec2T() = default;
+    Vec2T(T x, T y) : x(x), y(y) {}
+
+    template <typename U>
+    explicit Vec2T(const Vec2T<U> &other) : x(static_cast<T>(other.x)), y(static_cast<T>(other.y)) {}
 
     // Operators
-    Vec2 operator+(const Vec2 &rhs) const
+    Vec2T operator+(const Vec2T &rhs) const
     {
-        return Vec2(x + rhs.x, y + rhs.y);
+        return Vec2T(x + rhs.x, y + rhs.y);
     }
 
-    Vec2 operator-(const Vec2 &rhs) const
+    Vec2T operator-(const Vec2T &rhs) const
     {
-        return Vec2(x - rhs.x, y - rhs.y);
+        return Vec2T(x - rhs.x, y - rhs.y);
     }
 
-    Vec2 operator*(float scalar) const
+    Vec2T operator*(T scalar) const
     {
-        return Vec2(x * scalar, y * scalar);
+        return Vec2T(x * scalar, y * scalar);
     }
 
-    Vec2 operator/(float scalar) const
+    Vec2T operator/(T scalar) const
     {
-        return Vec2(x / scalar, y / scalar);
+        return Vec2T(x / scalar, y / scalar);
     }
 
-    void operator+=(const Vec2 &rhs)
+    void operator+=(const Vec2T &rhs)
     {
         x += rhs.x;
         y += rhs.y;
     }
 
-    void operator-=(const Vec2 &rhs)
+    void operator-=(const Vec2T &rhs)
     {
         x -= rhs.x;
         y -= rhs.y;
     }
 
-    void operator*=(float scalar)
+    void operator*=(T scalar)
     {
         x *= scalar;
         y *= scalar;
     }
 
-    void operator/=(float scalar)
+    void operator/=(T scalar)
     {
         x /= scalar;
         y /= scalar;
     }
 
     // Methods
-    void set(float newX, float newY)
+    void set(T newX, T newY)
     {
         x = newX;
         y = newY;
     }
 
-    float lengthSquared() const
+    T lengthSquared() const
     {
         return x * x + y * y;
     }
 
-    float length() const
+    T length() const
     {
         return std::sqrt(lengthSquared());
     }
 
-    float angle() const
+    T angle() const
     {
         return std::atan2(y, x);
     }
 
-    Vec2 normalized() const
+    Vec2T rotated(T radians) const
+    {
+        T c = std::cos(radians);
+        T s = std::sin(radians);
+        return Vec2T(x * c - y * s, x * s + y * c);
+    }
+
+    Vec2T normalized() const
     {
-        float len = length();
-        if (len > 0.0f)
-            return Vec2(x / len, y / len);
-        return Vec2(0, 0);
+        T len = length();
+        if (len > 0)
+            return Vec2T(x / len, y / len);
+        return Vec2T(0, 0);
     }
 
-    Vec2 constrained(Vec2 min, Vec2 max) const
+    Vec2T constrained(Vec2T min, Vec2T max) const
     {
-        return Vec2(std::fmax(min.x, std::fmin(x, max.x)),
-                    std::fmax(min.y, std::fmin(y, max.y)));
+        return Vec2T(std::fmax(min.x, std::fmin(x, max.x)),
+                     std::fmax(min.y, std::fmin(y, max.y)));
     }
 
-    void constrain(Vec2 min, Vec2 max)
+    void constrain(Vec2T min, Vec2T max)
     {
         x = std::fmax(min.x, std::fmin(x, max.x));
         y = std::fmax(min.y, std::fmin(y, max.y));
@@ -108,7 +120,39 @@ struct Vec2
     }
 };
 
-inline float dot(const Vec2 &a, const Vec2 &b)
+// Formats like toString, but straight into fmt's output so fixed buffers need no temporary string
+template <typename T>
+struct fmt::formatter<Vec2T<T>>
+{
+    constexpr auto parse(fmt::format_parse_context &ctx) { return ctx.begin(); }
+
+    template <typename FormatContext>
+    auto format(const Vec2T<T> &vec, FormatContext &ctx) const
+    {
+        return fmt::format_to(ctx.out(), "({:.2f}, {:.2f})", vec.x, vec.y);
+    }
+};
+
+template <typename T>
+inline T dot(const Vec2T<T> &a, const Vec2T<T> &b)
 {
     return a.x * b.x + a.y * b.y;
-}
\ No newline at end of file
+}
+
+// Z component of the 3D cross product
+template <typename T>
+inline T cross(const Vec2T<T> &a, const Vec2T<T> &b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+// Angular velocity crossed with a lever arm
+template <typename T>
+inline Vec2T<T> cross(T w, const Vec2T<T> &r)
+{
+    return Vec2T<T>(-w * r.y, w * r.x);
+}
+
+typedef Vec2T<float> Vec2f;
+typedef Vec2T<double> Vec2d;
+typedef Vec2T<Scalar> Vec2; // Vector type of the physics state
\ No newline at end of file
@@ -10,22 +10,31 @@ struct Body
     Vec2 acceleration;
     Vec2 netForce;
 
-    float kineticEnergy = 0.0f;
-    float gravitationalPotential = 0.0f;
-    float totalEnergy = 0.0f;
+    // Rotation
+    Scalar angle = 0.0f;               // Orientation (rad)
+    Scalar angularVelocity = 0.0f;     // rad/s
+    Scalar angularAcceleration = 0.0f; // rad/s²
+    Scalar netTorque = 0.0f;
+
+    Scalar kineticEnergy = 0.0f;
+    Scalar gravitationalPotential = 0.0f;
+    Scalar totalEnergy = 0.0f;
 
     // Physical Properties
-    float mass;
-    float invMass; // Inverse of mass to avoid unnecessary divisions
+    Scalar mass;
+    Scalar invMass; // Inverse of mass to avoid unnecessary divisions
+    Scalar inertia = 0.0f;
+    Scalar invInertia = 0.0f;
+    Scalar charge = 0.0f;
 
     // Other Properties
-    float dragCoefficient = 0.47f;
-    float staticFriction = 0.5f;
-    float kineticFriction = 0.3f;
-    float restitution = 0.7f;
+    Scalar dragCoefficient = 0.47f;
+    Scalar staticFriction = 0.5f;
+    Scalar kineticFriction = 0.3f;
+    Scalar restitution = 0.7f;
 
     // Constructors
-    Body(const Vec2 &position, float mass) : position(position), mass(mass)
+    Body(const Vec2 &position, Scalar mass) : position(position), mass(mass)
     {
         this->invMass = (mass == 0.0f) ? 0.0f : 1.0f / mass;
     }
@@ -34,4 +43,10 @@ struct Body
     void applyForce(const Vec2 &force) {
         netForce += force;
     };
+
+    void setInertia(Scalar inertia)
+    {
+        this->inertia = inertia;
+        this->invInertia = (inertia == 0.0f) ? 0.0f : 1.0f / inertia;
+    }
 };
\ No newline at end of file
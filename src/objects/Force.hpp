@@ -1,60 +1,119 @@
 #pragma once
 
 #include <functional>
+#include <string>
 #include "math/Vec2.hpp"
-#include "objects/Object.hpp"
+#include "objects/Body.hpp"
 
 struct Force
 {
-    Vec2 position;
+    Vec2 position;        // Application point relative to the center
     Vec2 force;
+    Scalar torque = 0.0f; // Couple on top of the force's own moment, e.g. a reaction spread over the body
 
     Force() : position(0.0f, 0.0f), force(0.0f, 0.0f) {}
 
-    Force(const Vec2 &pos, const Vec2 &f) : position(pos), force(f) {}
+    Force(const Vec2 &pos, const Vec2 &f, Scalar couple = 0.0f) : position(pos), force(f), torque(couple) {}
+};
+
+// How a force depends on the body's state, solvers use it to skip work for simple force sets
+enum ForceKind : unsigned char
+{
+    CONSTANT_FORCE, // Independent of the state over a step
+    LINEAR_FORCE,   // offset + positionGain·p + velocityGain·v, applied at the center
+    GENERAL_FORCE   // Arbitrary function of the state
+};
+
+// Force shared by many bodies and evaluated for one of them in any state, e.g. a tree over all bodies.
+// Sources point at it with their body's index instead of each holding a closure.
+class ForceEvaluator
+{
+public:
+    virtual ~ForceEvaluator() = default;
+    virtual Force evaluate(const Body &state, int index) const = 0;
+
+    // Forces on count bodies at once, the solvers call it with every body of a stage.
+    // Evaluators with a batched kernel override it, the default evaluates the bodies one by one.
+    virtual void evaluateAll(const Body *const *states, const int *indices, size_t count, Force *forces) const
+    {
+        for (size_t k = 0; k < count; k++)
+        {
+            forces[k] = evaluate(*states[k], indices[k]);
+        }
+    }
 };
 
 class ForceSource
 {
 private:
-    bool isConstant = true;
-    Force constantForce;
+    ForceKind kind = CONSTANT_FORCE;
+    Force constantForce; // The force itself when constant, the offset when linear
+    Scalar positionGain = 0.0f;
+    Scalar velocityGain = 0.0f;
     std::function<Force(const Body &state)> variableForceFunc = nullptr;
-    
+    const ForceEvaluator *evaluator = nullptr; // Must outlive the source
+    int evaluatorIndex = -1;
 
 public:
     std::string name;
 
-    ForceSource(const std::string &name) : name(name), constantForce(Force()) {}
-    ForceSource(const std::string &name, const Force &force) : name(name), constantForce(force) {}
-    ForceSource(const std::string &name, const std::function<Force(const Body &state)> func) : name(name), variableForceFunc(func)
+    ForceSource(const std::string &name) : constantForce(Force()), name(name) {}
+    ForceSource(const std::string &name, const Force &force) : constantForce(force), name(name) {}
+    ForceSource(const std::string &name, const std::function<Force(const Body &state)> func) : variableForceFunc(func), name(name)
+    {
+        kind = GENERAL_FORCE;
+    }
+    ForceSource(const std::string &name, const ForceEvaluator *evaluator, int index) : evaluator(evaluator), evaluatorIndex(index), name(name)
+    {
+        kind = GENERAL_FORCE;
+    }
+
+    // Force offset + positionGain·p + velocityGain·v, e.g. a damped spring towards a fixed point
+    static ForceSource linear(const std::string &name, const Vec2 &offset, Scalar positionGain, Scalar velocityGain)
     {
-        isConstant = false;
+        ForceSource source(name, Force(Vec2(0.0f, 0.0f), offset));
+        source.kind = LINEAR_FORCE;
+        source.positionGain = positionGain;
+        source.velocityGain = velocityGain;
+        return source;
     }
 
     Force calculateForce(const Body &state) const
     {
-        if (isConstant)
+        switch (kind)
         {
+        case CONSTANT_FORCE:
             return constantForce;
+        case LINEAR_FORCE:
+            return Force(Vec2(0.0f, 0.0f), constantForce.force + state.position * positionGain + state.velocity * velocityGain);
+        default:
+            if (evaluator != nullptr)
+                return evaluator->evaluate(state, evaluatorIndex);
+            if (variableForceFunc != nullptr)
+                return variableForceFunc(state);
+            return Force();
         }
-        else if (variableForceFunc != nullptr)
-        {
-            return variableForceFunc(state);
-        }
-        return Force();
     }
 
+    ForceKind getKind() const { return kind; }
+    const Vec2 &getOffset() const { return constantForce.force; } // Linear forces only
+    Scalar getPositionGain() const { return positionGain; }
+    Scalar getVelocityGain() const { return velocityGain; }
+    const ForceEvaluator *getEvaluator() const { return evaluator; } // nullptr unless the source points at one
+    int getEvaluatorIndex() const { return evaluatorIndex; }
+
     void setForce(const Force &force)
     {
         constantForce = force;
-        isConstant = true;
+        kind = CONSTANT_FORCE;
         variableForceFunc = nullptr;
+        evaluator = nullptr;
     }
 
     void setForce(Force (*func)(const Body &state))
     {
         variableForceFunc = func;
-        isConstant = false;
+        evaluator = nullptr;
+        kind = GENERAL_FORCE;
     }
 };
\ No newline at end of file
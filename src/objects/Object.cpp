@@ -1,65 +1,52 @@
 #include "Object.hpp"
 
-Object::Object(Vec2 position, Vec2 dimensions, float density, ShapeType type)
+#include <algorithm>
+
+Object::Object(Vec2 position, Vec2 dimensions, Scalar density, ShapeType type) : bodyStorage(position, 0.0f), body(&bodyStorage)
 {
     this->shapeType = type;
     this->dimensions = dimensions;
 
-    Vec2 *len = metersToPixels(&dimensions);
+    Vec2 len = dimensions * pixelsPerMeter;
     if (type == CIRCLE)
     {
-        shape = new sf::CircleShape(len->x);
-        shape->setOrigin(sf::Vector2f(len->x, len->x));
+        sf::CircleShape &circle = shapeStorage.emplace<sf::CircleShape>(len.x);
+        circle.setOrigin(sf::Vector2f(len.x, len.x));
+        shape = &circle;
         this->volume = M_PI * dimensions.x * dimensions.x;
     }
-    else if (type == RECTANGLE)
+    else
     {
-        shape = new sf::RectangleShape(sf::Vector2f(len->x, len->y));
-        shape->setOrigin(sf::Vector2f(len->x / 2, len->y / 2));
+        sf::RectangleShape &rect = shapeStorage.emplace<sf::RectangleShape>(sf::Vector2f(len.x, len.y));
+        rect.setOrigin(sf::Vector2f(len.x / 2, len.y / 2));
+        shape = &rect;
         this->volume = dimensions.x * dimensions.y;
     }
-    delete len;
 
     shape->setFillColor(sf::Color::White);
 
-    body = new Body(position, density * volume);
-
-    switch (DEFAULT_SOLVER)
-    {
-    case EULER:
-        solver = new EulerSolver(this);
-        break;
-    case RK2:
-        solver = new RK2Solver(this);
-        break;
-    case RK4:
-        solver = new RK4Solver(this);
-        break;
-    case VERLET:
-        // solver = new VerletSolver(this);
-        break;
-    case DOPRI5:
-        // solver = new DOPRI5Solver(this);
-        break;
-    case AB:
-        // solver = new ABSolver(this);
-        break;
-    case AM:    
-        // solver = new AMSolver(this);
-        break;
-    }
+    bodyStorage = Body(position, density * volume);
+    if (type == CIRCLE)
+        body->setInertia(0.5f * body->mass * dimensions.x * dimensions.x);
+    else
+        body->setInertia(body->mass * (dimensions.x * dimensions.x + dimensions.y * dimensions.y) / 12.0f);
 }
 
-Object::~Object()
+void Object::copyFrom(const Object &other)
 {
-    delete shape;
-    delete body;
-    delete solver;
-    for (auto &source : forceSources)
-    {
-        delete source;
-    }
-    forceSources.clear();
+    *body = *other.body;
+    shape->setFillColor(other.shape->getFillColor());
+
+    isSelectable = other.isSelectable;
+    isStatic = other.isStatic;
+    doGravity = other.doGravity;
+    doDrag = other.doDrag;
+    doFriction = other.doFriction;
+    canApplyFriction = other.canApplyFriction;
+    isGrabbed = other.isGrabbed;
+
+    forceSources = other.forceSources;
+    forceKind = other.forceKind;
 }
 
 void Object::setStatic(bool isStatic)
@@ -83,108 +70,108 @@ void Object::setConstant()
 
 void Object::applyForce(const ForceSource &force)
 {
-    deleteForce(force.name);
-    forceSources.push_back(new ForceSource(force));
+    // Replace in place so per-step forces reuse the vector's storage
+    for (ForceSource &source : forceSources)
+    {
+        if (source.name == force.name)
+        {
+            source = force;
+            classifyForces();
+            return;
+        }
+    }
+    forceSources.push_back(force);
+    forceKind = std::max(forceKind, force.getKind());
 }
 
 void Object::deleteForce(const std::string &name)
 {
     for (auto it = forceSources.begin(); it != forceSources.end(); ++it)
     {
-        if ((*it)->name == name)
+        if (it->name == name)
         {
-            delete *it;
             forceSources.erase(it);
+            classifyForces();
             break;
         }
     }
 }
 
-const std::vector<ForceSource *> &Object::getForces() const
+void Object::classifyForces()
+{
+    forceKind = CONSTANT_FORCE;
+    for (const ForceSource &source : forceSources)
+    {
+        forceKind = std::max(forceKind, source.getKind());
+    }
+}
+
+const std::vector<ForceSource> &Object::getForces() const
 {
     return forceSources;
 }
 
+ForceKind Object::getForceKind() const
+{
+    return forceKind;
+}
+
 const Force Object::getNetForce() const
 {
     Vec2 netForce(0.0f, 0.0f);
     Vec2 netTorquePoint(0.0f, 0.0f);
     for (const auto &source : forceSources)
     {
-        Force f = source->calculateForce(*body);
+        Force f = source.calculateForce(*body);
         netForce += f.force;
         netTorquePoint += f.position * f.force.length();
     }
     return Force(netTorquePoint, netForce);
 }
 
-void Object::switchSolver(SolverType type)
+void Object::getBounds(Vec2 &min, Vec2 &max) const
 {
-    ODESolver *newSolver = nullptr;
-    switch (type)
+    Vec2 halfSize = Vec2(dimensions.x, dimensions.x);
+    if (shapeType == RECTANGLE)
     {
-    case EULER:
-        newSolver = new EulerSolver(this);
-        break;
-    case RK2:
-        newSolver = new RK2Solver(this);
-        break;
-    case RK4:
-        newSolver = new RK4Solver(this);
-        ;
-        break;
-    case VERLET:
-        // newSolver = new VerletSolver(this);
-        break;
-    case DOPRI5:
-        // newSolver = new DOPRI5Solver(this);
-        break;
-    case AB:
-        // newSolver = new ABSolver(this);
-        break;
-    case AM:    
-        // newSolver = new AMSolver(this);
-        break;
-    }
-    if (newSolver)
-    {
-        if (solver)
-            delete solver;
-        solver = newSolver;
+        // Extents of the rotated box
+        Scalar c = std::abs(std::cos(body->angle));
+        Scalar s = std::abs(std::sin(body->angle));
+        halfSize = Vec2(c * dimensions.x + s * dimensions.y, s * dimensions.x + c * dimensions.y) * 0.5f;
     }
+    min = body->position - halfSize;
+    max = body->position + halfSize;
 }
 
 void Object::calculateEnergies()
 {
-    body->kineticEnergy = 0.5f * body->mass * body->velocity.lengthSquared();
+    body->kineticEnergy = 0.5f * body->mass * body->velocity.lengthSquared() + 0.5f * body->inertia * body->angularVelocity * body->angularVelocity;
     body->gravitationalPotential = dot(standardizePosition(body->position), *gravityPtr) * body->mass;
 
     body->totalEnergy = body->kineticEnergy + body->gravitationalPotential;
 }
 
-void Object::update(float dt)
+void Object::finishStep()
 {
     if (!isStatic)
     {
-        solver->step(dt);
-
-        Vec2 *minPixels = new Vec2(-WORLD_WIDTH / 2, DEF_HEIGHT - WORLD_HEIGHT + HALF_WALL_THICKNESS);
-        Vec2 *maxPixels = new Vec2(WORLD_WIDTH / 2, DEF_HEIGHT - HALF_WALL_THICKNESS);
-        body->position.constrain(*pixelsToMeters(minPixels), *pixelsToMeters(maxPixels));
+        Vec2 minMeters = Vec2(-WORLD_WIDTH / 2, DEF_HEIGHT - WORLD_HEIGHT + HALF_WALL_THICKNESS) / pixelsPerMeter;
+        Vec2 maxMeters = Vec2(WORLD_WIDTH / 2, DEF_HEIGHT - HALF_WALL_THICKNESS) / pixelsPerMeter;
+        body->position.constrain(minMeters, maxMeters);
 
         body->netForce = Vec2(0.0f, 0.0f);
     }
 
     calculateEnergies();
 
-    Vec2 *pos = metersToPixels(&body->position);
-    shape->setPosition(sf::Vector2f(pos->x, pos->y));
-    delete pos;
+    Vec2 pos = body->position * pixelsPerMeter;
+    shape->setPosition(sf::Vector2f(pos.x, pos.y));
+    shape->setRotation(sf::radians(static_cast<float>(body->angle)));
 }
 
-void Object::draw(sf::RenderWindow *window)
+void Object::draw(sf::RenderTarget *target)
 {
-    window->draw(*shape);
+    target->draw(*shape);
 }
 
 int Object::getID() const {
@@ -4,36 +4,44 @@
 
 #include <SFML/Graphics.hpp>
 #include <math.h>
+#include <variant>
 #include <vector>
 #include "objects/Body.hpp"
 #include "objects/Force.hpp"
+#include "objects/ObjectHandle.hpp"
 #include "math/Util.hpp"
 #include "engine/ODE.hpp"
 
 enum SolverType : unsigned short;
-class ODESolver;
 
 enum ShapeType
 {
     CIRCLE,
     RECTANGLE,
+    SHAPE_TYPE_COUNT // Number of shape types, keep last
 };
 
 class Object
 {
 private:
-    ODESolver *solver;
-    std::vector<ForceSource *> forceSources;
+    std::vector<ForceSource> forceSources;
+    ForceKind forceKind = CONSTANT_FORCE; // Most general kind among forceSources
     int id = 0;
     Vec2* gravityPtr;
 
+    void classifyForces(); // Recompute forceKind after the force list changed
+
+    Body bodyStorage;                                               // Kept inline so a pooled object is one allocation
+    std::variant<sf::CircleShape, sf::RectangleShape> shapeStorage; // Active shape for shapeType
+
 public:
     Body *body;
     sf::Shape *shape;
     ShapeType shapeType;
+    ObjectHandle handle; // Set by the pool that owns the object
 
     Vec2 dimensions;
-    float volume;
+    Scalar volume;
 
     bool isSelectable = true;
     bool isStatic = false;
@@ -44,8 +52,11 @@ public:
 
     bool isGrabbed = false;
 
-    Object(Vec2 position, Vec2 dimensions, float density, ShapeType type);
-    ~Object();
+    Object(Vec2 position, Vec2 dimensions, Scalar density, ShapeType type);
+    Object(const Object &) = delete; // body and shape point into the object itself
+    Object &operator=(const Object &) = delete;
+
+    void copyFrom(const Object &other); // Copy the body, settings and forces of an object with the same shape
 
     void setStatic(bool isStatic);
     void setConstant();
@@ -54,16 +65,17 @@ public:
 
     void deleteForce(const std::string &name);
 
-    const std::vector<ForceSource *> &getForces() const;
+    const std::vector<ForceSource> &getForces() const;
+    ForceKind getForceKind() const; // Constant and linear force sets let the solvers skip stage evaluations
 
     const Force getNetForce() const;
 
-    void switchSolver(SolverType type);
+    void getBounds(Vec2 &min, Vec2 &max) const; // Axis-aligned bounding box in meters
 
     void calculateEnergies();
-    void update(float dt);
+    void finishStep(); // Clamp to the world, reset forces and sync the shape after integration
 
-    void draw(sf::RenderWindow *window);
+    void draw(sf::RenderTarget *target);
 
     int getID() const;
     void setID(int newID);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#define OBJECT_INDEX_BITS 20                                  // Up to about a million live objects
+#define OBJECT_INDEX_MASK ((1u << OBJECT_INDEX_BITS) - 1)
+#define OBJECT_GENERATION_MASK ((1u << (32 - OBJECT_INDEX_BITS)) - 1)
+
+// 32-bit reference to a pooled object: slot index in the low bits, slot generation in the high bits.
+// A handle stops resolving once its object is removed, even after the slot is reused. 0 is the null handle.
+struct ObjectHandle
+{
+    uint32_t value = 0;
+
+    ObjectHandle() = default;
+    ObjectHandle(uint32_t index, uint32_t generation) : value((generation << OBJECT_INDEX_BITS) | index) {}
+
+    static ObjectHandle fromValue(uint32_t value) // Rebuild a handle that was passed around as its raw value
+    {
+        ObjectHandle handle;
+        handle.value = value;
+        return handle;
+    }
+
+    uint32_t index() const { return value & OBJECT_INDEX_MASK; }
+    uint32_t generation() const { return value >> OBJECT_INDEX_BITS; }
+    bool isNull() const { return value == 0; }
+
+    bool operator==(const ObjectHandle &rhs) const { return value == rhs.value; }
+    bool operator!=(const ObjectHandle &rhs) const { return value != rhs.value; }
+};
@@ -16,59 +16,33 @@ enum ToolType
     DRAW_RECTANGLE,
     DRAW_ROPE,
     DRAW_SPRING,
+    POUR_FLUID,
     ERASE,
     TOOL_END
 };
 
-inline sf::Texture *getToolTexture(ToolType type)
+// Name of the embedded image for each tool, nullptr for tools without an icon yet
+inline const char *getToolIcon(ToolType type)
 {
-    sf::Texture *texture = new sf::Texture();
-
-    texture->setSmooth(true);
-    texture->setRepeated(false);
-    bool resized = texture->resize(sf::Vector2u(TOOLS_ICON_SIZE, TOOLS_ICON_SIZE));
-
-    bool loaded = false;
     switch (type)
     {
     case SELECT:
-        loaded = texture->loadFromFile("assets/cursor.png");
-        break;
+        return "cursor.png";
     case MOVE:
-        loaded = texture->loadFromFile("assets/hand.png");
-        break;
-    case PULL:
-        break;
-    case PUSH:
-        break;
-    case DRAW_CIRCLE:
-        break;
-    case DRAW_RECTANGLE:
-        break;
-    case DRAW_ROPE:
-        break;
-    case DRAW_SPRING:
-        break;
-    case ERASE:
-        break;
+        return "hand.png";
     default:
-        break;
+        return nullptr;
     }
-    return texture;
 }
 
 struct Tool
 {
     ToolType type;
-    sf::Texture *texture;
-
-    Tool(ToolType type, sf::Texture *texture) : type(type), texture(texture)
-    {
-    }
+    const sf::Texture *atlas; // Shared by every tool, owned by the asset cache
+    sf::IntRect icon;         // Region of this tool's icon in the atlas
 
-    ~Tool()
+    Tool(ToolType type, const sf::Texture *atlas, const sf::IntRect &icon) : type(type), atlas(atlas), icon(icon)
     {
-        delete texture;
     }
 
     const char *getId() const
@@ -91,6 +65,8 @@ struct Tool
             return "draw_rope";
         case DRAW_SPRING:
             return "draw_spring";
+        case POUR_FLUID:
+            return "pour_fluid";
         case ERASE:
             return "erase";
         default:
@@ -118,6 +94,8 @@ struct Tool
             return "Draw Rope";
         case DRAW_SPRING:
             return "Draw Spring";
+        case POUR_FLUID:
+            return "Pour Fluid";
         case ERASE:
             return "Erase";
         default: